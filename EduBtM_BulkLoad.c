@@ -0,0 +1,539 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_BulkLoad.c
+ *
+ * Description :
+ *  Build a B+ tree bottom-up from <key, ObjectID> pairs given in increasing
+ *  key order. Leaves are filled from left to right up to the fill factor and
+ *  every time a page is closed, the separator between it and its right
+ *  neighbor is appended to the rightmost page of the level above. No descent, binary search or split
+ *  is done.
+ *
+ *  A bulk load is started by EduBtM_InitBulkLoad() on an empty index, fed by
+ *  EduBtM_NextBulkLoad() and completed by EduBtM_FinalBulkLoad(), which moves
+ *  the top page of the built tree into the root page of the index.
+ *
+ * Exports:
+ *  Four EduBtM_InitBulkLoad(BtreeHandle*, Four, BtreeBulkLoad*)
+ *  Four EduBtM_NextBulkLoad(BtreeBulkLoad*, KeyValue*, ObjectID*)
+ *  Four EduBtM_FinalBulkLoad(BtreeBulkLoad*, Pool*, DeallocListElem*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_BulkLoadInternal(BtreeBulkLoad*, Four, InternalItem*, PageID*);
+Four edubtm_BulkLoadDuplicate(BtreeBulkLoad*, ObjectID*);
+
+
+
+/*@================================
+ * EduBtM_InitBulkLoad()
+ *================================*/
+/*
+ * Function: Four EduBtM_InitBulkLoad(BtreeHandle*, Four, BtreeBulkLoad*)
+ *
+ * Description:
+ *  Start a sorted bulk load into the empty B+ tree opened as 'handle'.
+ *  The handle must stay open until the bulk load is finished.
+ *  'fillFactor' is the percentage of each page to be filled; 0 selects
+ *  BTM_BULKLOAD_FILLFACTOR.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_InitBulkLoad(
+    BtreeHandle         *handle,        /* IN opened empty index */
+    Four                fillFactor,     /* IN percentage of a page to be filled */
+    BtreeBulkLoad       *bl)            /* OUT state of the bulk load */
+{
+    Four                e;              /* error number */
+    BtreeLeaf           *rpage;         /* the root page */
+
+
+    /*@ check parameters */
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (bl == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (fillFactor == 0) fillFactor = BTM_BULKLOAD_FILLFACTOR;
+    if (fillFactor < 0 || fillFactor > 100) ERR(eBADPARAMETER_BTM);
+
+
+    /* only an empty index can be bulk loaded */
+    e = BfM_GetTrain(&handle->root, (char**)&rpage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (!(rpage->hdr.type & LEAF) || rpage->hdr.nSlots != 0)
+        ERRB1(eBADPARAMETER_BTM, &handle->root, PAGE_BUF);
+
+    e = BfM_FreeTrain(&handle->root, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    /* the loader builds the tree under the root by itself */
+    BTM_INVALIDATE_FINGER(handle);
+    edubtm_ClearHotKeys(handle);
+    edubtm_ClearLeafHints(handle);
+
+    bl->handle = handle;
+    bl->leafFill = (PAGESIZE - BL_FIXED) * fillFactor / 100;
+    bl->internalFill = (PAGESIZE - BI_FIXED) * fillFactor / 100;
+    bl->height = 0;
+    bl->lastKey.len = 0;
+
+    return(eNOERROR);
+
+} /* EduBtM_InitBulkLoad() */
+
+
+
+/*@================================
+ * EduBtM_NextBulkLoad()
+ *================================*/
+/*
+ * Function: Four EduBtM_NextBulkLoad(BtreeBulkLoad*, KeyValue*, ObjectID*)
+ *
+ * Description:
+ *  Append <kval, oid> to the rightmost leaf. If the leaf is filled up to the
+ *  fill factor, a new leaf is started and the separator in front of it is
+ *  appended to the level above. In a non-unique index, 'oid' of a key equal
+ *  to the previous one joins the last entry.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM : 'kval' is less than the previous key or does not
+ *                        match the key descriptor
+ *    eDUPLICATEDKEY_BTM
+ *    eDUPLICATEDOBJECTID_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_NextBulkLoad(
+    BtreeBulkLoad       *bl,            /* INOUT state of the bulk load */
+    KeyValue            *kval,          /* IN key value */
+    ObjectID            *oid)           /* IN ObjectID which will be inserted */
+{
+    Four                e;              /* error number */
+    Four                cmp;            /* comparison result */
+    PageID              newPid;         /* a new leaf */
+    PageID              oldPid;         /* the leaf closed by this call */
+    BtreeLeaf           *page;          /* the rightmost leaf */
+    BtreeLeaf           *npage;         /* the new leaf */
+    btm_LeafEntry       *entry;         /* the appended entry */
+    Two                 alignedKlen;    /* aligned length of the key length */
+    Two                 entryLen;       /* length of the appended entry */
+    InternalItem        item;           /* separator for the level above */
+    KeyValue            nkval;          /* normalized key value */
+    Two                 strLen;         /* length of a string key */
+
+
+    if (bl == NULL || kval == NULL || oid == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (BTM_NORMALIZED(bl->handle)) {
+        e = edubtm_NormalizeKey(&bl->handle->kdesc, kval, &nkval);
+        if (e < 0) ERR(e);
+        kval = &nkval;
+    }
+    /* a key of one part is appended as given, so it must have the length of its type */
+    else if (bl->handle->kdesc.kpart[0].type == SM_VARSTRING) {
+        if (kval->len < (Two)sizeof(Two) || kval->len > MAXKEYLEN) ERR(eBADPARAMETER_BTM);
+        memcpy(&strLen, &kval->val[0], sizeof(Two));
+        if (strLen < 0 || (Two)sizeof(Two) + strLen != kval->len) ERR(eBADPARAMETER_BTM);
+    }
+    else if (kval->len != BTM_DENSE_KEYLEN(bl->handle))
+        ERR(eBADPARAMETER_BTM);
+
+    if (bl->height > 0) {
+        cmp = BTM_KEYCOMPARE(bl->handle, kval, &bl->lastKey);
+        if (cmp == EQUAL) {
+            if (bl->handle->kdesc.flag & KEYFLAG_UNIQUE) ERR(eDUPLICATEDKEY_BTM);
+
+            e = edubtm_BulkLoadDuplicate(bl, oid);
+            if (e < 0) ERR(e);
+
+            return(eNOERROR);
+        }
+        if (cmp == LESS) ERR(eBADPARAMETER_BTM);
+    }
+    else {
+        e = btm_AllocPage(&bl->handle->catObjForFile, &bl->handle->root, &newPid);
+        if (e < 0) ERR(e);
+
+        e = edubtm_InitLeaf(&newPid, FALSE, FALSE);
+        if (e < 0) ERR(e);
+
+        e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        /* bulk loaded leaves hold full keys */
+        edubtm_BuildLeafPage(bl->handle, npage, NULL, 0, BTM_LEAF_FORMAT(bl->handle, npage) & ~BL_PREFIX);
+
+        e = BfM_SetDirty(&newPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &newPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&newPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        bl->page[0] = newPid;
+        bl->height = 1;
+    }
+
+    e = BfM_GetTrain(&bl->page[0], (char**)&page, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    alignedKlen = ALIGNED_LENGTH(kval->len);
+    if (page->hdr.denseKeyLen != 0)
+        entryLen = page->hdr.denseKeyLen + OBJECTID_SIZE;
+    else
+        entryLen = BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;
+
+    if (page->hdr.nSlots > 0 &&
+        page->hdr.free + (page->hdr.nSlots + 1) * BL_SLOTSIZE(page) + entryLen > bl->leafFill) {
+
+        e = btm_AllocPage(&bl->handle->catObjForFile, &bl->page[0], &newPid);
+        if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+
+        e = edubtm_InitLeaf(&newPid, FALSE, FALSE);
+        if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+
+        e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+
+        edubtm_BuildLeafPage(bl->handle, npage, NULL, 0, BTM_LEAF_FORMAT(bl->handle, page) & ~BL_PREFIX);
+        npage->hdr.prevPage = bl->page[0].pageNo;
+        page->hdr.nextPage = newPid.pageNo;
+
+        e = BfM_SetDirty(&bl->page[0], PAGE_BUF);
+        if (e < 0) ERRB2(e, &bl->page[0], PAGE_BUF, &newPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&bl->page[0], PAGE_BUF);
+        if (e < 0) ERRB1(e, &newPid, PAGE_BUF);
+
+        oldPid = bl->page[0];
+        bl->page[0] = newPid;
+        page = npage;
+
+        edubtm_MakeSeparator(bl->handle, &bl->lastKey, kval, newPid.pageNo, &item);
+
+        e = edubtm_BulkLoadInternal(bl, 1, &item, &oldPid);
+        if (e < 0) ERRB1(e, &newPid, PAGE_BUF);
+    }
+
+    /* keys arrive in order, so the entry always goes after the last slot */
+    if (page->hdr.denseKeyLen != 0)
+        edubtm_InsertDenseEntry(page, page->hdr.nSlots, kval->val, oid);
+    else {
+        entry = (btm_LeafEntry*)&page->data[page->hdr.free];
+        entry->nObjects = 1;
+        entry->klen = kval->len;
+        memcpy(entry->kval, kval->val, kval->len);
+        memcpy(&entry->kval[alignedKlen], oid, OBJECTID_SIZE);
+
+        edubtm_SetLeafSlot(bl->handle, page, page->hdr.nSlots, page->hdr.free);
+        page->hdr.nSlots++;
+        page->hdr.free += entryLen;
+    }
+
+    edubtm_BloomAdd(bl->handle, kval);
+
+    e = BfM_SetDirty(&bl->page[0], PAGE_BUF);
+    if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+
+    e = BfM_FreeTrain(&bl->page[0], PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    bl->lastKey.len = kval->len;
+    memcpy(bl->lastKey.val, kval->val, kval->len);
+
+    return(eNOERROR);
+
+} /* EduBtM_NextBulkLoad() */
+
+
+
+/*@================================
+ * edubtm_BulkLoadDuplicate()
+ *================================*/
+/*
+ * Function: Four edubtm_BulkLoadDuplicate(BtreeBulkLoad*, ObjectID*)
+ *
+ * Description:
+ *  Insert 'oid' into the ObjectIDs of the last entry of the rightmost leaf,
+ *  which is at the end of the data area. The ObjectIDs move to an overflow
+ *  page when the entry would grow beyond OVERFLOW_SPLIT or out of the page.
+ *
+ * Returns:
+ *  error code
+ *    eDUPLICATEDOBJECTID_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_BulkLoadDuplicate(
+    BtreeBulkLoad       *bl,            /* INOUT state of the bulk load */
+    ObjectID            *oid)           /* IN ObjectID which will be inserted */
+{
+    Four                e;              /* error number */
+    Two                 n;              /* # of ObjectIDs of the entry */
+    Two                 idx;            /* the ObjectID goes after element 'idx' */
+    Two                 slotNo;         /* slot of the last entry */
+    Two                 entryLen;       /* length of the last entry */
+    PageID              ovPid;          /* the first overflow page of the entry */
+    BtreeLeaf           *page;          /* the rightmost leaf */
+    btm_LeafEntry       *entry;         /* the last entry */
+    ObjectID            *oidArray;      /* ObjectIDs of the entry */
+
+
+    e = BfM_GetTrain(&bl->page[0], (char**)&page, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    slotNo = page->hdr.nSlots - 1;
+    entry = (btm_LeafEntry*)&page->data[BL_SLOT(page, slotNo)];
+    n = entry->nObjects;
+    entryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(entry->klen) + BTM_OBJECTS_LEN(n);
+
+    if (n == NIL) {
+        MAKE_PAGEID(ovPid, bl->page[0].volNo, *(ShortPageID*)BTM_LEAFENTRY_OBJECTS(entry));
+
+        e = edubtm_InsertOverflow(bl->handle, &ovPid, oid);
+        if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+    }
+    else if (entryLen + OBJECTID_SIZE > OVERFLOW_SPLIT || BL_CFREE(page) < OBJECTID_SIZE) {
+        e = edubtm_CreateOverflow(bl->handle, &bl->page[0], page, slotNo, oid);
+        if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+    }
+    else {
+        oidArray = (ObjectID*)BTM_LEAFENTRY_OBJECTS(entry);
+        if (btm_BinarySearchOidArray(oidArray, oid, n, &idx)) ERRB1(eDUPLICATEDOBJECTID_BTM, &bl->page[0], PAGE_BUF);
+
+        memmove(&oidArray[idx + 2], &oidArray[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+        oidArray[idx + 1] = *oid;
+        entry->nObjects++;
+        page->hdr.free += OBJECTID_SIZE;
+    }
+
+    e = BfM_SetDirty(&bl->page[0], PAGE_BUF);
+    if (e < 0) ERRB1(e, &bl->page[0], PAGE_BUF);
+
+    e = BfM_FreeTrain(&bl->page[0], PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_BulkLoadDuplicate() */
+
+
+
+/*@================================
+ * edubtm_BulkLoadInternal()
+ *================================*/
+/*
+ * Function: Four edubtm_BulkLoadInternal(BtreeBulkLoad*, Four, InternalItem*, PageID*)
+ *
+ * Description:
+ *  Append 'item' to the rightmost internal page on 'level'. 'leftPid' is the
+ *  page on the level below that precedes 'item->spid'; it becomes p0 when
+ *  the level does not exist yet. A filled page passes 'item' up instead of
+ *  storing it, and the child of 'item' becomes p0 of a new page.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM : the tree would exceed BTM_MAXLEVEL levels
+ *    some errors caused by function calls
+ */
+Four edubtm_BulkLoadInternal(
+    BtreeBulkLoad       *bl,            /* INOUT state of the bulk load */
+    Four                level,          /* IN level to which 'item' is appended */
+    InternalItem        *item,          /* IN the item to be appended */
+    PageID              *leftPid)       /* IN left neighbor of the child of 'item' */
+{
+    Four                e;              /* error number */
+    PageID              newPid;         /* a new internal page */
+    PageID              oldPid;         /* the page closed by this call */
+    BtreeInternal       *page;          /* the rightmost page on 'level' */
+    BtreeInternal       *npage;         /* the new page */
+    Two                 entryLen;       /* length of the appended entry */
+
+
+    if (level == bl->height) {
+        if (level >= BTM_MAXLEVEL) ERR(eBADPARAMETER_BTM);
+
+        e = btm_AllocPage(&bl->handle->catObjForFile, leftPid, &newPid);
+        if (e < 0) ERR(e);
+
+        e = edubtm_InitInternal(&newPid, FALSE, FALSE);
+        if (e < 0) ERR(e);
+
+        e = BfM_GetTrain(&newPid, (char**)&page, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        page->hdr.p0 = leftPid->pageNo;
+
+        bl->page[level] = newPid;
+        bl->height++;
+    }
+    else {
+        e = BfM_GetTrain(&bl->page[level], (char**)&page, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen);
+
+    if (page->hdr.nSlots > 0 &&
+        page->hdr.free + (page->hdr.nSlots + 1) * sizeof(Two) + entryLen > bl->internalFill) {
+
+        e = btm_AllocPage(&bl->handle->catObjForFile, &bl->page[level], &newPid);
+        if (e < 0) ERRB1(e, &bl->page[level], PAGE_BUF);
+
+        e = edubtm_InitInternal(&newPid, FALSE, FALSE);
+        if (e < 0) ERRB1(e, &bl->page[level], PAGE_BUF);
+
+        e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERRB1(e, &bl->page[level], PAGE_BUF);
+
+        npage->hdr.p0 = item->spid;
+
+        e = BfM_SetDirty(&newPid, PAGE_BUF);
+        if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &bl->page[level], PAGE_BUF);
+
+        e = BfM_FreeTrain(&newPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &bl->page[level], PAGE_BUF);
+
+        e = BfM_FreeTrain(&bl->page[level], PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        oldPid = bl->page[level];
+        bl->page[level] = newPid;
+
+        /* the key of 'item' separates the closed page from the new one */
+        item->spid = newPid.pageNo;
+
+        e = edubtm_BulkLoadInternal(bl, level + 1, item, &oldPid);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    memcpy(&page->data[page->hdr.free], item, entryLen);
+    page->slot[-page->hdr.nSlots] = page->hdr.free;
+    page->hdr.nSlots++;
+    page->hdr.free += entryLen;
+
+    e = BfM_SetDirty(&bl->page[level], PAGE_BUF);
+    if (e < 0) ERRB1(e, &bl->page[level], PAGE_BUF);
+
+    e = BfM_FreeTrain(&bl->page[level], PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_BulkLoadInternal() */
+
+
+
+/*@================================
+ * EduBtM_FinalBulkLoad()
+ *================================*/
+/*
+ * Function: Four EduBtM_FinalBulkLoad(BtreeBulkLoad*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Complete the bulk load. The top page of the built tree is copied into the
+ *  root page of the index, which keeps its PageID, and is then freed.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_FinalBulkLoad(
+    BtreeBulkLoad       *bl,            /* INOUT state of the bulk load */
+    Pool                *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem     *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                e;              /* error number */
+    PageID              topPid;         /* the top page of the built tree */
+    BtreePage           *tpage;         /* the top page */
+    BtreePage           *rpage;         /* the root page */
+    DeallocListElem     *dlElem;        /* an element of dealloc list */
+
+
+    if (bl == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* the top page is copied into the root and freed */
+    BTM_INVALIDATE_FINGER(bl->handle);
+    edubtm_ClearHotKeys(bl->handle);
+    edubtm_ClearLeafHints(bl->handle);
+
+    /* nothing was loaded; the root stays an empty leaf */
+    if (bl->height == 0) return(eNOERROR);
+
+    topPid = bl->page[bl->height - 1];
+
+    e = BfM_GetTrain(&topPid, (char**)&tpage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    e = BfM_GetTrain(&bl->handle->root, (char**)&rpage, PAGE_BUF);
+    if (e < 0) ERRB1(e, &topPid, PAGE_BUF);
+
+    memcpy(rpage, tpage, PAGESIZE);
+    rpage->any.hdr.pid = bl->handle->root;
+    rpage->any.hdr.type |= ROOT;
+
+    e = BfM_SetDirty(&bl->handle->root, PAGE_BUF);
+    if (e < 0) ERRB2(e, &bl->handle->root, PAGE_BUF, &topPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&bl->handle->root, PAGE_BUF);
+    if (e < 0) ERRB1(e, &topPid, PAGE_BUF);
+
+    tpage->any.hdr.type = FREEPAGE;
+
+    e = BfM_SetDirty(&topPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &topPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&topPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    e = Util_getElementFromPool(dlPool, &dlElem);
+    if (e < 0) ERR(e);
+
+    dlElem->type = DL_PAGE;
+    dlElem->elem.pid = topPid;
+    dlElem->next = dlHead->next;
+    dlHead->next = dlElem;
+
+    bl->height = 0;
+
+    return(eNOERROR);
+
+} /* EduBtM_FinalBulkLoad() */
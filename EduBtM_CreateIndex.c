@@ -66,7 +66,6 @@ Four EduBtM_CreateIndex(
 {
     
     Four e;			/* error number */
-    Boolean isTmp;
     SlottedPage *catPage;	/* buffer page containing the catalog object */
     sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
     PhysicalFileID pFid;	/* physical file ID */ 
@@ -83,7 +82,7 @@ Four EduBtM_CreateIndex(
     e = btm_AllocPage(catObjForFile, (PageID *)&pFid, rootPid);
     if(e<0) ERR(e);
 
-    e = edubtm_InitLeaf(rootPid, TRUE, isTmp);
+    e = edubtm_InitLeaf(rootPid, TRUE, FALSE);
     if(e<0) ERR(e);
 
     
@@ -27,9 +27,13 @@
  *
  * Description : 
  *  Delete from a B+tree an ObjectID 'oid' whose key value is given by "kval".
+ *  EduBtM_DeleteKey() deletes a key of a unique index without its ObjectID,
+ *  and EduBtM_DeleteRange() deletes all keys in a range.
  *
  * Exports:
- *  Four EduBtM_DeleteObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*)
+ *  Four EduBtM_DeleteObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ *  Four EduBtM_DeleteKey(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ *  Four EduBtM_DeleteRange(BtreeHandle*, KeyValue*, KeyValue*, Pool*, DeallocListElem*)
  */
 
 
@@ -39,20 +43,22 @@
 #include "EduBtM_Internal.h"
 
 
+/*@ Internal Function Prototypes */
+Four edubtm_DeleteFromRoot(BtreeHandle*, KeyValue*, ObjectID*, Boolean, Pool*, DeallocListElem*);
+
 
 /*@================================
  * EduBtM_DeleteObject()
  *================================*/
 /*
- * Function: Four EduBtM_DeleteObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*)
+ * Function: Four EduBtM_DeleteObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
  *
  * Description : 
  * (Following description is for original ODYSSEUS/COSMOS BtM.
  *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
  *
  *  Delete from a B+tree an ObjectID 'oid' whose key value is given by "kval".
- *  The B+tree' is specified by the root PageID 'root' and its key descriptor
- *  'kdesc'.
+ *  The B+tree' is specified by the opened index 'handle'.
  *
  *  Deleting an ObjectID causes redistributing internal pages or moving
  *  ObjectIDs in an overflow page to a leaf page. By this reason, the page
@@ -65,65 +71,304 @@
  *    some errors caused by fucntion calls
  */
 Four EduBtM_DeleteObject(
-    ObjectID *catObjForFile,	/* IN catalog object of B+-tree file */
-    PageID   *root,		/* IN root Page IDentifier */
-    KeyDesc  *kdesc,		/* IN a key descriptor */
+    BtreeHandle *handle,	/* IN opened index */
     KeyValue *kval,		/* IN key value */
     ObjectID *oid,		/* IN Object IDentifier */
     Pool     *dlPool,		/* INOUT pool of dealloc list elements */
     DeallocListElem *dlHead) /* INOUT head of the dealloc list */
 {
-    int		i;
+    Four    e;			/* error number */
+    KeyValue nkval;		/* normalized key value */
+
+
+    /*@ check parameters */
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kval == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (oid == NULL) ERR(eBADPARAMETER_BTM);
+    
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (BTM_NORMALIZED(handle)) {
+        e = edubtm_NormalizeKey(&handle->kdesc, kval, &nkval);
+        if (e < 0) ERR(e);
+        kval = &nkval;
+    }
+
+    e = edubtm_DeleteFromRoot(handle, kval, oid, FALSE, dlPool, dlHead);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);   
+}   /* EduBtM_DeleteObject() */
+
+
+
+/*@================================
+ * EduBtM_DeleteKey()
+ *================================*/
+/*
+ * Function: Four EduBtM_DeleteKey(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete the key 'kval' from a unique index and return the ObjectID it had
+ *  in 'oid'. Unlike fetching the ObjectID and deleting it with
+ *  EduBtM_DeleteObject(), the tree is descended once.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTFOUND_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  oid : the ObjectID of the deleted key
+ *
+ * Note:
+ *  A missing key is not reported as an error, and no page is changed.
+ */
+Four EduBtM_DeleteKey(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *kval,		/* IN key value */
+    ObjectID *oid,		/* OUT ObjectID of the deleted key */
+    Pool     *dlPool,		/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    Four    e;			/* error number */
+    KeyValue nkval;		/* normalized key value */
+
+
+    /*@ check parameters */
+    if (handle == NULL || kval == NULL || oid == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* a key of a non-unique index does not tell which ObjectID to delete */
+    if (!(handle->kdesc.flag & KEYFLAG_UNIQUE)) ERR(eBADPARAMETER_BTM);
+
+    if (BTM_NORMALIZED(handle)) {
+        e = edubtm_NormalizeKey(&handle->kdesc, kval, &nkval);
+        if (e < 0) ERR(e);
+        kval = &nkval;
+    }
+
+    e = edubtm_DeleteFromRoot(handle, kval, oid, TRUE, dlPool, dlHead);
+    if (e == eNOTFOUND_BTM) return(e);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* EduBtM_DeleteKey() */
+
+
+
+/*@================================
+ * EduBtM_DeleteRange()
+ *================================*/
+/*
+ * Function: Four EduBtM_DeleteRange(BtreeHandle*, KeyValue*, KeyValue*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete all objects whose keys are from 'startKval' to 'stopKval'
+ *  inclusive. Instead of deleting the keys one by one, the two boundary
+ *  leaves are trimmed, the pages between them are freed at once and only
+ *  the pages on the paths to the boundary leaves are rebalanced (see
+ *  edubtm_DeleteRange.c).
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  Nothing is deleted if 'startKval' is greater than 'stopKval'.
+ */
+Four EduBtM_DeleteRange(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *startKval,	/* IN first key value of the range */
+    KeyValue *stopKval,		/* IN last key value of the range */
+    Pool     *dlPool,		/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
     Four    e;			/* error number */
     Boolean lf;			/* flag for merging */
     Boolean lh;			/* flag for splitting */
+    Boolean empty;		/* unused; the root is never freed */
+    Boolean visited;		/* whether a boundary leaf is reached */
+    ShortPageID left;		/* the leaf before the deleted leaves */
+    ShortPageID right;		/* the leaf after the deleted leaves */
     InternalItem item;		/* Internal item */
     SlottedPage *catPage;	/* buffer page containing the catalog object */
     sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
     PhysicalFileID pFid;        /* B+-tree file's FileID */
+    BtreePage *rootPage;	/* buffer of the root page */
+    KeyValue nstart;		/* normalized first key value */
+    KeyValue nstop;		/* normalized last key value */
 
 
     /*@ check parameters */
-    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+    if (handle == NULL || startKval == NULL || stopKval == NULL) ERR(eBADPARAMETER_BTM);
 
-    if (root == NULL) ERR(eBADPARAMETER_BTM);
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
 
-    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+    if (BTM_NORMALIZED(handle)) {
+        e = edubtm_NormalizeKey(&handle->kdesc, startKval, &nstart);
+        if (e < 0) ERR(e);
+        startKval = &nstart;
 
-    if (kval == NULL) ERR(eBADPARAMETER_BTM);
+        e = edubtm_NormalizeKey(&handle->kdesc, stopKval, &nstop);
+        if (e < 0) ERR(e);
+        stopKval = &nstop;
+    }
 
-    if (oid == NULL) ERR(eBADPARAMETER_BTM);
-    
-    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+    if (BTM_KEYCOMPARE(handle, startKval, stopKval) == GREATER) return(eNOERROR);
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+    /* the key ranges of the leaves change, and pinned pages and leaves of hot keys may be freed */
+    BTM_INVALIDATE_FINGER(handle);
+    edubtm_ClearHotKeys(handle);
+    edubtm_ClearLeafHints(handle);
+
+    e = edubtm_UnpinAll(handle);
+    if (e < 0) ERR(e);
+
+    e = BfM_GetTrain(&handle->catObjForFile, (char**)&catPage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    GET_PTR_TO_CATENTRY_FOR_BTREE(&handle->catObjForFile, catPage, catEntry);
+
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+
+    e = BfM_FreeTrain(&handle->catObjForFile, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    /*@ delete the pages of the range and link the leaves around them */
+    visited = FALSE;
+    e = edubtm_SpliceRange(handle, &pFid, &handle->root, startKval, stopKval, &empty,
+                           &left, &right, &visited, dlPool, dlHead);
+    if (e < 0) ERR(e);
+
+    if (visited && left != right) {
+        e = edubtm_LinkLeaves(handle->root.volNo, left, right);
+        if (e < 0) ERR(e);
     }
-    
-    e = edubtm_Delete(catObjForFile, root, kdesc, kval, oid, &lf, &lh, &item, dlPool, dlHead);
+
+    /*@ rebalance the pages on the paths to the boundary leaves */
+    e = edubtm_RebalanceRange(handle, &handle->root, startKval, stopKval, &lf, &lh, &item, dlPool, dlHead);
+    if (e < 0) ERR(e);
+
+    if (lh) {
+        e = edubtm_root_insert(&handle->catObjForFile, &handle->root, &item);
+        if (e < 0) ERR(e);
+    }
+    else if (lf) {
+        /* the root may be left with one child on several levels */
+        do {
+            e = btm_root_delete(&pFid, &handle->root, dlPool, dlHead);
+            if (e < 0) ERR(e);
+
+            e = BfM_GetTrain(&handle->root, (char**)&rootPage, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            lf = (rootPage->any.hdr.type & INTERNAL) && rootPage->bi.hdr.nSlots == 0;
+
+            e = BfM_FreeTrain(&handle->root, PAGE_BUF);
+            if (e < 0) ERR(e);
+        } while (lf);
+    }
+
+    return(eNOERROR);
+
+}   /* EduBtM_DeleteRange() */
+
+
+
+/*@================================
+ * edubtm_DeleteFromRoot()
+ *================================*/
+/*
+ * Function: Four edubtm_DeleteFromRoot(BtreeHandle*, KeyValue*, ObjectID*, Boolean,
+ *                                     Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete the normalized key 'kval' by edubtm_Delete() from the root of the
+ *  index, and then collapse the root if it is not half full or put a new
+ *  root over it if it is splitted. A key which the Bloom filter of the
+ *  index does not pass is not looked for.
+ *
+ * Returns:
+ *  error code
+ *    eNOTFOUND_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_DeleteFromRoot(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *kval,		/* IN normalized key value */
+    ObjectID *oid,		/* INOUT Object IDentifier */
+    Boolean  byKey,		/* IN TRUE if deleted by the key only */
+    Pool     *dlPool,		/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    Four    e;			/* error number */
+    Boolean lf;			/* flag for merging */
+    Boolean lh;			/* flag for splitting */
+    InternalItem item;		/* Internal item */
+    SlottedPage *catPage;	/* buffer page containing the catalog object */
+    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
+    PhysicalFileID pFid;        /* B+-tree file's FileID */
+    BtreePage *rootPage;	/* buffer of the root page */
+    PageID  child;		/* the only child of the root */
+
+
+    /* a key surely not in the index is not looked for */
+    if (!edubtm_BloomMayContain(handle, kval)) {
+        if (byKey) return(eNOTFOUND_BTM);
+        ERR(eNOTFOUND_BTM);
+    }
+
+    e = edubtm_Delete(handle, &handle->root, kval, oid, byKey, &lf, &lh, &item, dlPool, dlHead);
+    if (e == eNOTFOUND_BTM && handle->bloom.nCounters > 0) handle->bloom.nFalsePositives++;
+    if (e == eNOTFOUND_BTM && byKey) return(e);
     if(e<0)ERR(e);
 
-    e = BfM_GetTrain(catObjForFile, (char**)&catPage, PAGE_BUF);
+    e = BfM_GetTrain(&handle->catObjForFile, (char**)&catPage, PAGE_BUF);
     if(e<0)ERR(e);
 
-    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(&handle->catObjForFile, catPage, catEntry);
 
     MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage); // because root can not be the same anymore 
 
-    e = BfM_FreeTrain(catObjForFile, PAGE_BUF);
+    e = BfM_FreeTrain(&handle->catObjForFile, PAGE_BUF);
     if(e<0)ERR(e); 
 
     if (lf) {
-        e = btm_root_delete(&pFid, root, dlPool, dlHead);
+        e = BfM_GetTrain(&handle->root, (char**)&rootPage, PAGE_BUF);
+        if(e<0)ERR(e);
+
+        /* a root without entries takes over its only child, which is freed */
+        child.pageNo = NIL;
+        if ((rootPage->any.hdr.type & INTERNAL) && rootPage->bi.hdr.nSlots == 0)
+            MAKE_PAGEID(child, handle->root.volNo, rootPage->bi.hdr.p0);
+
+        e = BfM_FreeTrain(&handle->root, PAGE_BUF);
+        if(e<0)ERR(e);
+
+        if (child.pageNo != NIL) {
+            e = edubtm_UnpinPage(handle, &child);
+            if(e<0)ERR(e);
+
+            /* the entries of the child move into the root */
+            BTM_LEAF_MOVED(handle, child.pageNo);
+            BTM_LEAF_MOVED(handle, handle->root.pageNo);
+        }
+
+        e = btm_root_delete(&pFid, &handle->root, dlPool, dlHead);
         if(e<0)ERR(e);
     }
 
     if (lh) {
-        e = edubtm_root_insert(catObjForFile, root, &item);
+        e = edubtm_root_insert(&handle->catObjForFile, &handle->root, &item);
         if(e<0)ERR( e );
     }
-    return(eNOERROR);   
-}   /* EduBtM_DeleteObject() */
+    return(eNOERROR);
+
+}   /* edubtm_DeleteFromRoot() */
@@ -35,7 +35,7 @@
  *  the comparison operator is one among SM_BOF, SM_EOF, SM_EQ, SM_LT, SM_LE, SM_GT, SM_GE.
  *
  * Exports:
- *  Four EduBtM_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*)
+ *  Four EduBtM_Fetch(BtreeHandle*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*)
  */
 
 
@@ -46,7 +46,7 @@
 
 
 /*@ Internal Function Prototypes */
-Four edubtm_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
+Four edubtm_Fetch(BtreeHandle*, PageID*, Two, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
 
 
 
@@ -54,13 +54,16 @@ Four edubtm_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCurs
  * EduBtM_Fetch()
  *================================*/
 /*
- * Function: Four EduBtM_Fetch(PageID*, KeyDesc*, KeyVlaue*, Four, KeyValue*, Four, BtreeCursor*)
+ * Function: Four EduBtM_Fetch(BtreeHandle*, KeyVlaue*, Four, KeyValue*, Four, BtreeCursor*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
  *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
  *
  *  Find the first object satisfying the given condition. See above for detail.
+ *  An SM_EQ probe may be answered by the Bloom filter or the hot keys of
+ *  'handle' without any page access (see edubtm_Bloom.c, edubtm_HotKey.c),
+ *  or start at the leaf to which its key is mapped (see edubtm_LeafHash.c).
  *
  * Returns:
  *  error code
@@ -72,44 +75,101 @@ Four edubtm_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCurs
  *            (it may indicate a ObjectID in an  overflow page).
  */
 Four EduBtM_Fetch(
-    PageID   *root,		/* IN The current root of the subtree */
-    KeyDesc  *kdesc,		/* IN Btree key descriptor */
+    BtreeHandle *handle,	/* IN opened index */
     KeyValue *startKval,	/* IN key value of start condition */
     Four     startCompOp,	/* IN comparison operator of start condition */
     KeyValue *stopKval,		/* IN key value of stop condition */
     Four     stopCompOp,	/* IN comparison operator of stop condition */
     BtreeCursor *cursor)	/* OUT Btree Cursor */
 {
-    int i;
     Four e;		   /* error number */
+    KeyValue nStartKval;   /* normalized key value of start condition */
+    KeyValue nStopKval;    /* normalized key value of stop condition */
+    Boolean  hotKey;       /* TRUE if the probe may be answered by the hot keys */
+    Boolean  answered;     /* TRUE if the probe is answered by the hot keys */
+    Boolean  hashed;       /* TRUE if the probe starts at the leaf to which its key is mapped */
+    PageID   leaf;         /* the leaf to which the key is mapped */
+    Two      hint;         /* slot where the key was last seen in 'leaf' */
 
     
-    if (root == NULL) ERR(eBADPARAMETER_BTM);
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* the tree holds keys of several parts normalized; so is the key of 'cursor' until it is returned */
+    if (BTM_NORMALIZED(handle)) {
+        if (startCompOp != SM_BOF && startCompOp != SM_EOF) {
+            e = edubtm_NormalizeKey(&handle->kdesc, startKval, &nStartKval);
+            if (e < 0) ERR(e);
+            startKval = &nStartKval;
+        }
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+        if (stopCompOp != SM_BOF && stopCompOp != SM_EOF) {
+            e = edubtm_NormalizeKey(&handle->kdesc, stopKval, &nStopKval);
+            if (e < 0) ERR(e);
+            stopKval = &nStopKval;
+        }
     }
 
-    if (startCompOp == SM_BOF){
-        e =edubtm_FirstObject(root, kdesc, stopKval, stopCompOp, cursor);
-        if(e<0)ERR(e);
+    /* a key surely not in the index is not looked for */
+    if (startCompOp == SM_EQ && !edubtm_BloomMayContain(handle, startKval)) {
+        cursor->flag = CURSOR_EOS;
+        return(eNOERROR);
     }
 
+    /* these stop conditions give the first ObjectID of the key, as kept in the hot keys */
+    hotKey = (startCompOp == SM_EQ && handle->hot.nEntries > 0 &&
+              (stopCompOp == SM_EQ || stopCompOp == SM_EOF));
+    answered = hotKey && edubtm_LookUpHotKey(handle, startKval, cursor);
+    hashed = FALSE;
 
-    if (startCompOp == SM_EOF){
-        e =edubtm_LastObject(root, kdesc, stopKval, stopCompOp, cursor);
+    if (answered) {
+        /* no page is accessed */
+    }
+    else if (startCompOp == SM_BOF){
+        e =edubtm_FirstObject(handle, stopKval, stopCompOp, cursor);
         if(e<0)ERR(e);
     }
+    else if (startCompOp == SM_EOF){
+        e =edubtm_LastObject(handle, stopKval, stopCompOp, cursor);
+        if(e<0)ERR(e);
+    }
+    else if (edubtm_FingerCovers(handle, startKval)) {
+        /* the search starts at the leaf of the finger */
+        e =edubtm_Fetch(handle, &handle->finger.leaf, NIL, startKval, startCompOp, stopKval, stopCompOp, cursor);
+        if(e<0)ERR(e);
+    }
+    else if (startCompOp == SM_EQ && handle->leafHash.nEntries > 0 &&
+             edubtm_LookUpLeafHint(handle, startKval, &leaf, &hint)) {
+        /* the search starts at the leaf of the key, leaving the finger as it is */
+        hashed = TRUE;
 
-
+        e =edubtm_Fetch(handle, &leaf, hint, startKval, startCompOp, stopKval, stopCompOp, cursor);
+        if(e<0)ERR(e);
+    }
     else{
-        e =edubtm_Fetch(root, kdesc, startKval, startCompOp, stopKval, stopCompOp, cursor);
+        edubtm_ResetFinger(handle);
+
+        e =edubtm_Fetch(handle, &handle->root, NIL, startKval, startCompOp, stopKval, stopCompOp, cursor);
         if(e<0)ERR(e);
+
+        if (startCompOp == SM_EQ && cursor->flag == CURSOR_ON)
+            edubtm_KeepLeafHint(handle, startKval, cursor);
     } 
 
+    /* the key has moved within its leaf; the hint is repaired */
+    if (hashed && cursor->flag == CURSOR_ON && cursor->slotNo != hint)
+        edubtm_KeepLeafHint(handle, startKval, cursor);
+
+    if (hotKey && !answered && cursor->flag == CURSOR_ON)
+        edubtm_KeepHotKey(handle, startKval, cursor);
+
+    /* the key passed the Bloom filter but is not in the index */
+    if (startCompOp == SM_EQ && handle->bloom.nCounters > 0 && cursor->flag != CURSOR_ON &&
+        (stopCompOp == SM_EQ || stopCompOp == SM_BOF || stopCompOp == SM_EOF))
+        handle->bloom.nFalsePositives++;
+
+    if (BTM_NORMALIZED(handle) && cursor->flag == CURSOR_ON)
+        edubtm_DenormalizeKey(&handle->kdesc, &cursor->key, &cursor->key);
+
     return(eNOERROR);
 
 } /* EduBtM_Fetch() */
@@ -120,7 +180,7 @@ Four EduBtM_Fetch(
  * edubtm_Fetch()
  *================================*/
 /*
- * Function: Four edubtm_Fetch(PageID*, KeyDesc*, KeyVlaue*, Four, KeyValue*, Four, BtreeCursor*)
+ * Function: Four edubtm_Fetch(BtreeHandle*, PageID*, Two, KeyVlaue*, Four, KeyValue*, Four, BtreeCursor*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -130,6 +190,12 @@ Four EduBtM_Fetch(
  *  This function handles only the following conditions:
  *  SM_EQ, SM_LT, SM_LE, SM_GT, SM_GE.
  *
+ *  The descent keeps only the page visited and its child fixed; pinned
+ *  pages are read from 'handle' (see edubtm_Pin.c). It is recorded in the
+ *  finger of 'handle'; the caller resets the finger before descending from
+ *  the root. A search started at a leaf by its slot 'hint' is not recorded;
+ *  the key is looked for at the slot before the leaf is searched.
+ *
  * Returns:
  *  Error code *   
  *    eBADCOMPOP_BTM
@@ -137,8 +203,9 @@ Four EduBtM_Fetch(
  *    some errors caused by function calls
  */
 Four edubtm_Fetch(
+    BtreeHandle         *handle,        /* IN opened index */
     PageID              *root,          /* IN The current root of the subtree */
-    KeyDesc             *kdesc,         /* IN Btree key descriptor */
+    Two                 hint,           /* IN slot of the start key in the leaf 'root', NIL if unknown */
     KeyValue            *startKval,     /* IN key value of start condition */
     Four                startCompOp,    /* IN comparison operator of start condition */
     KeyValue            *stopKval,      /* IN key value of stop condition */
@@ -148,9 +215,10 @@ Four edubtm_Fetch(
     Four                e;              /* error number */
     Four                cmp;            /* result of comparison */
     Two                 idx;            /* index */
-    PageID              child;          /* child page when the root is an internla page */
-    Two                 alignedKlen;    /* aligned size of the key length */
-    BtreePage           *apage;         /* a Page Pointer to the given root */
+    PageID              pid;            /* the page visited */
+    PageID              child;          /* child page when the page visited is an internal page */
+    BtreePage           *apage;         /* a Page Pointer to the page visited */
+    BtreePage           *cpage;         /* a Page Pointer to the child page */
     BtreeOverflow       *opage;         /* a page pointer if it necessary to access an overflow page */
     Boolean             found;          /* search result */
     PageID              *leafPid;       /* leaf page pointed by the cursor */
@@ -159,229 +227,160 @@ Four edubtm_Fetch(
     PageNo              ovPageNo;       /* PageNo of the overflow page */
     PageID              prevPid;        /* PageID of the previous page */
     PageID              nextPid;        /* PageID of the next page */
-    ObjectID            *oidArray;      /* array of the ObjectIDs */
     Two                 iEntryOffset;   /* starting offset of an internal entry */
     btm_InternalEntry   *iEntry;        /* an internal entry */
-    Two                 lEntryOffset;   /* starting offset of a leaf entry */
-    btm_LeafEntry       *lEntry;        /* a leaf entry */
+    Two                 level;          /* level of the page visited, 0 for the root */
+    Two                 slot;           /* slot of the page visited if it is pinned, else NIL */
+    Two                 cslot;          /* slot of the child page if it is pinned, else NIL */
+    KeyValue            tKey;           /* the key at the slot 'hint' */
 
 
-    /* Error check whether using not supported functionality by EduBtM */
-    int i;
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
 
-    e = BfM_GetTrain(root, (char**)&apage, PAGE_BUF);
+    pid = *root;
+    level = 0;
+
+    e = edubtm_FixPage(handle, &pid, level, &apage, &slot);
     if(e<0)ERR(e);
 
+    /* Descend to the leaf, fixing each child before freeing its parent */
+    while (apage->any.hdr.type & INTERNAL) {
+        edubtm_BinarySearchInternal(&apage->bi, handle, startKval, &idx);
+
+        child.volNo = pid.volNo;
+        if (idx == -1) {
+            child.pageNo = apage->bi.hdr.p0;
+        } 
+        else {
+            iEntryOffset = apage->bi.slot[-idx];
+            iEntry = (btm_InternalEntry*)&apage->bi.data[iEntryOffset];
+            child.pageNo = iEntry->spid;
+        }
+        edubtm_NarrowFinger(handle, &pid, &apage->bi, idx);
 
-/*If the root page given as a parameter is an internal page, Call edubtm_Fetch() recursively*/    
+        e = edubtm_FixPage(handle, &child, level + 1, &cpage, &cslot);
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&pid, slot != NIL);
+            ERR(e);
+        }
 
-    if (apage->any.hdr.type & INTERNAL) {
-        found = edubtm_BinarySearchInternal(apage, kdesc, startKval, &idx);
+        e = edubtm_UnfixPage(&pid, slot != NIL);
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&child, cslot != NIL);
+            ERR(e);
+        }
 
-    if (idx != -1) {
-        iEntryOffset = apage->bi.slot[-idx];
-        iEntry = (btm_InternalEntry*)&apage->bi.data[iEntryOffset];
-        nextPid.pageNo = iEntry->spid;
-        nextPid.volNo = root->volNo;
-    } 
-    else {
-        nextPid.pageNo = apage->bi.hdr.p0;
-        nextPid.volNo = root->volNo;
+        pid = child;
+        apage = cpage;
+        slot = cslot;
+        level++;
     }
-    e = edubtm_Fetch(&nextPid, kdesc, startKval, startCompOp, stopKval, stopCompOp, cursor);
-    if(e<0) ERR(e);
-    e = BfM_FreeTrain(root, PAGE_BUF);
-    if(e<0)ERR(e);
-    return(eNOERROR);
+
+    /* only internal pages are pinned, so the page reached is fixed */
+    if (!(apage->any.hdr.type & LEAF)) {
+        ERRB1(eBADBTREEPAGE_BTM, &pid, PAGE_BUF);
     }
 
-/*If the root page given as a parameter is a leaf page Many Cases to take into acount*/
-    
-    else if (apage->any.hdr.type & LEAF) {
-        found = edubtm_BinarySearchLeaf(apage, kdesc, startKval, &idx);
-        leafPid = root;
-
-        if (startCompOp == SM_EQ){
-            if (found) slotNo = idx;
-            else{
-                cursor->flag = CURSOR_EOS;
-                e = BfM_FreeTrain(root, PAGE_BUF);
-                if(e<0)ERR(e);
-                return(eNOERROR);
-            }
-        }
+    /* The page reached is a leaf page */
+    found = FALSE;
+    if (hint == NIL)
+        edubtm_SetFingerLeaf(handle, &pid);
+    else if (hint < apage->bl.hdr.nSlots) {
+        edubtm_GetLeafObject(&apage->bl, hint, &tKey, NULL);
+        found = (BTM_KEYCOMPARE(handle, &tKey, startKval) == EQUAL);
+        idx = hint;
+    }
 
-        else if(startCompOp == SM_LT){
-            if (found){
-                // if the index entry is the first one of the page then we need to go to the previous page
-                if (idx == 0){
-                    prevPid.pageNo = apage->bl.hdr.prevPage;
-                    prevPid.volNo = root->volNo;
-
-                    e = BfM_FreeTrain(root, PAGE_BUF);
-                    if(e<0)ERR(e);
-
-                    if(prevPid.pageNo == NIL){
-                        cursor->flag = CURSOR_EOS;
-                        return(eNOERROR);
-                    }
-                    e = BfM_GetTrain(&prevPid, (char**)&apage, PAGE_BUF);
-                    if(e<0)ERR(e);
-                    idx = apage->bl.hdr.nSlots - 1;
-                    slotNo = idx;
-                    leafPid = &prevPid;
-                }
-                else{
-                    slotNo = idx - 1;
-                }
-            }
-            else {
-                cursor->flag = CURSOR_EOS;
-                e = BfM_FreeTrain(root, PAGE_BUF);
-                if(e<0)ERR(e);
-                return(eNOERROR);
-            }            
+    if (!found)
+        found = edubtm_BinarySearchLeaf(&apage->bl, handle, startKval, &idx);
+    leafPid = &pid;
+
+    /* idx is the slot of the key itself if found, else of the largest smaller key */
+    switch (startCompOp) {
+      case SM_EQ:
+        if (!found) {
+            cursor->flag = CURSOR_EOS;
+            e = BfM_FreeTrain(&pid, PAGE_BUF);
+            if(e<0)ERR(e);
+            return(eNOERROR);
         }
+        slotNo = idx;
+        break;
 
-        else if(startCompOp == SM_LE){
-            if (found) {
-                slotNo = idx;
-            } else {
-                if (idx != -1) slotNo = idx; // meaning the key is smaller than every element
-                else {
-                    cursor->flag = CURSOR_EOS;
-                    e = BfM_FreeTrain(root, PAGE_BUF);
-                    if(e<0)ERR(e);
-                    return(eNOERROR);
-                }
-            }
-        }
+      case SM_LT:
+        slotNo = (found) ? idx - 1 : idx;
+        break;
 
+      case SM_LE:
+        slotNo = idx;
+        break;
 
-        else if (startCompOp == SM_GT){
-            if (found){
-                // if the index entry is the last one of the page then we need to go to the next page
-                if (idx == apage->bl.hdr.nSlots - 1){
-                    nextPid.pageNo = apage->bl.hdr.nextPage;
-                    nextPid.volNo = root->volNo;
-
-                    e = BfM_FreeTrain(root, PAGE_BUF);
-                    if(e<0)ERR(e);
-
-                    if(nextPid.pageNo == NIL){
-                        cursor->flag = CURSOR_EOS;
-                        return(eNOERROR);
-                    }
-                    e = BfM_GetTrain(&nextPid, (char**)&apage, PAGE_BUF);
-                    if(e<0)ERR(e);
-                    idx = 0;
-                    slotNo = idx;
-                    leafPid = &nextPid;
-                }
-                else{
-                    slotNo = idx + 1;
-                }
-            }
-            else {
-                if (idx == apage->bl.hdr.nSlots - 1) {
-                    nextPid.volNo = root->volNo;
-                    nextPid.pageNo = apage->bl.hdr.nextPage;
-                    e = BfM_FreeTrain(root, PAGE_BUF);
-                    if(e<0) ERR(e);
-
-                    if (nextPid.pageNo == NIL) {
-                        cursor->flag = CURSOR_EOS;
-                        return(eNOERROR);
-                    } 
-                    e = BfM_GetTrain(&nextPid, &apage, PAGE_BUF);
-                    if(e<0) ERR(e);
-                    idx = 0;
-                    slotNo = idx;
-                    leafPid = &nextPid;
-                } else {
-                    slotNo = idx + 1;
-                }
-                
-            }
-        }
+      case SM_GT:
+        slotNo = idx + 1;
+        break;
 
-        else if (startCompOp == SM_GE){
-            if (found) idx = idx;
-            else if (idx == -1) idx = 0;
-            else {
-                if(idx != apage->bl.hdr.nSlots - 1) idx += 1;
-                else {
-                    nextPid.volNo = root->volNo;
-                    nextPid.pageNo = apage->bl.hdr.nextPage;
-                    e = BfM_FreeTrain(root, PAGE_BUF);
-                    if(e<0) ERR(e);
-
-                    if (nextPid.pageNo == NIL) {
-                        cursor->flag = CURSOR_EOS;
-                        return(eNOERROR);
-                    } 
-                    e = BfM_GetTrain(&nextPid, &apage, PAGE_BUF);
-                    if(e<0) ERR(e);
-                    idx = 0;
-                    slotNo = idx;
-                    leafPid = &nextPid;
-
-                }
-            }
-        }
+      case SM_GE:
+        slotNo = (found) ? idx : idx + 1;
+        break;
 
-        lEntryOffset = apage->bl.slot[-slotNo];
-        lEntry = (btm_LeafEntry*)&apage->bl.data[lEntryOffset];
-        alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-        oidArray = &lEntry->kval[alignedKlen];
+      default:
+        ERRB1(eBADCOMPOP_BTM, &pid, PAGE_BUF);
+    }
 
-        //SETUP THE CURSOR VALUES
-        cursor->flag = CURSOR_ON;
-        cursor->leaf = *leafPid;
-        cursor->slotNo = slotNo;
-        cursor->oid = *oidArray;
-        cursor->key.len = lEntry->klen;
-        memcpy(cursor->key.val, lEntry->kval, lEntry->klen);
-        //END SETUP CURSOR
+    /* The wanted entry may lie in the neighbour leaf. */
+    if (slotNo < 0) {
+        MAKE_PAGEID(prevPid, pid.volNo, apage->bl.hdr.prevPage);
 
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if(e<0)ERR(e);
 
-        if (stopCompOp != SM_EOF && stopCompOp != SM_BOF) {
+        if (prevPid.pageNo == NIL) {
+            cursor->flag = CURSOR_EOS;
+            return(eNOERROR);
+        }
 
-            cmp = edubtm_KeyCompare(kdesc, &cursor->key, stopKval);
+        e = BfM_GetTrain(&prevPid, (char**)&apage, PAGE_BUF);
+        if(e<0)ERR(e);
 
-            if (stopCompOp == SM_EQ) {
-                if (cmp != EQUAL) cursor->flag = CURSOR_INVALID;
-            }
+        leafPid = &prevPid;
+        slotNo = apage->bl.hdr.nSlots - 1;
+    }
+    else if (slotNo >= apage->bl.hdr.nSlots) {
+        MAKE_PAGEID(nextPid, pid.volNo, apage->bl.hdr.nextPage);
 
-            if (stopCompOp == SM_LT) {
-                if (cmp != LESS) cursor->flag = CURSOR_INVALID;
-            }
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if(e<0)ERR(e);
 
-            if (stopCompOp == SM_LE) {
-                if (cmp != LESS && cmp != EQUAL) cursor->flag = CURSOR_INVALID;
-            }
+        if (nextPid.pageNo == NIL) {
+            cursor->flag = CURSOR_EOS;
+            return(eNOERROR);
+        }
 
-            if (stopCompOp == SM_GT) {
-                if (cmp != GREATER) cursor->flag = CURSOR_INVALID;
-            }
+        e = BfM_GetTrain(&nextPid, (char**)&apage, PAGE_BUF);
+        if(e<0)ERR(e);
 
-            if (stopCompOp == SM_GE) {
-                if (cmp != GREATER && cmp != EQUAL) cursor->flag = CURSOR_INVALID;
-            }
-        }
+        leafPid = &nextPid;
+        slotNo = 0;
+    }
 
-        e = BfM_FreeTrain(root, PAGE_BUF);
-        if(e<0) ERR(e);
-        return (eNOERROR);
+    /* a backward scan starts from the last ObjectID of the entry */
+    e = edubtm_SetCursorObject(&apage->bl, leafPid, slotNo, BTM_SCAN_BACKWARD(stopCompOp), cursor);
+    if(e<0) ERRB1(e, leafPid, PAGE_BUF);
 
+    /* Check the stop condition; an SM_EQ stop condition is left to edubtm_FetchNext() */
+    if (stopCompOp != SM_EOF && stopCompOp != SM_BOF && stopCompOp != SM_EQ) {
+        cmp = BTM_KEYCOMPARE(handle, &cursor->key, stopKval);
+
+        if ((stopCompOp == SM_LT && cmp != LESS) ||
+            (stopCompOp == SM_LE && cmp == GREAT) ||
+            (stopCompOp == SM_GT && cmp != GREAT) ||
+            (stopCompOp == SM_GE && cmp == LESS))
+            cursor->flag = CURSOR_EOS;
     }
-    else ERR(eBADBTREEPAGE_BTM);
-    
+
+    e = BfM_FreeTrain(leafPid, PAGE_BUF);
+    if(e<0) ERR(e);
+
+    return(eNOERROR);
     
 } /* edubtm_Fetch() */
 
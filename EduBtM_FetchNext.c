@@ -27,10 +27,13 @@
  *
  * Description:
  *  Find the next ObjectID satisfying the given condition. The current ObjectID
- *  is specified by the 'current'.
+ *  is specified by the 'current'. EduBtM_FetchNextBatch() returns the following
+ *  ObjectIDs of a leaf in one call.
  *
  * Exports:
- *  Four EduBtM_FetchNext(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*)
+ *  Four EduBtM_FetchNext(BtreeHandle*, KeyValue*, Four, BtreeCursor*, BtreeCursor*)
+ *  Four EduBtM_FetchNextBatch(BtreeHandle*, KeyValue*, Four, BtreeCursor*, Four,
+ *                             BtreeFetchResult*, Four*, BtreeCursor*)
  */
 
 
@@ -41,7 +44,9 @@
 
 
 /*@ Internal Function Prototypes */
-Four edubtm_FetchNext(KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
+Four edubtm_FetchNext(BtreeHandle*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
+Four edubtm_FetchNextBatch(BtreeHandle*, KeyValue*, Four, BtreeCursor*, Four, BtreeFetchResult*, Four*, BtreeCursor*);
+Boolean edubtm_StopConditionMet(BtreeHandle*, KeyValue*, Four, BtreeLeaf*, Two);
 
 
 
@@ -49,7 +54,7 @@ Four edubtm_FetchNext(KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
  * EduBtM_FetchNext()
  *================================*/
 /*
- * Function: Four EduBtM_FetchNext(PageID*, KeyDesc*, KeyValue*,
+ * Function: Four EduBtM_FetchNext(BtreeHandle*, KeyValue*,
  *                              Four, BtreeCursor*, BtreeCursor*)
  *
  * Description:
@@ -68,14 +73,12 @@ Four edubtm_FetchNext(KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
  *    some errors caused by function calls
  */
 Four EduBtM_FetchNext(
-    PageID                      *root,          /* IN root page's PageID */
-    KeyDesc                     *kdesc,         /* IN key descriptor */
+    BtreeHandle                 *handle,        /* IN opened index */
     KeyValue                    *kval,          /* IN key value of stop condition */
     Four                        compOp,         /* IN comparison operator of stop condition */
     BtreeCursor                 *current,       /* IN current B+ tree cursor */
     BtreeCursor                 *next)          /* OUT next B+ tree cursor */
 {
-    int							i;
     Four                        e;              /* error number */
     Four                        cmp;            /* comparison result */
     Two                         slotNo;         /* slot no. of a leaf page */
@@ -88,10 +91,11 @@ Four EduBtM_FetchNext(
     BtreeOverflow               *opage;         /* pointer to a buffer holding an overflow page */
     btm_LeafEntry               *entry;         /* pointer to a leaf entry */
     BtreeCursor                 tCursor;        /* a temporary Btree cursor */
+    KeyValue                    nkval;          /* normalized key value of stop condition */
   
     
     /*@ check parameter */
-    if (root == NULL || kdesc == NULL || kval == NULL || current == NULL || next == NULL)
+    if (handle == NULL || kval == NULL || current == NULL || next == NULL)
 	ERR(eBADPARAMETER_BTM);
     
     /* Is the current cursor valid? */
@@ -99,15 +103,26 @@ Four EduBtM_FetchNext(
 		ERR(eBADCURSOR);
     
     if (current->flag == CURSOR_EOS) return(eNOERROR);
-    
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+
+    /* the tree holds keys of several parts normalized */
+    if (BTM_NORMALIZED(handle)) {
+        if (compOp != SM_BOF && compOp != SM_EOF) {
+            e = edubtm_NormalizeKey(&handle->kdesc, kval, &nkval);
+            if (e < 0) ERR(e);
+            kval = &nkval;
+        }
+
+        tCursor = *current;
+        e = edubtm_NormalizeKey(&handle->kdesc, &current->key, &tCursor.key);
+        if (e < 0) ERR(e);
+        current = &tCursor;
     }
-    e =edubtm_FetchNext(kdesc, kval, compOp, current, next);
+    
+    e =edubtm_FetchNext(handle, kval, compOp, current, next);
     if(e<0)ERR(e);
+
+    if (BTM_NORMALIZED(handle) && next->flag == CURSOR_ON)
+        edubtm_DenormalizeKey(&handle->kdesc, &next->key, &next->key);
     
     return(eNOERROR);
     
@@ -119,7 +134,7 @@ Four EduBtM_FetchNext(
  * edubtm_FetchNext()
  *================================*/
 /*
- * Function: Four edubtm_FetchNext(KeyDesc*, KeyValue*, Four,
+ * Function: Four edubtm_FetchNext(BtreeHandle*, KeyValue*, Four,
  *                              BtreeCursor*, BtreeCursor*)
  *
  * Description:
@@ -135,7 +150,7 @@ Four EduBtM_FetchNext(
  *    some errors caused by function calls
  */
 Four edubtm_FetchNext(
-    KeyDesc  		*kdesc,		/* IN key descriptor */
+    BtreeHandle		*handle,	/* IN opened index */
     KeyValue 		*kval,		/* IN key value of stop condition */
     Four     		compOp,		/* IN comparison operator of stop condition */
     BtreeCursor 	*current,	/* IN current cursor */
@@ -150,88 +165,390 @@ Four edubtm_FetchNext(
     BtreeLeaf 		*apage;		/* pointer to a buffer holding a leaf page */
     BtreeOverflow 	*opage;		/* pointer to a buffer holding an overflow page */
     btm_LeafEntry 	*entry;		/* pointer to a leaf entry */    
+    Two 		slotNo;		/* slot no. of the next entry */
+    Boolean 		found;		/* whether the entry has a next ObjectID */
     
     
-    /* Error check whether using not supported functionality by EduBtM */
-    int i;
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
-    e = BfM_GetTrain(&current->leaf, (char**)&apage, PAGE_BUF);
-    if(e<0)ERR(e);
     leaf = current->leaf;
+    e = BfM_GetTrain(&leaf, (char**)&apage, PAGE_BUF);
+    if(e<0)ERR(e);
+
+    /* The next ObjectID of the same key satisfies the stop condition as the current one does. */
+    e = edubtm_NextObjectOfEntry(apage, current, BTM_SCAN_BACKWARD(compOp), next, &found);
+    if(e<0)ERRB1(e, &leaf, PAGE_BUF);
 
-    if (compOp == SM_EQ) {
-        next->flag = CURSOR_INVALID;
+    if (found) {
         e = BfM_FreeTrain(&leaf, PAGE_BUF);
-        if(e<0) ERR(e);
+        if(e<0)ERR(e);
+
         return(eNOERROR);
-    } 
+    }
 
-    else if(compOp == SM_LT || compOp == SM_LE) {
-        if (current->slotNo == apage->hdr.nSlots - 1) {
-            if(apage->hdr.nextPage == NIL){
+    /* GT, GE and BOF stop conditions scan backward; the others scan forward */
+    if (BTM_SCAN_BACKWARD(compOp)) {
+        slotNo = current->slotNo - 1;
+
+        if (slotNo < 0) {
+            leaf.pageNo = apage->hdr.prevPage;
+
+            e = BfM_FreeTrain(&current->leaf, PAGE_BUF);
+            if(e<0)ERR(e);
+
+            if (leaf.pageNo == NIL) {
                 next->flag = CURSOR_EOS;
-                e = BfM_FreeTrain(&leaf, PAGE_BUF);
-                if(e<0)ERR(e);
                 return(eNOERROR);
             }
-            leaf.pageNo = apage->hdr.nextPage;
-            e = BfM_FreeTrain(&current->leaf, PAGE_BUF);
-            if(e<0)ERR(e);
-            e = BfM_GetTrain(&leaf, &apage, PAGE_BUF);
+
+            e = BfM_GetTrain(&leaf, (char**)&apage, PAGE_BUF);
             if(e<0)ERR(e);
-            next->slotNo = 0;
+
+            slotNo = apage->hdr.nSlots - 1;
         }
-        else next->slotNo = next->slotNo + 1;
     }
-    else if(compOp == SM_GE || compOp == SM_GT){
-        if (current->slotNo == 0) {
-            if (apage->hdr.prevPage == NIL) {
+    else {
+        slotNo = current->slotNo + 1;
+
+        if (slotNo >= apage->hdr.nSlots) {
+            leaf.pageNo = apage->hdr.nextPage;
+
+            e = BfM_FreeTrain(&current->leaf, PAGE_BUF);
+            if(e<0)ERR(e);
+
+            if (leaf.pageNo == NIL) {
                 next->flag = CURSOR_EOS;
-                e = BfM_FreeTrain(&leaf, PAGE_BUF);
-                if(e<0)ERR(e);
                 return(eNOERROR);
             }
-            leaf.pageNo = apage->hdr.prevPage;
-            e = BfM_FreeTrain(&current->leaf, PAGE_BUF);
-            if(e<0)ERR(e);
-            e = BfM_GetTrain(&leaf, &apage, PAGE_BUF);
+
+            e = BfM_GetTrain(&leaf, (char**)&apage, PAGE_BUF);
             if(e<0)ERR(e);
-            next->slotNo = apage->hdr.nSlots - 1;
+
+            slotNo = 0;
         }
-        else next->slotNo = next->slotNo - 1;
-    }
-
-    entry = (btm_LeafEntry*)&apage->data[apage->slot[-next->slotNo]];
-    alignedKlen = ALIGNED_LENGTH(entry->klen);
-    oidArray = &entry->kval[alignedKlen];
-
-    //SETUP CURSOR 
-    next->flag = CURSOR_ON;
-    next->key.len = entry->klen;
-    memcpy(next->key.val, entry->kval, entry->klen);
-    next->oid = *oidArray;
-    next->leaf = leaf;
-    //END SETUP CURSOR
-
-    cmp = edubtm_KeyCompare(kdesc, &next->key, kval);
-    if(cmp == GREATER) {
-        if(compOp == SM_GE || compOp == SM_GT)next->flag = CURSOR_ON;
-        else next->flag = CURSOR_EOS;
-    } 
-    else if (cmp == EQUAL) {
-        if(compOp == SM_GE || compOp == SM_LE || compOp == SM_EQ)next->flag = CURSOR_ON;
-        else next->flag = CURSOR_EOS;
-    } 
-    else if(cmp == LESS){
-        if(compOp == SM_LE || compOp == SM_LT)next->flag = CURSOR_ON;
-        else next->flag = CURSOR_EOS;
-    }    
+    }
+
+    e = edubtm_SetCursorObject(apage, &leaf, slotNo, BTM_SCAN_BACKWARD(compOp), next);
+    if(e<0)ERRB1(e, &leaf, PAGE_BUF);
+
+    /* Check the stop condition; all ObjectIDs of a key are in one entry, so an SM_EQ scan ends here */
+    if (compOp != SM_EOF && compOp != SM_BOF) {
+        cmp = BTM_KEYCOMPARE(handle, &next->key, kval);
+
+        if ((compOp == SM_EQ) ||
+            (compOp == SM_LT && cmp != LESS) ||
+            (compOp == SM_LE && cmp == GREAT) ||
+            (compOp == SM_GT && cmp != GREAT) ||
+            (compOp == SM_GE && cmp == LESS))
+            next->flag = CURSOR_EOS;
+    }
+
     e = BfM_FreeTrain(&leaf, PAGE_BUF);
     if(e<0)ERR(e);
+
     return(eNOERROR);
     
 } /* edubtm_FetchNext() */
+
+
+
+/*@================================
+ * EduBtM_FetchNextBatch()
+ *================================*/
+/*
+ * Function: Four EduBtM_FetchNextBatch(BtreeHandle*, KeyValue*, Four, BtreeCursor*,
+ *                                     Four, BtreeFetchResult*, Four*, BtreeCursor*)
+ *
+ * Description:
+ *  Fetch up to 'maxResults' ObjectIDs following 'current' which satisfy the
+ *  stop condition, stopping at the end of the leaf holding the first of them.
+ *  The leaf is fixed only once for the whole batch.
+ *
+ *  'next' points to the last returned ObjectID. Its flag is CURSOR_EOS if no
+ *  ObjectID satisfying the condition follows the batch; the batch itself may
+ *  still hold results in that case.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eBADCURSOR
+ *    some errors caused by function calls
+ */
+Four EduBtM_FetchNextBatch(
+    BtreeHandle                 *handle,        /* IN opened index */
+    KeyValue                    *kval,          /* IN key value of stop condition */
+    Four                        compOp,         /* IN comparison operator of stop condition */
+    BtreeCursor                 *current,       /* IN current B+ tree cursor */
+    Four                        maxResults,     /* IN max # of results */
+    BtreeFetchResult            *results,       /* OUT ObjectIDs and keys found */
+    Four                        *nResults,      /* OUT # of results */
+    BtreeCursor                 *next)          /* OUT cursor on the last result */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of a result */
+    KeyValue                    nkval;          /* normalized key value of stop condition */
+    BtreeCursor                 tCursor;        /* 'current' with its key normalized */
+
+
+    /*@ check parameter */
+    if (handle == NULL || kval == NULL || current == NULL ||
+        results == NULL || nResults == NULL || next == NULL || maxResults <= 0)
+        ERR(eBADPARAMETER_BTM);
+
+    /* Is the current cursor valid? */
+    if (current->flag != CURSOR_ON && current->flag != CURSOR_EOS)
+        ERR(eBADCURSOR);
+
+    *nResults = 0;
+
+    if (current->flag == CURSOR_EOS) {
+        next->flag = CURSOR_EOS;
+        return(eNOERROR);
+    }
+
+    /* the tree holds keys of several parts normalized */
+    if (BTM_NORMALIZED(handle)) {
+        if (compOp != SM_BOF && compOp != SM_EOF) {
+            e = edubtm_NormalizeKey(&handle->kdesc, kval, &nkval);
+            if (e < 0) ERR(e);
+            kval = &nkval;
+        }
+
+        tCursor = *current;
+        e = edubtm_NormalizeKey(&handle->kdesc, &current->key, &tCursor.key);
+        if (e < 0) ERR(e);
+        current = &tCursor;
+    }
+
+    e = edubtm_FetchNextBatch(handle, kval, compOp, current, maxResults, results, nResults, next);
+    if (e < 0) ERR(e);
+
+    if (BTM_NORMALIZED(handle)) {
+        for (i = 0; i < *nResults; i++)
+            edubtm_DenormalizeKey(&handle->kdesc, &results[i].key, &results[i].key);
+
+        if (*nResults > 0)
+            edubtm_DenormalizeKey(&handle->kdesc, &next->key, &next->key);
+    }
+
+    return(eNOERROR);
+
+} /* EduBtM_FetchNextBatch() */
+
+
+
+/*@================================
+ * edubtm_FetchNextBatch()
+ *================================*/
+/*
+ * Function: Four edubtm_FetchNextBatch(BtreeHandle*, KeyValue*, Four, BtreeCursor*,
+ *                                     Four, BtreeFetchResult*, Four*, BtreeCursor*)
+ *
+ * Description:
+ *  Get the next items of a leaf. The scan direction is the same as in
+ *  edubtm_FetchNext(). The rest of the ObjectIDs of the current entry come
+ *  first. Since the keys of a leaf are sorted, the following entries all
+ *  satisfy the stop condition if the last of them does; otherwise the first
+ *  entry violating it is found by a binary search. Each entry gives all of
+ *  its ObjectIDs in turn.
+ *
+ * Returns:
+ *  Error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FetchNextBatch(
+    BtreeHandle         *handle,        /* IN opened index */
+    KeyValue            *kval,          /* IN key value of stop condition */
+    Four                compOp,         /* IN comparison operator of stop condition */
+    BtreeCursor         *current,       /* IN current cursor */
+    Four                maxResults,     /* IN max # of results */
+    BtreeFetchResult    *results,       /* OUT ObjectIDs and keys found */
+    Four                *nResults,      /* OUT # of results */
+    BtreeCursor         *next)          /* OUT cursor on the last result */
+{
+    Four                e;              /* error number */
+    Four                n;              /* # of results */
+    Four                m;              /* # of entries to be returned */
+    Four                lo, hi, mid;    /* bounds for the binary search */
+    Four                j;              /* index of an entry */
+    Two                 step;           /* +1 for a forward scan, -1 for a backward scan */
+    Two                 slotNo;         /* slot no. of the first entry */
+    Boolean             backward;       /* TRUE for a backward scan */
+    Boolean             found;          /* whether an entry has a next ObjectID */
+    Boolean             eos;            /* the stop condition is met inside the batch */
+    PageID              leaf;           /* PageID of the leaf holding the batch */
+    BtreeLeaf           *apage;         /* pointer to a buffer holding the leaf */
+    BtreeCursor         cur;            /* cursor on the last result */
+    BtreeCursor         tCursor;        /* cursor on the ObjectID following 'cur' */
+
+
+    *nResults = 0;
+    n = 0;
+    cur = *current;
+
+    leaf = current->leaf;
+    e = BfM_GetTrain(&leaf, (char**)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    /* GT, GE and BOF stop conditions scan backward; the others scan forward */
+    backward = BTM_SCAN_BACKWARD(compOp);
+    step = backward ? -1 : 1;
+
+    /*@ the rest of the ObjectIDs of the current entry */
+    while (n < maxResults) {
+        e = edubtm_NextObjectOfEntry(apage, &cur, backward, &tCursor, &found);
+        if (e < 0) ERRB1(e, &leaf, PAGE_BUF);
+        if (!found) break;
+
+        cur = tCursor;
+        results[n].oid = cur.oid;
+        results[n].key = cur.key;
+        n++;
+    }
+
+    slotNo = current->slotNo + step;
+
+    /* the batch does not go on to the neighbour leaf */
+    if (n > 0 && (n == maxResults || slotNo < 0 || slotNo >= apage->hdr.nSlots)) {
+        *nResults = n;
+        *next = cur;
+
+        e = BfM_FreeTrain(&leaf, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (backward) {
+        if (slotNo < 0) {
+            leaf.pageNo = apage->hdr.prevPage;
+
+            e = BfM_FreeTrain(&current->leaf, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            if (leaf.pageNo == NIL) {
+                next->flag = CURSOR_EOS;
+                return(eNOERROR);
+            }
+
+            e = BfM_GetTrain(&leaf, (char**)&apage, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            slotNo = apage->hdr.nSlots - 1;
+        }
+        m = MIN(maxResults - n, slotNo + 1);
+    }
+    else {
+        if (slotNo >= apage->hdr.nSlots) {
+            leaf.pageNo = apage->hdr.nextPage;
+
+            e = BfM_FreeTrain(&current->leaf, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            if (leaf.pageNo == NIL) {
+                next->flag = CURSOR_EOS;
+                return(eNOERROR);
+            }
+
+            e = BfM_GetTrain(&leaf, (char**)&apage, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            slotNo = 0;
+        }
+        m = MIN(maxResults - n, apage->hdr.nSlots - slotNo);
+    }
+
+    /* Check the stop condition for the whole batch */
+    eos = FALSE;
+    if (edubtm_StopConditionMet(handle, kval, compOp, apage, slotNo + step * (m - 1))) {
+        lo = 0;
+        hi = m - 1;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            if (edubtm_StopConditionMet(handle, kval, compOp, apage, slotNo + step * mid))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        m = lo;
+        eos = TRUE;
+    }
+
+    /*@ every entry gives its ObjectIDs until the batch is full */
+    found = FALSE;
+    for (j = 0; j < m && n < maxResults; j++) {
+        e = edubtm_SetCursorObject(apage, &leaf, slotNo + step * j, backward, &cur);
+        if (e < 0) ERRB1(e, &leaf, PAGE_BUF);
+
+        for (found = TRUE; found && n < maxResults; ) {
+            results[n].oid = cur.oid;
+            results[n].key = cur.key;
+            n++;
+
+            /* 'found' stays TRUE if the batch is filled up before the end of the entry */
+            e = edubtm_NextObjectOfEntry(apage, &cur, backward, &tCursor, &found);
+            if (e < 0) ERRB1(e, &leaf, PAGE_BUF);
+            if (found && n < maxResults) cur = tCursor;
+        }
+    }
+    *nResults = n;
+
+    /* the stop condition ends the scan only after all entries before it are returned */
+    if (j < m || found) eos = FALSE;
+
+    if (n > 0) *next = cur;
+    next->flag = eos ? CURSOR_EOS : CURSOR_ON;
+
+    e = BfM_FreeTrain(&leaf, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_FetchNextBatch() */
+
+
+
+/*@================================
+ * edubtm_StopConditionMet()
+ *================================*/
+/*
+ * Function: Boolean edubtm_StopConditionMet(BtreeHandle*, KeyValue*, Four, BtreeLeaf*, Two)
+ *
+ * Description:
+ *  Check whether the scan stops at the entry in the slot 'slotNo' of
+ *  'apage', in the same way as edubtm_FetchNext() does.
+ *
+ * Returns:
+ *  TRUE if the scan stops, FALSE otherwise
+ */
+Boolean edubtm_StopConditionMet(
+    BtreeHandle         *handle,        /* IN opened index */
+    KeyValue            *kval,          /* IN key value of stop condition */
+    Four                compOp,         /* IN comparison operator of stop condition */
+    BtreeLeaf           *apage,         /* IN leaf page */
+    Two                 slotNo)         /* IN slot No. of the entry */
+{
+    Four                cmp;            /* comparison result */
+    btm_LeafEntry       *entry;         /* a plain leaf entry */
+    KeyValue            key;            /* key of a prefix compressed or dense entry */
+
+
+    if (compOp == SM_EOF || compOp == SM_BOF) return(FALSE);
+
+    /* all ObjectIDs of a key are in one entry, so an SM_EQ scan has no next entry */
+    if (compOp == SM_EQ) return(TRUE);
+
+    /* 'klen' and 'kval' of a plain leaf entry are laid out as a KeyValue */
+    if (apage->hdr.prefixLen == NIL && apage->hdr.denseKeyLen == 0) {
+        entry = (btm_LeafEntry*)&apage->data[BL_SLOT(apage, slotNo)];
+        cmp = BTM_KEYCOMPARE(handle, (KeyValue*)&entry->klen, kval);
+    }
+    else {
+        edubtm_GetLeafObject(apage, slotNo, &key, NULL);
+        cmp = BTM_KEYCOMPARE(handle, &key, kval);
+    }
+
+    return((compOp == SM_LT && cmp != LESS) ||
+           (compOp == SM_LE && cmp == GREAT) ||
+           (compOp == SM_GT && cmp != GREAT) ||
+           (compOp == SM_GE && cmp == LESS));
+
+} /* edubtm_StopConditionMet() */
@@ -0,0 +1,172 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_GetStatistics.c
+ *
+ * Description :
+ *  Walk a B+ tree index and report its height, the number of pages on each
+ *  level kind and how full those pages are (fill factor), along with the
+ *  leaf splits and merges logged by the opened index (see edubtm_Churn.c)
+ *  and the use of its pinned pages (see edubtm_Pin.c).
+ *
+ * Exports:
+ *  Four EduBtM_GetStatistics(BtreeHandle*, BtreeStatistics*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_GetStatistics(PageID*, Four, BtreeStatistics*);
+
+
+
+/*@================================
+ * EduBtM_GetStatistics()
+ *================================*/
+/*
+ * Function: Four EduBtM_GetStatistics(BtreeHandle*, BtreeStatistics*)
+ *
+ * Description:
+ *  Collect the statistics of the B+ tree opened as 'handle'.
+ *  The fill factor of a level kind is the space used by entries and slots
+ *  over the data area of all pages of that kind.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_GetStatistics(
+    BtreeHandle         *handle,        /* IN opened index */
+    BtreeStatistics     *stat)          /* OUT statistics of the B+ tree */
+{
+    Four                e;              /* error number */
+
+
+    if (handle == NULL || stat == NULL) ERR(eBADPARAMETER_BTM);
+
+    memset(stat, 0, sizeof(BtreeStatistics));
+
+    e = edubtm_GetStatistics(&handle->root, 1, stat);
+    if (e < 0) ERR(e);
+
+    if (stat->nInternalPages > 0)
+        stat->internalFillFactor = 100.0 * stat->internalUsed / ((Eight)stat->nInternalPages * (PAGESIZE - BI_FIXED));
+    if (stat->nLeafPages > 0)
+        stat->leafFillFactor = 100.0 * stat->leafUsed / ((Eight)stat->nLeafPages * (PAGESIZE - BL_FIXED));
+
+    stat->nLeafSplits = handle->churn.nSplits;
+    stat->nLeafMerges = handle->churn.nMerges;
+    stat->nSplitsAfterMerge = handle->churn.nSplitsAfterMerge;
+    stat->nMergesAfterSplit = handle->churn.nMergesAfterSplit;
+
+    stat->nPinnedPages = handle->pin.nPages;
+    memcpy(stat->nAccesses, handle->pin.nAccesses, sizeof(stat->nAccesses));
+    memcpy(stat->nPinHits, handle->pin.nHits, sizeof(stat->nPinHits));
+
+    stat->nHotKeys = handle->hot.nEntries;
+    stat->nHotKeyHits = handle->hot.nHits;
+    stat->nHotKeyMisses = handle->hot.nMisses;
+
+    stat->nBloomCounters = handle->bloom.nCounters;
+    stat->nBloomNegatives = handle->bloom.nNegatives;
+    stat->nBloomFalsePositives = handle->bloom.nFalsePositives;
+
+    stat->nLeafHints = handle->leafHash.nEntries;
+    stat->nLeafHintHits = handle->leafHash.nHits;
+    stat->nLeafHintMisses = handle->leafHash.nMisses;
+
+    return(eNOERROR);
+
+} /* EduBtM_GetStatistics() */
+
+
+
+/*@================================
+ * edubtm_GetStatistics()
+ *================================*/
+/*
+ * Function: Four edubtm_GetStatistics(PageID*, Four, BtreeStatistics*)
+ *
+ * Description:
+ *  Add the page 'pid' on level 'level' (the root is on level 1) and its
+ *  subtree to 'stat'.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_GetStatistics(
+    PageID              *pid,           /* IN page to be visited */
+    Four                level,          /* IN level of the page */
+    BtreeStatistics     *stat)          /* INOUT statistics of the B+ tree */
+{
+    Four                e;              /* error number */
+    Two                 i;              /* slot No. */
+    BtreePage           *apage;         /* the visited page */
+    btm_InternalEntry   *iEntry;        /* an internal entry */
+    PageID              childPid;       /* a child page */
+
+
+    e = BfM_GetTrain(pid, (char**)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (apage->any.hdr.type & INTERNAL) {
+        stat->nInternalPages++;
+        stat->internalUsed += apage->bi.hdr.free - apage->bi.hdr.unused + apage->bi.hdr.nSlots * sizeof(Two);
+
+        MAKE_PAGEID(childPid, pid->volNo, apage->bi.hdr.p0);
+        e = edubtm_GetStatistics(&childPid, level + 1, stat);
+        if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+        for (i = 0; i < apage->bi.hdr.nSlots; i++) {
+            iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-i]];
+            MAKE_PAGEID(childPid, pid->volNo, iEntry->spid);
+
+            e = edubtm_GetStatistics(&childPid, level + 1, stat);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
+        }
+    }
+    else if (apage->any.hdr.type & LEAF) {
+        stat->nLeafPages++;
+        stat->nEntries += apage->bl.hdr.nSlots;
+        stat->leafUsed += apage->bl.hdr.free - apage->bl.hdr.unused + apage->bl.hdr.nSlots * BL_SLOTSIZE(&apage->bl);
+        if (level > stat->height) stat->height = level;
+    }
+    else
+        ERRB1(eBADBTREEPAGE_BTM, pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_GetStatistics() */
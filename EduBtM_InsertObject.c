@@ -27,24 +27,36 @@
  *
  * Description :
  *  Insert an ObjectID 'oid' into a Btree whose key value is 'kval'. 
+ *  EduBtM_InsertObjects() inserts a batch of them at once, and
+ *  EduBtM_UpsertObject() re-points a key which is already in the Btree.
  *
  * Exports:
- *  Four EduBtM_InsertObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ *  Four EduBtM_InsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ *  Four EduBtM_InsertObjects(BtreeHandle*, KeyValue*, ObjectID*, Four, Pool*, DeallocListElem*)
+ *  Four EduBtM_UpsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
  */
 
 
+#include <stdlib.h>
+#include <string.h>
 #include "EduBtM_common.h"
 #include "BfM.h"
 #include "EduBtM_Internal.h"
 #include "OM_Internal.h"
 
 
+/*@ Internal Function Prototypes */
+Four edubtm_InsertIntoIndex(BtreeHandle*, KeyValue*, ObjectID*, Boolean, Pool*, DeallocListElem*);
+Four edubtm_InsertRuns(BtreeHandle*, KeyValue*, ObjectID*, Four, Two*, KeyValue*);
+void edubtm_SortBatch(BtreeHandle*, KeyValue*, Two*, Two*, Two);
+
+
 
 /*@================================
  * EduBtM_InsertObject() 
  *================================*/
 /*
- * Function: Four EduBtM_InsertObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ * Function: Four EduBtM_InsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
  * 
  * Description :
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -60,49 +72,329 @@
  *    some errors caused by function calls
  */
 Four EduBtM_InsertObject(
-    ObjectID *catObjForFile,	/* IN catalog object of B+ tree file */
-    PageID   *root,		/* IN the root of Btree */
-    KeyDesc  *kdesc,		/* IN key descriptor */
+    BtreeHandle *handle,	/* IN opened index */
     KeyValue *kval,		/* IN key value */
     ObjectID *oid,		/* IN ObjectID which will be inserted */
     Pool     *dlPool,		/* INOUT pool of dealloc list */
     DeallocListElem *dlHead) /* INOUT head of the dealloc list */
 {
-    int i;
     Four e;			/* error number */
-    Boolean lh;			/* for spliting */
-    Boolean lf;			/* for merging */
-    InternalItem item;		/* Internal Item */
-    SlottedPage *catPage;	/* buffer page containing the catalog object */
-    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
-    PhysicalFileID pFid;	 /* B+-tree file's FileID */
+    KeyValue nkval;		/* normalized key value */
 
     
     /*@ check parameters */
     
-    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
-    
-    if (root == NULL) ERR(eBADPARAMETER_BTM);
-
-    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
 
     if (kval == NULL) ERR(eBADPARAMETER_BTM);
 
     if (oid == NULL) ERR(eBADPARAMETER_BTM);    
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+    if (BTM_NORMALIZED(handle)) {
+        e = edubtm_NormalizeKey(&handle->kdesc, kval, &nkval);
+        if (e < 0) ERR(e);
+        kval = &nkval;
+    }
+
+    e = edubtm_InsertIntoIndex(handle, kval, oid, FALSE, dlPool, dlHead);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+    
+}   /* EduBtM_InsertObject() */
+
+
+
+/*@================================
+ * EduBtM_InsertObjects()
+ *================================*/
+/*
+ * Function: Four EduBtM_InsertObjects(BtreeHandle*, KeyValue*, ObjectID*, Four,
+ *                                    Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Insert the 'n' objects <keys[i], oids[i]> into a Btree. The objects are
+ *  sorted by their keys and inserted by edubtm_InsertBatch(), which descends
+ *  once for all objects going to the same leaf instead of once per object.
+ *  A batch longer than BTM_INSERTBATCH is inserted in runs of that size.
+ *  The order of a run and its normalized keys are kept in memory allocated
+ *  for the call.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eMEMORYALLOCERR
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  On an error the objects of the run which precede the failing one in key
+ *  order, and all objects of the earlier runs, have been inserted.
+ */
+Four EduBtM_InsertObjects(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *keys,		/* IN key values */
+    ObjectID *oids,		/* IN ObjectIDs which will be inserted */
+    Four     n,			/* IN # of objects */
+    Pool     *dlPool,		/* INOUT pool of dealloc list */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    Four e;			/* error number */
+    Two *order;			/* indexes of the objects of a run in key order, and room for sorting them */
+    KeyValue *nkeys;		/* normalized key values of a run */
+
+
+    /*@ check parameters */
+    if (handle == NULL || keys == NULL || oids == NULL || n < 0) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (n == 0) return(eNOERROR);
+
+    order = (Two*)malloc(2 * BTM_INSERTBATCH * sizeof(Two));
+    if (order == NULL) ERR(eMEMORYALLOCERR);
+
+    nkeys = NULL;
+    if (BTM_NORMALIZED(handle)) {
+        nkeys = (KeyValue*)malloc(MIN(n, BTM_INSERTBATCH) * sizeof(KeyValue));
+        if (nkeys == NULL) {
+            free(order);
+            ERR(eMEMORYALLOCERR);
+        }
+    }
+
+    e = edubtm_InsertRuns(handle, keys, oids, n, order, nkeys);
+
+    free(order);
+    free(nkeys);
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* EduBtM_InsertObjects() */
+
+
+
+/*@================================
+ * edubtm_InsertRuns()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertRuns(BtreeHandle*, KeyValue*, ObjectID*, Four, Two*, KeyValue*)
+ *
+ * Description:
+ *  Insert the 'n' objects <keys[i], oids[i]> run by run for
+ *  EduBtM_InsertObjects(). 'order' has room for 2*BTM_INSERTBATCH indexes;
+ *  'nkeys' has room for the normalized keys of a run if the keys of the
+ *  index are normalized, otherwise it is not used.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_InsertRuns(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *keys,		/* IN key values */
+    ObjectID *oids,		/* IN ObjectIDs which will be inserted */
+    Four     n,			/* IN # of objects */
+    Two      *order,		/* OUT indexes of the objects of a run in key order */
+    KeyValue *nkeys)		/* OUT normalized key values of a run */
+{
+    Four e;			/* error number */
+    Four i;			/* index of the first object of a run */
+    Two j;			/* index of an object in a run */
+    Two m;			/* # of objects in a run */
+    Two done;			/* # of objects of a run inserted */
+    Two nDone;			/* # of objects inserted by one descent */
+    Boolean lh;			/* for spliting */
+    InternalItem item;		/* Internal Item */
+    KeyValue *runKeys;		/* key values of a run */
+
+
+    for (i = 0; i < n; i += m) {
+        m = MIN(n - i, BTM_INSERTBATCH);
+
+        runKeys = &keys[i];
+        if (BTM_NORMALIZED(handle)) {
+            for (j = 0; j < m; j++) {
+                e = edubtm_NormalizeKey(&handle->kdesc, &keys[i + j], &nkeys[j]);
+                if (e < 0) ERR(e);
+            }
+            runKeys = nkeys;
+        }
+
+        edubtm_SortBatch(handle, runKeys, order, &order[BTM_INSERTBATCH], m);
+
+        /* each descent inserts the objects going to one leaf */
+        for (done = 0; done < m; done += nDone) {
+            e = edubtm_InsertBatch(handle, &handle->root, runKeys, &oids[i], &order[done], m - done, &nDone, &lh, &item);
+            if (e < 0) ERR(e);
+
+            if (lh) {
+                e = edubtm_root_insert(&handle->catObjForFile, &handle->root, &item);
+                if (e < 0) ERR(e);
+            }
+        }
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_InsertRuns() */
+
+
+
+/*@================================
+ * EduBtM_UpsertObject()
+ *================================*/
+/*
+ * Function: Four EduBtM_UpsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Make the key 'kval' of a unique index point to the ObjectID 'oid'. If the
+ *  key is in the index its ObjectID is overwritten in place in the leaf
+ *  entry, otherwise the key is inserted. Either way the tree is descended
+ *  once, instead of fetching, deleting and inserting the key, which could
+ *  also merge a leaf and split it again.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_UpsertObject(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *kval,		/* IN key value */
+    ObjectID *oid,		/* IN ObjectID which the key points to */
+    Pool     *dlPool,		/* INOUT pool of dealloc list */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    Four e;			/* error number */
+    KeyValue nkval;		/* normalized key value */
+
+
+    /*@ check parameters */
+    if (handle == NULL || kval == NULL || oid == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* a key of a non-unique index does not tell which ObjectID to replace */
+    if (!(handle->kdesc.flag & KEYFLAG_UNIQUE)) ERR(eBADPARAMETER_BTM);
+
+    if (BTM_NORMALIZED(handle)) {
+        e = edubtm_NormalizeKey(&handle->kdesc, kval, &nkval);
+        if (e < 0) ERR(e);
+        kval = &nkval;
+    }
+
+    e = edubtm_InsertIntoIndex(handle, kval, oid, TRUE, dlPool, dlHead);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* EduBtM_UpsertObject() */
+
+
+
+/*@================================
+ * edubtm_InsertIntoIndex()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertIntoIndex(BtreeHandle*, KeyValue*, ObjectID*, Boolean,
+ *                                      Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Insert the normalized key 'kval' with 'oid' into the leaf of the finger
+ *  if the finger covers the key, otherwise by descending from the root, and
+ *  put a new root over the old one if it is splitted. 'replace' is as for
+ *  edubtm_Insert().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_InsertIntoIndex(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *kval,		/* IN normalized key value */
+    ObjectID *oid,		/* IN ObjectID which will be inserted */
+    Boolean  replace,		/* IN TRUE if an existing key takes 'oid' */
+    Pool     *dlPool,		/* INOUT pool of dealloc list */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    Four e;			/* error number */
+    Boolean lh;			/* for spliting */
+    Boolean lf;			/* for merging */
+    InternalItem item;		/* Internal Item */
+
+
+    /* a key in the range of the finger goes to its leaf directly */
+    if (edubtm_FingerCovers(handle, kval)) {
+        e = edubtm_InsertAtFinger(handle, kval, oid, replace, &lh, &item);
+        if(e<0)ERR(e);
+    }
+    else {
+        edubtm_ResetFinger(handle);
+
+        e = edubtm_Insert(handle, &handle->root, kval, oid, replace, &lf, &lh, &item, dlPool, dlHead);
+        if(e<0)ERR(e);
     }
-    e = edubtm_Insert(catObjForFile, root, kdesc, kval, oid, &lf, &lh, &item, dlPool, dlHead);
-    if(e<0)ERR(e);
 
     if(lh){
-        e = edubtm_root_insert(catObjForFile, root, &item);
+        e = edubtm_root_insert(&handle->catObjForFile, &handle->root, &item);
         if(e<0)ERR( e );
     }
+
     return(eNOERROR);
-    
-}   /* EduBtM_InsertObject() */
+
+}   /* edubtm_InsertIntoIndex() */
+
+
+
+/*@================================
+ * edubtm_SortBatch()
+ *================================*/
+/*
+ * Function: void edubtm_SortBatch(BtreeHandle*, KeyValue*, Two*, Two*, Two)
+ *
+ * Description:
+ *  Fill 'order' with the indexes of the 'n' keys in ascending key order.
+ *  A bottom-up merge sort is used, with 'tmp' of 'n' indexes as the room
+ *  for merging. Two sorted halves already in order are not merged, so the
+ *  common batch whose keys arrive sorted takes linear time.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_SortBatch(
+    BtreeHandle *handle,	/* IN opened index */
+    KeyValue *keys,		/* IN key values */
+    Two *order,			/* OUT indexes of the keys in key order */
+    Two *tmp,			/* OUT room for merging */
+    Two n)			/* IN # of keys */
+{
+    Four width;			/* # of indexes of a sorted half */
+    Four lo;			/* start of the left half */
+    Four mid;			/* start of the right half */
+    Four hi;			/* end of the right half */
+    Four i;			/* index in the left half */
+    Four j;			/* index in the right half */
+    Four k;			/* index in 'tmp' */
+
+
+    for (i = 0; i < n; i++) order[i] = i;
+
+    for (width = 1; width < n; width *= 2) {
+        for (lo = 0; lo + width < n; lo += 2 * width) {
+            mid = lo + width;
+            hi = MIN(lo + 2 * width, n);
+
+            if (BTM_KEYCOMPARE(handle, &keys[order[mid - 1]], &keys[order[mid]]) != GREATER) continue;
+
+            /* equal keys keep their order in the batch */
+            for (i = lo, j = mid, k = lo; k < hi; k++) {
+                if (j >= hi || (i < mid && BTM_KEYCOMPARE(handle, &keys[order[i]], &keys[order[j]]) != GREATER))
+                    tmp[k] = order[i++];
+                else
+                    tmp[k] = order[j++];
+            }
+            memcpy(&order[lo], &tmp[lo], (hi - lo) * sizeof(Two));
+        }
+    }
+
+}   /* edubtm_SortBatch() */
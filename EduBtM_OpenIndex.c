@@ -0,0 +1,461 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_OpenIndex.c
+ *
+ * Description :
+ *  Open and close a B+ tree index. Opening an index validates its key
+ *  descriptor and selects the comparator for its key layout; all other
+ *  operations on the index take the resulting handle.
+ *
+ * Exports:
+ *  Four EduBtM_OpenIndex(ObjectID*, PageID*, KeyDesc*, BtreeHandle*)
+ *  Four EduBtM_CloseIndex(BtreeHandle*)
+ *  Four EduBtM_SetWaterMarks(BtreeHandle*, Four, Four)
+ *  Four EduBtM_PinUpperLevels(BtreeHandle*, Four, Four)
+ *  Four EduBtM_CacheHotKeys(BtreeHandle*, Four)
+ *  Four EduBtM_BuildBloomFilter(BtreeHandle*, Four)
+ *  Four EduBtM_HashHotLeaves(BtreeHandle*, Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_OpenIndex()
+ *================================*/
+/*
+ * Function: Four EduBtM_OpenIndex(ObjectID*, PageID*, KeyDesc*, BtreeHandle*)
+ *
+ * Description:
+ *  Open the B+ tree index whose root page is 'root' and whose keys are
+ *  described by 'kdesc'. A key of several parts is given as its parts one
+ *  after another and kept normalized in the tree (see edubtm_Normalize.c).
+ *  The leaves take the default water marks, BTM_LOW_WATERMARK and
+ *  BTM_HIGH_WATERMARK, no page is pinned, no hot key is kept and there is no
+ *  Bloom filter.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTSUPPORTED_EDUBTM
+ *
+ * Side effects:
+ *  'handle' is filled with the opened index.
+ */
+Four EduBtM_OpenIndex(
+    ObjectID            *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID              *root,          /* IN root page of the B+ tree */
+    KeyDesc             *kdesc,         /* IN key descriptor */
+    BtreeHandle         *handle)        /* OUT the opened index */
+{
+    int                 i;
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc->nparts < 1 || kdesc->nparts > MAXNUMKEYPARTS) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    if (kdesc->flag & ~(KEYFLAG_UNIQUE | KEYFLAG_PREFIX | KEYFLAG_KEYHEAD | KEYFLAG_DENSE))
+        ERR(eNOTSUPPORTED_EDUBTM);
+
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_LONG_LONG && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* leaf pages are prefix compressed only for a key made of one string */
+    if ((kdesc->flag & KEYFLAG_PREFIX) && (kdesc->nparts != 1 || kdesc->kpart[0].type != SM_VARSTRING))
+        ERR(eNOTSUPPORTED_EDUBTM);
+
+    /* dense leaf pages have no slots, so they keep no key heads either, and one ObjectID per key */
+    if ((kdesc->flag & KEYFLAG_DENSE) &&
+        (kdesc->nparts != 1 || kdesc->kpart[0].type == SM_VARSTRING || (kdesc->flag & KEYFLAG_KEYHEAD) ||
+         !(kdesc->flag & KEYFLAG_UNIQUE)))
+        ERR(eNOTSUPPORTED_EDUBTM);
+
+    /*@ select the comparator; normalized keys of several parts are compared by memcmp() */
+    if (kdesc->nparts > 1)
+        handle->keyCompare = edubtm_NormalizedKeyCompare;
+    else if (kdesc->kpart[0].type == SM_INT)
+        handle->keyCompare = edubtm_IntKeyCompare;
+    else if (kdesc->kpart[0].type == SM_LONG_LONG)
+        handle->keyCompare = edubtm_LongLongKeyCompare;
+    else
+        handle->keyCompare = edubtm_VarStringKeyCompare;
+
+    handle->catObjForFile = *catObjForFile;
+    handle->root = *root;
+    handle->kdesc = *kdesc;
+    edubtm_ResetFinger(handle);
+
+    handle->leafLowWater = (PAGESIZE - BL_FIXED) * BTM_LOW_WATERMARK / 100;
+    handle->leafHighWater = (PAGESIZE - BL_FIXED) * BTM_HIGH_WATERMARK / 100;
+    edubtm_ResetChurn(handle);
+
+    memset(&handle->pin, 0, sizeof(BtreePinCache));
+
+    /* the entries are not used until EduBtM_CacheHotKeys() */
+    handle->hot.nEntries = 0;
+    handle->hot.nHits = handle->hot.nMisses = 0;
+    handle->hot.entry = NULL;
+    memset(handle->hot.version, 0, sizeof(handle->hot.version));
+
+    /* nor is the Bloom filter until EduBtM_BuildBloomFilter() */
+    handle->bloom.nCounters = 0;
+    handle->bloom.nNegatives = handle->bloom.nFalsePositives = 0;
+    handle->bloom.counter = NULL;
+
+    /* nor are the keys mapped to hot leaves until EduBtM_HashHotLeaves() */
+    handle->leafHash.nEntries = 0;
+    handle->leafHash.nHits = handle->leafHash.nMisses = 0;
+    handle->leafHash.entry = NULL;
+    memset(handle->leafHash.shape, 0, sizeof(handle->leafHash.shape));
+    memset(handle->leafHash.heat, 0, sizeof(handle->leafHash.heat));
+
+    /* nor is the room for moving leaf entries until leaves are redistributed or merged */
+    handle->scratch = NULL;
+
+    return(eNOERROR);
+
+} /* EduBtM_OpenIndex() */
+
+
+
+/*@================================
+ * EduBtM_CloseIndex()
+ *================================*/
+/*
+ * Function: Four EduBtM_CloseIndex(BtreeHandle*)
+ *
+ * Description:
+ *  Close an index opened by EduBtM_OpenIndex(). Its pinned pages, its hot
+ *  keys, its Bloom filter and its keys mapped to hot leaves are freed, and
+ *  the handle may not be used afterwards.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_CloseIndex(
+    BtreeHandle         *handle)        /* INOUT the opened index */
+{
+    Four                e;              /* error number */
+
+
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    e = edubtm_UnpinAll(handle);
+    handle->pin.levels = 0;
+
+    /* the memory of the handle is freed even if its pages could not be unpinned */
+    handle->keyCompare = NULL;
+    BTM_INVALIDATE_FINGER(handle);
+    handle->hot.nEntries = 0;
+    free(handle->hot.entry);
+    handle->hot.entry = NULL;
+    handle->bloom.nCounters = 0;
+    free(handle->bloom.counter);
+    handle->bloom.counter = NULL;
+    handle->leafHash.nEntries = 0;
+    free(handle->leafHash.entry);
+    handle->leafHash.entry = NULL;
+    free(handle->scratch);
+    handle->scratch = NULL;
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBtM_CloseIndex() */
+
+
+
+/*@================================
+ * EduBtM_SetWaterMarks()
+ *================================*/
+/*
+ * Function: Four EduBtM_SetWaterMarks(BtreeHandle*, Four, Four)
+ *
+ * Description:
+ *  Set the water marks of the leaves of an opened index, in percent of the
+ *  data area of a page. A leaf using less than 'lowWater' underflows after
+ *  a deletion; it is merged with its sibling only if the merged page uses at
+ *  most 'highWater', otherwise their entries are redistributed.
+ *
+ *  Each of two redistributed pages then uses more than 'highWater'/2, so
+ *  'lowWater' may be at most half of 'highWater' for a redistributed page
+ *  not to underflow again at once. 50 and 100 merge as soon as a page is
+ *  less than half full.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ */
+Four EduBtM_SetWaterMarks(
+    BtreeHandle         *handle,        /* INOUT the opened index */
+    Four                lowWater,       /* IN low water mark (%) */
+    Four                highWater)      /* IN high water mark (%) */
+{
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (lowWater < 0 || highWater > 100 || 2 * lowWater > highWater) ERR(eBADPARAMETER_BTM);
+
+    handle->leafLowWater = (PAGESIZE - BL_FIXED) * lowWater / 100;
+    handle->leafHighWater = (PAGESIZE - BL_FIXED) * highWater / 100;
+
+    return(eNOERROR);
+
+} /* EduBtM_SetWaterMarks() */
+
+
+
+/*@================================
+ * EduBtM_PinUpperLevels()
+ *================================*/
+/*
+ * Function: Four EduBtM_PinUpperLevels(BtreeHandle*, Four, Four)
+ *
+ * Description:
+ *  Keep the internal pages on the top 'levels' levels of an opened index,
+ *  the root on the first, fixed until the index is closed, using at most
+ *  'budget' bytes of the buffer pool. A descent then reads those pages
+ *  from the handle and fixes only the pages below them (see edubtm_Pin.c).
+ *  The pages are pinned by the descents which reach them first. 0 levels
+ *  unpin all pages.
+ *
+ *  The pinned pages hold buffers of the pool for as long as the index is
+ *  open; at most BTM_MAXPINNED pages are pinned whatever 'budget' is.
+ *  EduBtM_GetStatistics() reports the pages reached on each level and how
+ *  many of them were pinned, counted from this call on.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_PinUpperLevels(
+    BtreeHandle         *handle,        /* INOUT the opened index */
+    Four                levels,         /* IN # of levels pinned from the root */
+    Four                budget)         /* IN the most bytes of the pinned pages */
+{
+    Four                e;              /* error number */
+
+
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (levels < 0 || levels > BTM_MAXLEVEL || budget < 0) ERR(eBADPARAMETER_BTM);
+
+    e = edubtm_UnpinAll(handle);
+    if (e < 0) ERR(e);
+
+    handle->pin.levels = levels;
+    handle->pin.maxPages = MIN(budget / PAGESIZE, BTM_MAXPINNED);
+    memset(handle->pin.nAccesses, 0, sizeof(handle->pin.nAccesses));
+    memset(handle->pin.nHits, 0, sizeof(handle->pin.nHits));
+
+    return(eNOERROR);
+
+} /* EduBtM_PinUpperLevels() */
+
+
+
+/*@================================
+ * EduBtM_CacheHotKeys()
+ *================================*/
+/*
+ * Function: Four EduBtM_CacheHotKeys(BtreeHandle*, Four)
+ *
+ * Description:
+ *  Keep the results of SM_EQ probes of an opened index in at most 'budget'
+ *  bytes of the handle, so that a probe of a kept key is answered without
+ *  any page access (see edubtm_HotKey.c). At most BTM_MAXHOTKEYS keys of at
+ *  most BTM_HOTKEYLEN bytes are kept whatever 'budget' is; 0 keeps none.
+ *  The keys are allocated by this call and freed by EduBtM_CloseIndex() or
+ *  by another call.
+ *
+ *  Changes of the index made through this handle keep the kept results
+ *  valid; changes made through another handle of the same index are not
+ *  seen, so the index should be changed through this handle only.
+ *  EduBtM_GetStatistics() reports the probes answered and not answered by
+ *  the hot keys, counted from this call on.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eMEMORYALLOCERR
+ */
+Four EduBtM_CacheHotKeys(
+    BtreeHandle         *handle,        /* INOUT the opened index */
+    Four                budget)         /* IN the most bytes of the hot keys */
+{
+    Four                nEntries;       /* # of the hot keys */
+
+
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (budget < 0) ERR(eBADPARAMETER_BTM);
+
+    handle->hot.nEntries = 0;
+    handle->hot.nHits = handle->hot.nMisses = 0;
+    free(handle->hot.entry);
+    handle->hot.entry = NULL;
+
+    nEntries = MIN(budget / (Four)sizeof(BtreeHotKey), BTM_MAXHOTKEYS);
+    if (nEntries > 0) {
+        handle->hot.entry = (BtreeHotKey*)malloc(nEntries * sizeof(BtreeHotKey));
+        if (handle->hot.entry == NULL) ERR(eMEMORYALLOCERR);
+        handle->hot.nEntries = nEntries;
+    }
+    edubtm_ClearHotKeys(handle);
+
+    return(eNOERROR);
+
+} /* EduBtM_CacheHotKeys() */
+
+
+
+/*@================================
+ * EduBtM_BuildBloomFilter()
+ *================================*/
+/*
+ * Function: Four EduBtM_BuildBloomFilter(BtreeHandle*, Four)
+ *
+ * Description:
+ *  Build the Bloom filter of an opened index in at most 'budget' bytes of
+ *  the handle by reading all of its leaves, so that SM_EQ probes and
+ *  deletes of keys surely not in the index are answered without any page
+ *  access (see edubtm_Bloom.c). A filter takes two counters a byte, at most
+ *  BTM_MAXBLOOMCOUNTERS whatever 'budget' is; 0 bytes drop the filter.
+ *  The counters are allocated by this call and freed by EduBtM_CloseIndex()
+ *  or by another call.
+ *
+ *  The filter follows the changes of the index made through this handle,
+ *  but keys deleted by EduBtM_DeleteRange() are still counted; building
+ *  the filter again, e.g. when the index is not busy, drops them. Changes
+ *  made through another handle of the same index are not seen, so the
+ *  index should be changed through this handle only.
+ *  EduBtM_GetStatistics() reports the probes and deletes answered by the
+ *  filter and those passed which found nothing, counted from this call on.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eMEMORYALLOCERR
+ *    some errors caused by function calls
+ */
+Four EduBtM_BuildBloomFilter(
+    BtreeHandle         *handle,        /* INOUT the opened index */
+    Four                budget)         /* IN the most bytes of the filter */
+{
+    Four                e;              /* error number */
+    Four                nBytes;         /* # of bytes of the counters */
+
+
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (budget < 0) ERR(eBADPARAMETER_BTM);
+
+    handle->bloom.nCounters = 0;
+    handle->bloom.nNegatives = handle->bloom.nFalsePositives = 0;
+    free(handle->bloom.counter);
+    handle->bloom.counter = NULL;
+
+    nBytes = MIN(budget, BTM_MAXBLOOMCOUNTERS / 2);
+    if (nBytes > 0) {
+        handle->bloom.counter = (UOne*)malloc(nBytes);
+        if (handle->bloom.counter == NULL) ERR(eMEMORYALLOCERR);
+        handle->bloom.nCounters = nBytes * 2;
+
+        e = edubtm_BloomAddLeaves(handle);
+        if (e < 0) {
+            handle->bloom.nCounters = 0;
+            free(handle->bloom.counter);
+            handle->bloom.counter = NULL;
+            ERR(e);
+        }
+    }
+
+    return(eNOERROR);
+
+} /* EduBtM_BuildBloomFilter() */
+
+
+
+/*@================================
+ * EduBtM_HashHotLeaves()
+ *================================*/
+/*
+ * Function: Four EduBtM_HashHotLeaves(BtreeHandle*, Four)
+ *
+ * Description:
+ *  Map the keys found by SM_EQ probes of an opened index to their leaves
+ *  in at most 'budget' bytes of the handle, once a leaf has been reached
+ *  often, so that a probe of a mapped key starts at its leaf instead of
+ *  the root (see edubtm_LeafHash.c). At most BTM_MAXLEAFHINTS keys of at
+ *  most BTM_HOTKEYLEN bytes are mapped whatever 'budget' is; 0 maps none.
+ *  The mapping is allocated when a leaf first gets hot, and freed by
+ *  EduBtM_CloseIndex() or by another call.
+ *
+ *  Changes of the index made through this handle keep the mapping valid;
+ *  changes made through another handle of the same index are not seen,
+ *  so the index should be changed through this handle only.
+ *  EduBtM_GetStatistics() reports the probes which started at the leaf
+ *  and those which found their key not mapped, counted from this call on.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ */
+Four EduBtM_HashHotLeaves(
+    BtreeHandle         *handle,        /* INOUT the opened index */
+    Four                budget)         /* IN the most bytes of the mapping */
+{
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (budget < 0) ERR(eBADPARAMETER_BTM);
+
+    free(handle->leafHash.entry);
+    handle->leafHash.entry = NULL;
+    handle->leafHash.nEntries = MIN(budget / (Four)sizeof(BtreeLeafHint), BTM_MAXLEAFHINTS);
+    handle->leafHash.nHits = handle->leafHash.nMisses = 0;
+
+    return(eNOERROR);
+
+} /* EduBtM_HashHotLeaves() */
@@ -77,7 +77,7 @@ Four main()
 	title = "test";
 	volId = 1000;
 	extSize = 16;
-	numPagesInDevices[0] = 2000;
+	numPagesInDevices[0] = 6000;
 	segmentSize = 16;
 
 	/*
@@ -35,12 +35,28 @@
  * Function Prototypes
  */
 /* Interface Function Prototypes */
+Four EduBtM_BuildBloomFilter(BtreeHandle*, Four);
+Four EduBtM_CacheHotKeys(BtreeHandle*, Four);
+Four EduBtM_CloseIndex(BtreeHandle*);
 Four EduBtM_CreateIndex(ObjectID*, PageID*);
-Four EduBtM_DeleteObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteKey(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteRange(BtreeHandle*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
 Four EduBtM_DropIndex(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
-Four EduBtM_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
-Four EduBtM_FetchNext(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
-Four EduBtM_InsertObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_Fetch(BtreeHandle*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
+Four EduBtM_FetchNext(BtreeHandle*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
+Four EduBtM_FetchNextBatch(BtreeHandle*, KeyValue*, Four, BtreeCursor*, Four, BtreeFetchResult*, Four*, BtreeCursor*);
+Four EduBtM_GetStatistics(BtreeHandle*, BtreeStatistics*);
+Four EduBtM_HashHotLeaves(BtreeHandle*, Four);
+Four EduBtM_InsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_InsertObjects(BtreeHandle*, KeyValue*, ObjectID*, Four, Pool*, DeallocListElem*);
+Four EduBtM_InitBulkLoad(BtreeHandle*, Four, BtreeBulkLoad*);
+Four EduBtM_NextBulkLoad(BtreeBulkLoad*, KeyValue*, ObjectID*);
+Four EduBtM_FinalBulkLoad(BtreeBulkLoad*, Pool*, DeallocListElem*);
+Four EduBtM_OpenIndex(ObjectID*, PageID*, KeyDesc*, BtreeHandle*);
+Four EduBtM_PinUpperLevels(BtreeHandle*, Four, Four);
+Four EduBtM_SetWaterMarks(BtreeHandle*, Four, Four);
+Four EduBtM_UpsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
 
 
 #endif /* _EDUBTM_H_ */
@@ -40,6 +40,99 @@
 #define OBJECTID_SIZE   sizeof(ObjectID)
 
 
+/*
+ * Split policy
+ *  Percentage of a page kept in the old page when a split is caused by
+ *  appending after the last entry of the rightmost page.
+ */
+#define BTM_APPEND_FILLFACTOR   90
+
+
+/*
+ * Merge policy
+ *  A leaf underflows when less than BTM_LOW_WATERMARK percent of its data
+ *  area is used, and two leaves are merged only if the merged page is used
+ *  up to BTM_HIGH_WATERMARK percent; otherwise their entries are
+ *  redistributed. The gap keeps a page from being splitted again by the
+ *  inserts right after it was merged. EduBtM_SetWaterMarks() overrides both
+ *  for an opened index.
+ *  The leaf splits and merges of an opened index are logged; a page
+ *  splitted after it was merged, or merged after it was splitted, within
+ *  the last BTM_CHURN_WINDOW of them is counted as churn.
+ */
+#define BTM_LOW_WATERMARK       25
+#define BTM_HIGH_WATERMARK      75
+#define BTM_CHURN_WINDOW        16
+
+
+/*
+ * Bulk load
+ *  BTM_BULKLOAD_FILLFACTOR is the default percentage of a page filled by
+ *  the bulk loader; BTM_MAXLEVEL bounds the height of the tree it builds
+ *  and of the path kept by the finger of an opened index.
+ */
+#define BTM_BULKLOAD_FILLFACTOR 90
+#define BTM_MAXLEVEL            16
+
+
+/*
+ * Batch insert
+ *  EduBtM_InsertObjects() sorts and inserts a batch in runs of at most
+ *  BTM_INSERTBATCH objects.
+ */
+#define BTM_INSERTBATCH         256
+
+
+/*
+ * Pinned upper levels
+ *  EduBtM_PinUpperLevels() keeps at most BTM_MAXPINNED internal pages of an
+ *  opened index fixed, however large its memory budget is.
+ */
+#define BTM_MAXPINNED           256
+
+
+/*
+ * Hot keys
+ *  EduBtM_CacheHotKeys() keeps the results of at most BTM_MAXHOTKEYS SM_EQ
+ *  probes of keys of at most BTM_HOTKEYLEN bytes. A change of a leaf is
+ *  noted in one of BTM_LEAFVERSIONS counters, chosen by its page number,
+ *  and voids the results taken from the leaves sharing the counter.
+ */
+#define BTM_MAXHOTKEYS          1024
+#define BTM_HOTKEYLEN           64
+#define BTM_LEAFVERSIONS        256
+#define BTM_LEAF_VERSION(handle, pageNo) ((handle)->hot.version[(unsigned)(pageNo) % BTM_LEAFVERSIONS])
+#define BTM_LEAF_CHANGED(handle, pageNo) (BTM_LEAF_VERSION(handle, pageNo)++)
+
+
+/*
+ * Bloom filter
+ *  EduBtM_BuildBloomFilter() counts the keys of an index in at most
+ *  BTM_MAXBLOOMCOUNTERS counters of 4 bits, two to a byte; each key is
+ *  counted in BTM_BLOOMHASHES of them. A counter stuck at BTM_BLOOMCOUNTMAX
+ *  is never decreased.
+ */
+#define BTM_MAXBLOOMCOUNTERS    (1 << 19)
+#define BTM_BLOOMHASHES         4
+#define BTM_BLOOMCOUNTMAX       15
+
+
+/*
+ * Hashed hot leaves
+ *  EduBtM_HashHotLeaves() maps at most BTM_MAXLEAFHINTS keys of at most
+ *  BTM_HOTKEYLEN bytes to their leaves, once the leaf of a key has been
+ *  reached by BTM_HOTLEAF SM_EQ descents. A split, merge or redistribution
+ *  of a leaf moves its entries; it is noted by BTM_LEAF_MOVED() in one of
+ *  BTM_LEAFVERSIONS counters and voids the keys mapped to the leaves
+ *  sharing the counter.
+ */
+#define BTM_MAXLEAFHINTS        1024
+#define BTM_HOTLEAF             8
+#define BTM_LEAF_SHAPE(handle, pageNo) ((handle)->leafHash.shape[(unsigned)(pageNo) % BTM_LEAFVERSIONS])
+#define BTM_LEAF_HEAT(handle, pageNo) ((handle)->leafHash.heat[(unsigned)(pageNo) % BTM_LEAFVERSIONS])
+#define BTM_LEAF_MOVED(handle, pageNo) (BTM_LEAF_CHANGED(handle, pageNo), BTM_LEAF_SHAPE(handle, pageNo)++)
+
+
 /*
  * Comparison result
  */
@@ -116,6 +209,9 @@ typedef struct {   /* Internal (Nonleaf) Page */
  */
 #define BI_CFREE(p)   (PAGESIZE - BI_FIXED - (p)->hdr.free - ((p)->hdr.nSlots-1)*((CONSTANT_CASTING_TYPE)sizeof(Two)))
 #define BI_HALF       ((CONSTANT_CASTING_TYPE)((PAGESIZE-BI_FIXED)/2))
+#define BI_APPEND_FILL ((CONSTANT_CASTING_TYPE)((PAGESIZE-BI_FIXED)*BTM_APPEND_FILLFACTOR/100))
+#define BI_MAXENTRIES ((CONSTANT_CASTING_TYPE)((PAGESIZE-BI_FIXED)/(sizeof(ShortPageID)+ALIGNED_LENGTH(sizeof(Two))+sizeof(Two))))
+#define BI_MAXENTRYSPACE ((CONSTANT_CASTING_TYPE)(sizeof(ShortPageID)+ALIGNED_LENGTH(sizeof(Two)+MAXKEYLEN)+sizeof(Two)))
 
 
 /*
@@ -125,13 +221,15 @@ typedef struct {   /* Internal (Nonleaf) Page */
 typedef struct {
 	PageID pid;                 /* page id of this page, should be located on the beginning */
 	Four flags;                 /* flag to store page information */
-	Four reserved;              /* reserved space to store page information */
+	Two prefixLen;              /* length of the key prefix common to all entries, NIL if not prefix compressed */
+	Two keyHead;                /* TRUE if each slot also holds the head of its key */
 	One     type;            /* Internal, Leaf, or Overflow */
 	Two     nSlots;          /* # of entries in this page */
 	Two     free;            /* starting point of the free space */
 	ShortPageID prevPage;        /* Previous page */
 	ShortPageID nextPage;        /* Next page */
 	Two     unused;          /* number of unused bytes which are not part of the contiguous freespace */
+	Two     denseKeyLen;     /* length of every key of a dense page, 0 if the page has slots */
 } BtreeLeafHdr;
 
 #define BL_FIXED  (sizeof(BtreeLeafHdr) + sizeof(Two))
@@ -156,10 +254,96 @@ typedef struct {   /* Leaf Page */
  *  BtreeLeaf *p      : pointer to the leaf page
  * Returns: (Four) size of contiguous free area
  */
-#define BL_CFREE(p)    (PAGESIZE - BL_FIXED - (p)->hdr.free - ((p)->hdr.nSlots-1)*((CONSTANT_CASTING_TYPE)sizeof(Two)))
+#define BL_CFREE(p)    (PAGESIZE - BL_FIXED - (p)->hdr.free - ((p)->hdr.nSlots*BL_SLOTSIZE(p) - (CONSTANT_CASTING_TYPE)sizeof(Two)))
 #define BL_HALF        ((CONSTANT_CASTING_TYPE)((PAGESIZE-BL_FIXED)/2))
+#define BL_APPEND_FILL ((CONSTANT_CASTING_TYPE)((PAGESIZE-BL_FIXED)*BTM_APPEND_FILLFACTOR/100))
 #define OVERFLOW_SPLIT ((CONSTANT_CASTING_TYPE)(PAGESIZE-BL_FIXED)/3)
 
+/* Macro: BL_PREFIX_AREA(p)
+ * Description: return the size of the area at the beginning of the data area
+ *              which holds the key prefix of the leaf page given as a parameter
+ * Parameter:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ * Returns: (Four) size of the prefix area
+ */
+#define BL_PREFIX_AREA(p)  (((p)->hdr.prefixLen == NIL) ? 0 : ALIGNED_LENGTH((p)->hdr.prefixLen))
+/* the smallest entry is the one of a dense page on an SM_INT key */
+#define BL_MAXENTRIES  ((CONSTANT_CASTING_TYPE)((PAGESIZE-BL_FIXED)/(SM_INT_SIZE+OBJECTID_SIZE)))
+
+/*
+ * A slot of a leaf page whose 'keyHead' is TRUE is BL_KEYHEAD_SIZE bytes of
+ * an order preserving key head (see edubtm_LeafKeyHead()) followed by the
+ * offset of the entry. Slot i occupies the (i+1)-th BL_SLOTSIZE(p) bytes
+ * from the end of the page.
+ */
+#define BL_KEYHEAD_SIZE  sizeof(UFour)
+
+/* Macro: BL_SLOTSIZE(p)
+ * Description: return the size of a slot of the leaf page given as a parameter
+ * Parameter:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ * Returns: (Four) size of a slot
+ */
+#define BL_SLOTSIZE(p)  ((CONSTANT_CASTING_TYPE)((p)->hdr.denseKeyLen != 0 ? 0 : \
+	                 (p)->hdr.keyHead ? sizeof(Two) + BL_KEYHEAD_SIZE : sizeof(Two)))
+
+/* Macro: BL_SLOT(p, i)
+ * Description: the entry offset stored in the i-th slot of the leaf page given as a parameter
+ * Parameters:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ *  Two i             : slot No.
+ * Returns: (Two lvalue) offset of the entry in the data area
+ */
+#define BL_SLOT(p, i)   ((p)->slot[-(i) * (BL_SLOTSIZE(p) / (CONSTANT_CASTING_TYPE)sizeof(Two))])
+
+/* Macro: BL_SLOTPTR(p, i)
+ * Description: return the start of the i-th slot of the leaf page given as a parameter;
+ *              the key head of a 'keyHead' page is stored there
+ * Parameters:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ *  Two i             : slot No.
+ * Returns: (char*) start of the slot
+ */
+#define BL_SLOTPTR(p, i) ((char*)((p)->slot + 1) - ((i) + 1) * BL_SLOTSIZE(p))
+
+/*
+ * A dense leaf page, whose 'denseKeyLen' is not 0, has no slots. Its data
+ * area holds an array of BL_DENSE_MAXENTRIES(p) sorted fixed-length keys
+ * followed by the array of their ObjectIDs; the first 'nSlots' elements of
+ * both are used and 'free' is the number of bytes they take.
+ */
+
+/* Macro: BL_DENSE_MAXENTRIES(p)
+ * Description: return the capacity of the dense leaf page given as a parameter
+ * Parameter:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ * Returns: (Four) # of entries
+ */
+#define BL_DENSE_MAXENTRIES(p)  ((CONSTANT_CASTING_TYPE)((PAGESIZE-BL_FIXED)/((p)->hdr.denseKeyLen+OBJECTID_SIZE)))
+
+/* Macro: BL_DENSE_KEY(p, i)
+ * Description: return the i-th key of the dense leaf page given as a parameter
+ * Parameters:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ *  Two i             : entry No.
+ * Returns: (char*) the key
+ */
+#define BL_DENSE_KEY(p, i)  (&(p)->data[(i) * (p)->hdr.denseKeyLen])
+
+/* Macro: BL_DENSE_OID(p, i)
+ * Description: return the ObjectID of the i-th entry of the dense leaf page given as a parameter
+ * Parameters:
+ *  BtreeLeaf *p      : pointer to the leaf page
+ *  Two i             : entry No.
+ * Returns: (ObjectID*) the ObjectID
+ */
+#define BL_DENSE_OID(p, i)  ((ObjectID*)&(p)->data[BL_DENSE_MAXENTRIES(p) * (p)->hdr.denseKeyLen + (i) * OBJECTID_SIZE])
+
+/* formats of a rebuilt leaf page; see BTM_LEAF_FORMAT() */
+#define BL_PREFIX      0x1     /* prefix compressed */
+#define BL_KEYHEAD     0x2     /* key heads in the slots */
+#define BL_DENSE       0x4     /* key and ObjectID arrays without slots */
+
 
 /*
  * BteeOverflow:
@@ -239,9 +423,16 @@ typedef struct {
 /* Data type of Leaf Entry */
 #define BTM_LEAFENTRY_FIXED OFFSET_OF(btm_LeafEntry, kval[0])
 
-/* Data type of Leaf Entry */
+/*
+ * Data type of Leaf Entry
+ *  The key is followed by the sorted array of the 'nObjects' ObjectIDs of
+ *  the key. When the entry would grow beyond OVERFLOW_SPLIT, the ObjectIDs
+ *  move to a doubly linked chain of overflow pages holding them in order;
+ *  then 'nObjects' is NIL and the key is followed by the ShortPageID of the
+ *  first page of the chain. An entry of a unique index has one ObjectID.
+ */
 typedef struct {
-	Two nObjects;       /* # of ObjectIDs */
+	Two nObjects;       /* # of ObjectIDs, NIL if they are in overflow pages */
 	/* 'klen' and 'kval' should be attached in this order */
 	/* to cast this variables the type KeyVlaue. */
 	Two klen;           /* key length */
@@ -265,10 +456,348 @@ typedef struct {
 } LeafItem;
 
 
+/*
+ * Data type for referring to a leaf entry together with the key prefix of
+ * its page, so that entries can be moved between pages of different formats.
+ * An entry of a dense page is referred by its key and ObjectID.
+ */
+typedef struct {
+	char          *prefix;      /* key prefix of the page holding the entry */
+	Two           prefixLen;    /* length of 'prefix', NIL if the page is not prefix compressed */
+	btm_LeafEntry *entry;       /* the leaf entry, NULL for an entry of a dense page */
+	char          *key;         /* key of an entry of a dense page */
+	Two           klen;         /* length of 'key' */
+	ObjectID      *oid;         /* ObjectID of an entry of a dense page */
+} LeafEntryRef;
+
+/*
+ * Data type for the room used to move the entries of two leaves
+ *  The entries of two leaves being redistributed or merged refer to images
+ *  of the pages, both kept in the room of the opened index instead of on
+ *  the stack. It is allocated on first use (see edubtm_GetLeafScratch()).
+ */
+typedef struct {
+	BtreeLeaf     page[2];                  /* images of the pages */
+	LeafEntryRef  refs[2*BL_MAXENTRIES+2];  /* entries of both pages */
+} BtreeLeafScratch;
+
+
+/*
+ * Data type for the path of a descent from the root
+ *  The internal pages passed, the entry of the child taken on each and the
+ *  buffer of each page while it is fixed. Splits and underflows of the
+ *  children walk back up the path (see edubtm_Path.c).
+ */
+typedef struct {
+	Two       height;               /* # of internal pages on the path */
+	PageID    pid[BTM_MAXLEVEL];    /* the internal pages from the root down */
+	Two       idx[BTM_MAXLEVEL];    /* entry of the child taken, -1 for p0 */
+	BtreePage *page[BTM_MAXLEVEL];  /* buffer of the page, NULL once it is freed */
+	Boolean   pinned[BTM_MAXLEVEL]; /* TRUE if the page is pinned by the index, not fixed by the path */
+	Two       nRightmost;           /* # of pages from the root whose child taken is their last one */
+} BtreePath;
+
+/*
+ * Data type for the finger of an opened index
+ *  The leaf reached by the last descent, the internal pages above it and the
+ *  range of keys routed to it, low <= key < high. An operation on a key in
+ *  the range goes to the leaf directly (see edubtm_Finger.c).
+ */
+typedef struct {
+	PageID   leaf;              /* the leaf, pageNo NIL if there is no finger */
+	Two      height;            /* # of internal pages above the leaf */
+	PageID   path[BTM_MAXLEVEL]; /* the internal pages from the root down */
+	Two      nRightmost;        /* # of them from the root whose child taken is their last one */
+	Boolean  lowSet;            /* FALSE if the range has no lower bound */
+	Boolean  highSet;           /* FALSE if the range has no upper bound */
+	KeyValue low;               /* lower bound of the range */
+	KeyValue high;              /* upper bound of the range, excluded */
+} BtreeFinger;
+
+/* kinds of the entries of the log of leaf splits and merges */
+#define BTM_CHURN_SPLIT 1
+#define BTM_CHURN_MERGE 2
+
+/*
+ * Data type for the log of the leaf splits and merges of an opened index
+ *  The pages of the latest BTM_CHURN_WINDOW splits and merges are kept in a
+ *  ring (see edubtm_Churn.c).
+ */
+typedef struct {
+	Four        nSplits;                    /* # of leaf splits */
+	Four        nMerges;                    /* # of leaf merges */
+	Four        nSplitsAfterMerge;          /* # of splits of a page merged within the window */
+	Four        nMergesAfterSplit;          /* # of merges of a page splitted within the window */
+	Two         next;                       /* next entry of the ring to be used */
+	Two         kind[BTM_CHURN_WINDOW];     /* BTM_CHURN_SPLIT, BTM_CHURN_MERGE or 0 for unused */
+	ShortPageID left[BTM_CHURN_WINDOW];     /* the left page of a split or a merge */
+	ShortPageID right[BTM_CHURN_WINDOW];    /* the right page of a split or a merge */
+} BtreeChurn;
+
+/*
+ * Data type for the pinned upper levels of an opened index
+ *  The internal pages on the top 'levels' levels stay fixed while the index
+ *  is open, so that a descent reads them without the buffer manager. They
+ *  are pinned by the first descents passing them, up to 'maxPages' pages.
+ *  A pinned page keeps its slot while it is pinned (see edubtm_Pin.c).
+ */
+typedef struct {
+	Two         levels;                     /* # of levels pinned from the root, 0 if none */
+	Two         maxPages;                   /* the most pages pinned */
+	Two         nPages;                     /* # of pages pinned */
+	Two         order[BTM_MAXPINNED];       /* the slots of the pinned pages, in ascending order of the pages */
+	ShortPageID pageNo[BTM_MAXPINNED];      /* the page pinned in each slot */
+	BtreePage   *page[BTM_MAXPINNED];       /* its buffer, NULL if the slot is free */
+	Four        nAccesses[BTM_MAXLEVEL];    /* # of pages reached by descents on each level from the root */
+	Four        nHits[BTM_MAXLEVEL];        /* # of them found pinned */
+} BtreePinCache;
+
+/*
+ * Data type for the result of an SM_EQ probe kept for a hot key
+ *  The position of the first ObjectID of the key, valid while the version
+ *  of its leaf is unchanged.
+ */
+typedef struct {
+	Two         klen;                       /* length of the key, NIL if the entry is unused */
+	char        kval[BTM_HOTKEYLEN];        /* the key */
+	ObjectID    oid;                        /* its first ObjectID */
+	ShortPageID leaf;                       /* the leaf holding the key */
+	ShortPageID overflow;                   /* the overflow page holding the ObjectID, NIL if none */
+	Two         slotNo;                     /* slot of the key in the leaf */
+	Two         oidArrayElemNo;             /* element of the ObjectID in its array */
+	Four        version;                    /* version of the leaf when the entry was made */
+} BtreeHotKey;
+
+/*
+ * Data type for the hot keys of an opened index
+ *  The first 'nEntries' entries hold the results of SM_EQ probes, each key
+ *  in the entry chosen by its hash (see edubtm_HotKey.c).
+ */
+typedef struct {
+	Four        nEntries;                   /* # of entries in use, 0 if no key is kept */
+	Four        nHits;                      /* # of probes answered by an entry */
+	Four        nMisses;                    /* # of probes which descended the tree */
+	Four        version[BTM_LEAFVERSIONS];  /* versions of the leaves */
+	BtreeHotKey *entry;                     /* the entries, allocated by EduBtM_CacheHotKeys(), NULL if none */
+} BtreeHotKeyCache;
+
+/*
+ * Data type for a key mapped to its leaf
+ *  The leaf holds the key, or would hold it, while the shape of the leaf
+ *  is unchanged; the slot is where the key was last seen. An entry which
+ *  has started a probe is spared once when another key is to be mapped.
+ */
+typedef struct {
+	Two         klen;                       /* length of the key, NIL if the entry is unused */
+	char        kval[BTM_HOTKEYLEN];        /* the key */
+	ShortPageID leaf;                       /* the leaf of the key */
+	Two         slotNo;                     /* slot of the key in the leaf, a hint */
+	Four        shape;                      /* shape of the leaf when the entry was made */
+	Boolean     used;                       /* TRUE if a probe has started by the entry since it was made or spared */
+} BtreeLeafHint;
+
+/*
+ * Data type for the keys of an opened index mapped to hot leaves
+ *  The 'nEntries' entries map keys, each key in the entry chosen by its
+ *  hash (see edubtm_LeafHash.c); they are allocated when a leaf first
+ *  gets hot.
+ */
+typedef struct {
+	Four        nEntries;                   /* # of entries, 0 if no key is mapped */
+	Four        nHits;                      /* # of SM_EQ probes which started at the leaf */
+	Four        nMisses;                    /* # of SM_EQ probes which descended the tree */
+	Four        shape[BTM_LEAFVERSIONS];    /* shapes of the leaves */
+	Four        heat[BTM_LEAFVERSIONS];     /* # of SM_EQ descents to the leaves */
+	BtreeLeafHint *entry;                   /* the entries, NULL until a leaf gets hot */
+} BtreeLeafHash;
+
+/*
+ * Data type for the Bloom filter of an opened index
+ *  Each counter is at least the number of keys of the index counted in it,
+ *  so a key with a zero counter is not in the index (see edubtm_Bloom.c).
+ */
+typedef struct {
+	Four        nCounters;                  /* # of counters in use, 0 if there is no filter */
+	Four        nNegatives;                 /* # of probes and deletes answered by the filter */
+	Four        nFalsePositives;            /* # of probes and deletes passed which found nothing */
+	UOne        *counter;                   /* the counters, allocated by EduBtM_BuildBloomFilter(), NULL if none */
+} BtreeBloomFilter;
+
+/*
+ * Data type for an opened B+ tree index
+ *  EduBtM_OpenIndex() validates the key descriptor once and selects the
+ *  comparator for its key layout, so that the operations taking the handle
+ *  neither check the key descriptor nor branch on its key type.
+ */
+typedef struct {
+	ObjectID catObjForFile;     /* catalog object of B+ tree file */
+	PageID   root;              /* root page of the B+ tree */
+	KeyDesc  kdesc;             /* key descriptor */
+	Four     (*keyCompare)(KeyDesc*, KeyValue*, KeyValue*); /* comparator for 'kdesc' */
+	BtreeFinger finger;         /* the last leaf visited */
+	Four     leafLowWater;      /* a leaf using fewer bytes underflows */
+	Four     leafHighWater;     /* the most bytes of a leaf made by a merge */
+	BtreeChurn churn;           /* the leaf splits and merges */
+	BtreePinCache pin;          /* the pinned upper levels */
+	BtreeHotKeyCache hot;       /* the hot keys */
+	BtreeBloomFilter bloom;     /* the Bloom filter of the keys */
+	BtreeLeafHash leafHash;     /* the keys mapped to hot leaves */
+	BtreeLeafScratch *scratch;  /* room for moving leaf entries, NULL until used */
+} BtreeHandle;
+
+/* Data type for an object returned by EduBtM_FetchNextBatch() */
+typedef struct {
+	ObjectID oid;               /* the ObjectID */
+	KeyValue key;               /* its key value */
+} BtreeFetchResult;
+
+/* Data type for reporting the shape and the space utilization of a B+ tree */
+typedef struct {
+	Four height;            /* # of levels including the leaf level */
+	Four nInternalPages;    /* # of internal pages */
+	Four nLeafPages;        /* # of leaf pages */
+	Four nEntries;          /* # of leaf entries */
+	Eight internalUsed;     /* bytes used by entries and slots of internal pages */
+	Eight leafUsed;         /* bytes used by entries and slots of leaf pages */
+	float internalFillFactor; /* internalUsed over the data area of all internal pages (%) */
+	float leafFillFactor;   /* leafUsed over the data area of all leaf pages (%) */
+	Four nLeafSplits;       /* # of leaf splits since the index was opened */
+	Four nLeafMerges;       /* # of leaf merges since the index was opened */
+	Four nSplitsAfterMerge; /* # of them splitting a page merged shortly before */
+	Four nMergesAfterSplit; /* # of them merging a page splitted shortly before */
+	Four nPinnedPages;      /* # of internal pages pinned */
+	Four nAccesses[BTM_MAXLEVEL]; /* # of pages reached by descents on each level, the root first */
+	Four nPinHits[BTM_MAXLEVEL];  /* # of them found pinned */
+	Four nHotKeys;          /* # of entries for hot keys */
+	Four nHotKeyHits;       /* # of SM_EQ probes answered by them */
+	Four nHotKeyMisses;     /* # of SM_EQ probes which descended the tree */
+	Four nBloomCounters;    /* # of counters of the Bloom filter */
+	Four nBloomNegatives;   /* # of SM_EQ probes and deletes answered by it */
+	Four nBloomFalsePositives; /* # of them passed which found nothing */
+	Four nLeafHints;        /* # of entries for keys mapped to hot leaves */
+	Four nLeafHintHits;     /* # of SM_EQ probes which started at the leaf by them */
+	Four nLeafHintMisses;   /* # of SM_EQ probes which descended the tree */
+} BtreeStatistics;
+
+/* Data type for the state of a sorted bulk load */
+typedef struct {
+	BtreeHandle *handle;        /* the index being loaded */
+	Four     leafFill;          /* bytes of a leaf to be filled */
+	Four     internalFill;      /* bytes of an internal page to be filled */
+	Four     height;            /* # of levels built so far */
+	PageID   page[BTM_MAXLEVEL]; /* the rightmost page of each level; level 0 is the leaf level */
+	KeyValue lastKey;           /* the last key loaded */
+} BtreeBulkLoad;
+
+
 /*@
 ** Macro Definitions
 */
 
+/* Macro: BTM_KEYCOMPARE(handle, key1, key2)
+ * Description: compare two key values with the comparator of an opened index
+ * Parameters:
+ *  BtreeHandle *handle      : pointer to the opened index
+ *  KeyValue *key1, *key2    : key values to be compared
+ * Returns: (Four) EQUAL, GREAT or LESS
+ */
+#define BTM_KEYCOMPARE(handle, key1, key2) ((handle)->keyCompare(&(handle)->kdesc, (key1), (key2)))
+
+/* Macro: BTM_NORMALIZED(handle)
+ * Description: tell whether the keys of an opened index are kept normalized
+ *              by edubtm_NormalizeKey(), which is so for keys of several parts
+ * Parameters:
+ *  BtreeHandle *handle      : pointer to the opened index
+ * Returns: (Boolean) TRUE if the keys are normalized
+ */
+#define BTM_NORMALIZED(handle) ((handle)->kdesc.nparts > 1)
+
+/* Macro: BTM_SAFE_FOR_INSERT(page)
+ * Description: tell whether an internal page takes any new separator of a
+ *              split child without being splitted itself
+ * Parameters:
+ *  BtreeInternal *page      : pointer to the internal page
+ * Returns: (Boolean) TRUE if the page is safe
+ */
+#define BTM_SAFE_FOR_INSERT(page) (BI_FREE(page) >= BI_MAXENTRYSPACE)
+
+/* Macro: BTM_SAFE_FOR_DELETE(page)
+ * Description: tell whether an internal page stays half full and unsplitted
+ *              when an underflowed child is merged or redistributed
+ * Parameters:
+ *  BtreeInternal *page      : pointer to the internal page
+ * Returns: (Boolean) TRUE if the page is safe
+ */
+#define BTM_SAFE_FOR_DELETE(page) \
+	(BI_FREE(page) >= BI_MAXENTRYSPACE && BI_FREE(page) + BI_MAXENTRYSPACE <= BI_HALF)
+
+/* Macro: BTM_LEAF_UNDERFLOW(handle, page)
+ * Description: tell whether a leaf page uses less than the low water mark
+ *              of an opened index
+ * Parameters:
+ *  BtreeHandle *handle      : pointer to the opened index
+ *  BtreeLeaf *page          : pointer to the leaf page
+ * Returns: (Boolean) TRUE if the page underflows
+ */
+#define BTM_LEAF_UNDERFLOW(handle, page) \
+	((PAGESIZE - BL_FIXED) - BL_FREE(page) < (handle)->leafLowWater)
+
+/* Macro: BTM_INVALIDATE_FINGER(handle)
+ * Description: forget the finger of an opened index; done whenever the key
+ *              range of a leaf changes, i.e. on splits, merges and
+ *              redistributions
+ * Parameters:
+ *  BtreeHandle *handle      : pointer to the opened index
+ */
+#define BTM_INVALIDATE_FINGER(handle) ((handle)->finger.leaf.pageNo = NIL)
+
+/* Macro: BTM_OBJECTS_LEN(n)
+ * Description: return the length of the part of a leaf entry following its key
+ * Parameters:
+ *  Two n                    : 'nObjects' of the entry
+ * Returns: (Four) length of the ObjectID array or of the overflow PageID
+ */
+#define BTM_OBJECTS_LEN(n) \
+	((CONSTANT_CASTING_TYPE)(((n) == NIL) ? sizeof(ShortPageID) : (n) * OBJECTID_SIZE))
+
+/* Macro: BTM_LEAFENTRY_OBJECTS(entry)
+ * Description: return the part of a leaf entry following its key
+ * Parameters:
+ *  btm_LeafEntry *entry     : pointer to the leaf entry
+ * Returns: (char*) the ObjectID array, or the ShortPageID of the first overflow page
+ */
+#define BTM_LEAFENTRY_OBJECTS(entry) (&(entry)->kval[ALIGNED_LENGTH((entry)->klen)])
+
+/* Macro: BTM_SCAN_BACKWARD(compOp)
+ * Description: tell whether a scan with the given stop condition runs backward
+ * Parameters:
+ *  Four compOp              : comparison operator of the stop condition
+ * Returns: (Boolean) TRUE for SM_GT, SM_GE and SM_BOF
+ */
+#define BTM_SCAN_BACKWARD(compOp) ((compOp) == SM_GT || (compOp) == SM_GE || (compOp) == SM_BOF)
+
+/* Macro: BTM_LEAF_FORMAT(handle, page)
+ * Description: return the format in which the leaf page given as a parameter is
+ *              to be rebuilt; once compressed or dense, a page stays so
+ * Parameters:
+ *  BtreeHandle *handle      : pointer to the opened index
+ *  BtreeLeaf *page          : pointer to the leaf page
+ * Returns: (Four) BL_DENSE, or BL_PREFIX and/or BL_KEYHEAD
+ */
+#define BTM_LEAF_FORMAT(handle, page) \
+	((((handle)->kdesc.flag & KEYFLAG_DENSE) || (page)->hdr.denseKeyLen != 0) ? BL_DENSE : \
+	 (((((handle)->kdesc.flag & KEYFLAG_PREFIX) || (page)->hdr.prefixLen != NIL) ? BL_PREFIX : 0) | \
+	  (((handle)->kdesc.flag & KEYFLAG_KEYHEAD) ? BL_KEYHEAD : 0)))
+
+/* Macro: BTM_DENSE_KEYLEN(handle)
+ * Description: return the length of a key in a dense leaf page of an opened index
+ * Parameters:
+ *  BtreeHandle *handle      : pointer to the opened index
+ * Returns: (Two) SM_INT_SIZE or SM_LONG_LONG_SIZE
+ */
+#define BTM_DENSE_KEYLEN(handle) \
+	((Two)(((handle)->kdesc.kpart[0].type == SM_INT) ? SM_INT_SIZE : SM_LONG_LONG_SIZE))
+
 /* Macro: GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry)
  * Description: get the information about the index file(sm_CatOverlayForBtree) residing in the catalog object for index file
  * Parameters:
@@ -279,7 +808,7 @@ typedef struct {
 #define GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry) \
 BEGIN_MACRO \
     sm_CatOverlayForSysTables *smSysTables; \
-    Object *obj = (Object*)&(catPage->data[catPage->slot[-catObjForFile->slotNo].offset]); \
+    Object *obj = (Object*)&(catPage->data[catPage->slot[-(catObjForFile)->slotNo].offset]); \
     catEntry = &(((sm_CatOverlayForSysTables*)&(obj->data))->btree);\
 END_MACRO
 
@@ -290,22 +819,84 @@ END_MACRO
 /*
 ** B+tree Manager Internal function prototypes
 */
-Boolean edubtm_BinarySearchInternal(BtreeInternal*, KeyDesc*, KeyValue*, Two*);
-Boolean edubtm_BinarySearchLeaf(BtreeLeaf*, KeyDesc*, KeyValue*, Two*);
+Boolean edubtm_BinarySearchInternal(BtreeInternal*, BtreeHandle*, KeyValue*, Two*);
+Boolean edubtm_BinarySearchLeaf(BtreeLeaf*, BtreeHandle*, KeyValue*, Two*);
 void edubtm_CompactInternalPage(BtreeInternal*, Two);
 void edubtm_CompactLeafPage(BtreeLeaf*, Two);
 Four edubtm_KeyCompare(KeyDesc*, KeyValue*, KeyValue*);
-Four edubtm_Delete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
-Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
-Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, Boolean*, InternalItem*);
-Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*, Two, Boolean*, InternalItem*);
-Four edubtm_FirstObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*);
+Four edubtm_IntKeyCompare(KeyDesc*, KeyValue*, KeyValue*);
+Four edubtm_LongLongKeyCompare(KeyDesc*, KeyValue*, KeyValue*);
+Four edubtm_VarStringKeyCompare(KeyDesc*, KeyValue*, KeyValue*);
+Four edubtm_NormalizedKeyCompare(KeyDesc*, KeyValue*, KeyValue*);
+Four edubtm_NormalizeKey(KeyDesc*, KeyValue*, KeyValue*);
+void edubtm_DenormalizeKey(KeyDesc*, KeyValue*, KeyValue*);
+Four edubtm_StringCompare(char*, Two, char*, Two);
+Four edubtm_Delete(BtreeHandle*, PageID*, KeyValue*, ObjectID*, Boolean, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_SpliceRange(BtreeHandle*, PhysicalFileID*, PageID*, KeyValue*, KeyValue*, Boolean*, ShortPageID*, ShortPageID*, Boolean*, Pool*, DeallocListElem*);
+Four edubtm_LinkLeaves(VolID, ShortPageID, ShortPageID);
+Four edubtm_RebalanceRange(BtreeHandle*, PageID*, KeyValue*, KeyValue*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_Insert(BtreeHandle*, PageID*, KeyValue*, ObjectID*, Boolean, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_InsertLeaf(BtreeHandle*, PageID*, BtreeLeaf*, KeyValue*, ObjectID*, Boolean, Boolean*, Boolean*, InternalItem*);
+Four edubtm_InsertBatch(BtreeHandle*, PageID*, KeyValue*, ObjectID*, Two*, Two, Two*, Boolean*, InternalItem*);
+Four edubtm_InsertAtFinger(BtreeHandle*, KeyValue*, ObjectID*, Boolean, Boolean*, InternalItem*);
+Four edubtm_PushPath(BtreePath*, PageID*, BtreePage*, Boolean, Two);
+Four edubtm_FixPathPage(BtreePath*, Two);
+Four edubtm_ReleaseAncestors(BtreePath*);
+Four edubtm_FreePath(BtreePath*);
+Four edubtm_FixPage(BtreeHandle*, PageID*, Two, BtreePage**, Two*);
+Four edubtm_UnfixPage(PageID*, Boolean);
+Four edubtm_UnpinPage(BtreeHandle*, PageID*);
+Four edubtm_UnpinAll(BtreeHandle*);
+void edubtm_ClearHotKeys(BtreeHandle*);
+Boolean edubtm_LookUpHotKey(BtreeHandle*, KeyValue*, BtreeCursor*);
+void edubtm_KeepHotKey(BtreeHandle*, KeyValue*, BtreeCursor*);
+void edubtm_BloomAdd(BtreeHandle*, KeyValue*);
+void edubtm_BloomRemove(BtreeHandle*, KeyValue*);
+Boolean edubtm_BloomMayContain(BtreeHandle*, KeyValue*);
+Four edubtm_BloomAddLeaves(BtreeHandle*);
+void edubtm_ClearLeafHints(BtreeHandle*);
+Boolean edubtm_LookUpLeafHint(BtreeHandle*, KeyValue*, PageID*, Two*);
+void edubtm_KeepLeafHint(BtreeHandle*, KeyValue*, BtreeCursor*);
+void edubtm_ResetChurn(BtreeHandle*);
+void edubtm_LogChurn(BtreeHandle*, Two, ShortPageID, ShortPageID);
+void edubtm_ResetFinger(BtreeHandle*);
+void edubtm_NarrowFinger(BtreeHandle*, PageID*, BtreeInternal*, Two);
+void edubtm_SetFingerLeaf(BtreeHandle*, PageID*);
+Boolean edubtm_FingerCovers(BtreeHandle*, KeyValue*);
+Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*, Two, Boolean, Boolean*, InternalItem*);
+Four edubtm_FirstObject(BtreeHandle*, KeyValue*, Four, BtreeCursor*);
+void edubtm_GetLeafObject(BtreeLeaf*, Two, KeyValue*, ObjectID*);
+void edubtm_GetLeafEntryRef(BtreeLeaf*, Two, LeafEntryRef*);
+void edubtm_GetLeafEntryRefKey(LeafEntryRef*, KeyValue*);
+Two edubtm_GetLeafEntryRefs(BtreeLeaf*, LeafEntryRef*);
+Four edubtm_GetLeafScratch(BtreeHandle*, BtreeLeafScratch**);
+Four edubtm_LeafEntriesSize(LeafEntryRef*, Two, Four);
+Two edubtm_PartitionLeafEntries(LeafEntryRef*, Two, Four, Four, Two);
+Boolean edubtm_DivideLeafEntries(LeafEntryRef*, Two, Four, Two, Two*);
+void edubtm_BuildLeafPage(BtreeHandle*, BtreeLeaf*, LeafEntryRef*, Two, Four);
+Boolean edubtm_BinarySearchDenseLeaf(BtreeLeaf*, KeyValue*, Two*);
+void edubtm_InsertDenseEntry(BtreeLeaf*, Two, char*, ObjectID*);
+void edubtm_DeleteDenseEntry(BtreeLeaf*, Two);
+UFour edubtm_LeafKeyHead(BtreeHandle*, BtreeLeaf*, char*, Two);
+void edubtm_SetLeafSlot(BtreeHandle*, BtreeLeaf*, Two, Two);
 Four edubtm_FreePages(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
 Four edubtm_InitInternal(PageID*, Boolean, Boolean);
 Four edubtm_InitLeaf(PageID*, Boolean, Boolean);
-Four edubtm_LastObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*);
-Four edubtm_SplitInternal(ObjectID*, BtreeInternal*, Two, InternalItem*, InternalItem*);
-Four edubtm_SplitLeaf(ObjectID*, PageID*, BtreeLeaf*, Two, LeafItem*, InternalItem*);
+Four edubtm_InitOverflow(PageID*);
+Four edubtm_CreateOverflow(BtreeHandle*, PageID*, BtreeLeaf*, Two, ObjectID*);
+Four edubtm_InsertOverflow(BtreeHandle*, PageID*, ObjectID*);
+Four edubtm_DeleteOverflow(PageID*, ObjectID*, Two, ObjectID*, Two*, Pool*, DeallocListElem*);
+Four edubtm_FreeOverflow(PageID*, Pool*, DeallocListElem*);
+Four edubtm_SetCursorObject(BtreeLeaf*, PageID*, Two, Boolean, BtreeCursor*);
+Four edubtm_NextObjectOfEntry(BtreeLeaf*, BtreeCursor*, Boolean, BtreeCursor*, Boolean*);
+Four edubtm_LastObject(BtreeHandle*, KeyValue*, Four, BtreeCursor*);
+Four edubtm_SplitInternal(ObjectID*, BtreeInternal*, Two, Boolean, InternalItem*, InternalItem*);
+Four edubtm_SplitLeaf(BtreeHandle*, PageID*, BtreeLeaf*, Two, btm_LeafEntry*, Boolean*, InternalItem*);
+void edubtm_MakeSeparator(BtreeHandle*, KeyValue*, KeyValue*, ShortPageID, InternalItem*);
+Four edubtm_Underflow(BtreeHandle*, BtreeInternal*, PageID*, Two, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_ReplaceSeparator(BtreeHandle*, BtreeInternal*, Two, InternalItem*, Boolean*, InternalItem*);
+Four edubtm_FreePage(PageID*, BtreePage*, Pool*, DeallocListElem*);
+void edubtm_DeleteInternalEntry(BtreeInternal*, Two);
 Four edubtm_get_objectid_from_leaf(BtreeCursor*);
 Four edubtm_root_insert(ObjectID*, PageID*, InternalItem*);
 
@@ -326,12 +917,28 @@ Four btm_IsTemporary(ObjectID*, Boolean*);
  * B+tree Manager Interface function prototypes
  */
 /*
+Four EduBtM_BuildBloomFilter(BtreeHandle*, Four);
+Four EduBtM_CacheHotKeys(BtreeHandle*, Four);
+Four EduBtM_CloseIndex(BtreeHandle*);
 Four EduBtM_CreateIndex(ObjectID*, PageID*);
-Four EduBtM_DeleteObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteKey(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteRange(BtreeHandle*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
 Four EduBtM_DropIndex(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
-Four EduBtM_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
-Four EduBtM_FetchNext(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
-Four EduBtM_InsertObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_Fetch(BtreeHandle*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
+Four EduBtM_FetchNext(BtreeHandle*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
+Four EduBtM_FetchNextBatch(BtreeHandle*, KeyValue*, Four, BtreeCursor*, Four, BtreeFetchResult*, Four*, BtreeCursor*);
+Four EduBtM_GetStatistics(BtreeHandle*, BtreeStatistics*);
+Four EduBtM_HashHotLeaves(BtreeHandle*, Four);
+Four EduBtM_InsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_InsertObjects(BtreeHandle*, KeyValue*, ObjectID*, Four, Pool*, DeallocListElem*);
+Four EduBtM_InitBulkLoad(BtreeHandle*, Four, BtreeBulkLoad*);
+Four EduBtM_NextBulkLoad(BtreeBulkLoad*, KeyValue*, ObjectID*);
+Four EduBtM_FinalBulkLoad(BtreeBulkLoad*, Pool*, DeallocListElem*);
+Four EduBtM_OpenIndex(ObjectID*, PageID*, KeyDesc*, BtreeHandle*);
+Four EduBtM_PinUpperLevels(BtreeHandle*, Four, Four);
+Four EduBtM_SetWaterMarks(BtreeHandle*, Four, Four);
+Four EduBtM_UpsertObject(BtreeHandle*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
 */
 
 
@@ -42,6 +42,17 @@
 #define MAXFILENAME 255
 #define MAXKEY 60
 #define MAXPERFTEST 30
+#define SCANBATCHSIZE 64
+#define LOADBATCHSIZE 300
+#define MAXTESTENTRIES 10000
+#define NUMOFNONUNIQUEKEYS 24
+#define MAXNONUNIQUEOBJECTS 1200
+#define NUMOFCOMPOSITEKEYS 225
+#define NUMOFWATERMARKKEYS 4000
+#define NUMOFRANGEKEYS 6000
+#define NUMOFDELETEDRANGES 8
+#define NUMOFPROBEKEYS 4000
+#define NUMOFPROBEOPS 20000
 
 #define f(x) #x
 
@@ -82,6 +93,9 @@ typedef enum {LOAD=0x1, TXNS=0x2} WorkloadType;
 
 typedef enum {A=0x1, B=0x2, C=0x3, D=0x4, E=0x5} SpecType;
 
+/* PLAIN is the layout the reference output is made with; the others change it or the way the index is used */
+typedef enum {PLAIN=0x1, LAYOUT=0x2, BATCHED=0x3, LAZYMERGE=0x4, NOMERGE=0x5, UPSERT=0x6, UPSERTLAYOUT=0x7, LASTCONFIG=UPSERTLAYOUT} ConfigType;
+
 
 /*
 ** Definition of Query Operator
@@ -330,6 +330,9 @@ typedef struct {
 } KeyDesc;
 
 #define KEYFLAG_UNIQUE 0x1
+#define KEYFLAG_PREFIX 0x2    /* compress the key prefix common to a leaf page (EduBtM, SM_VARSTRING) */
+#define KEYFLAG_KEYHEAD 0x4   /* keep a key head in each leaf slot (EduBtM) */
+#define KEYFLAG_DENSE   0x8   /* dense leaf pages of fixed-length integer keys (EduBtM) */
 
 
 /* BtreeCursor:
@@ -59,6 +59,14 @@ BEGIN_MACRO \
     if (1) return(e); \
 END_MACRO
 
+/* free the pages still fixed on a descent path (BtreePath) */
+#define ERRBPATH(e, path) \
+BEGIN_MACRO \
+    PRTERR(e); \
+    (Four) edubtm_FreePath(path); \
+    if (1) return(e); \
+END_MACRO
+
 /*
  * Function Prototypes
  */
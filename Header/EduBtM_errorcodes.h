@@ -37,6 +37,7 @@
  * Error Definitions for GENERAL_ERR_BASE
  */
 #define eBADCURSOR                               ERR_ENCODE_ERROR_CODE(GENERAL_ERR_BASE,9)
+#define eMEMORYALLOCERR                          ERR_ENCODE_ERROR_CODE(GENERAL_ERR_BASE,12)
 
 /*
  * Error Definitions for OM_ERR_BASE
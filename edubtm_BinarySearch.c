@@ -35,11 +35,12 @@
  *  in the given page but larger than the given key value.
  *
  * Exports:
- *  Boolean edubtm_BinarySearchInternal(BtreeInternal*, KeyDesc*, KeyValue*, Two*)
- *  Boolean edubtm_BinarySearchLeaf(BtreeLeaf*, KeyDesc*, KeyValue*, Two*)
+ *  Boolean edubtm_BinarySearchInternal(BtreeInternal*, BtreeHandle*, KeyValue*, Two*)
+ *  Boolean edubtm_BinarySearchLeaf(BtreeLeaf*, BtreeHandle*, KeyValue*, Two*)
  */
 
 
+#include <string.h>
 #include "EduBtM_common.h"
 #include "EduBtM_Internal.h"
 
@@ -49,7 +50,7 @@
  * edubtm_BinarySearchInternal()
  *================================*/
 /*
- * Function:  Boolean edubtm_BinarySearchInternal(BtreeInternal*, KeyDesc*,
+ * Function:  Boolean edubtm_BinarySearchInternal(BtreeInternal*, BtreeHandle*,
  *                                             KeyValue*, Two*)
  *
  * Description:
@@ -69,7 +70,7 @@
  */
 Boolean edubtm_BinarySearchInternal(
     BtreeInternal 	*ipage,		/* IN Page Pointer to an internal page */
-    KeyDesc       	*kdesc,		/* IN key descriptor */
+    BtreeHandle   	*handle,	/* IN opened index */
     KeyValue      	*kval,		/* IN key value */
     Two          	*idx)		/* OUT index to be returned */
 {
@@ -80,20 +81,12 @@ Boolean edubtm_BinarySearchInternal(
     btm_InternalEntry 	*entry;	/* an internal entry */
 
     
-    /* Error check whether using not supported functionality by EduBtM */
-    int i;
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
-
     low = 0;
     high = ipage->hdr.nSlots - 1;
     mid = (high + low )/2;
     while (low <= high) {
-        entry = &(ipage->data[ipage->slot[-mid]]);
-        cmp = edubtm_KeyCompare(kdesc, kval, &entry->klen);
+        entry = (btm_InternalEntry*)&(ipage->data[ipage->slot[-mid]]);
+        cmp = BTM_KEYCOMPARE(handle, kval, (KeyValue*)&entry->klen);
         if (cmp == EQUAL) {
             *idx = mid;
             return TRUE;
@@ -102,9 +95,8 @@ Boolean edubtm_BinarySearchInternal(
         else if (cmp == LESS) high = mid - 1;
         mid = (low + high) / 2;
     }
-    //
 
-    if (high ==-1) *idx = -1;
+    *idx = high;
     return FALSE;
 
 
@@ -121,7 +113,7 @@ Boolean edubtm_BinarySearchInternal(
  * edubtm_BinarySearchLeaf()
  *================================*/
 /*
- * Function: Boolean edubtm_BinarySearchLeaf(BtreeLeaf*, KeyDesc*,
+ * Function: Boolean edubtm_BinarySearchLeaf(BtreeLeaf*, BtreeHandle*,
  *                                        KeyValue*, Two*)
  *
  * Description:
@@ -131,6 +123,12 @@ Boolean edubtm_BinarySearchInternal(
  *  Search the leaf item of which value equals to or less than the given
  *  key value.
  *
+ *  On a prefix compressed page the key is compared with the page prefix
+ *  once; each probe then compares only the rest of the key with the suffix
+ *  stored in the entry. On a page keeping key heads in its slots, a probe
+ *  reads the entry only if the heads are equal. A dense page is searched
+ *  by edubtm_BinarySearchDenseLeaf().
+ *
  * Returns:
  *  Result of search: TRUE if the same key is found, FALSE otherwise
  *
@@ -140,7 +138,7 @@ Boolean edubtm_BinarySearchInternal(
  */
 Boolean edubtm_BinarySearchLeaf(
     BtreeLeaf 		*lpage,		/* IN Page Pointer to a leaf page */
-    KeyDesc   		*kdesc,		/* IN key descriptor */
+    BtreeHandle		*handle,	/* IN opened index */
     KeyValue  		*kval,		/* IN key value */
     Two       		*idx)		/* OUT index to be returned */
 {
@@ -149,22 +147,59 @@ Boolean edubtm_BinarySearchLeaf(
     Two  		high;		/* high index */
     Four 		cmp;		/* result of comparison */
     btm_LeafEntry 	*entry;		/* a leaf entry */
+    char		*str;		/* string part of the key after the page prefix */
+    Two			strLen;		/* length of 'str' */
+    UFour		head;		/* key head of the given key */
+    UFour		slotHead;	/* key head in a slot */
+
 
+    if (lpage->hdr.denseKeyLen != 0)
+        return edubtm_BinarySearchDenseLeaf(lpage, kval, idx);
+
+    if (lpage->hdr.prefixLen != NIL) {
+        str = &kval->val[sizeof(Two)];
+        strLen = kval->len - sizeof(Two);
+
+        cmp = edubtm_StringCompare(str, MIN(strLen, lpage->hdr.prefixLen),
+                                   lpage->data, MIN(strLen, lpage->hdr.prefixLen));
+        if (cmp == EQUAL && strLen < lpage->hdr.prefixLen) cmp = LESS;
+
+        /* a key not sharing the page prefix is outside the keys of the page */
+        if (cmp != EQUAL) {
+            *idx = (cmp == LESS) ? -1 : lpage->hdr.nSlots - 1;
+            return FALSE;
+        }
+
+        str += lpage->hdr.prefixLen;
+        strLen -= lpage->hdr.prefixLen;
+    }
 
-    /* Error check whether using not supported functionality by EduBtM */
-    int i;
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+    if (lpage->hdr.keyHead) {
+        if (lpage->hdr.prefixLen != NIL)
+            head = edubtm_LeafKeyHead(handle, lpage, str, strLen);
+        else
+            head = edubtm_LeafKeyHead(handle, lpage, kval->val, kval->len);
     }
     
     low = 0;
     high = lpage->hdr.nSlots - 1;
     mid = (low + high) / 2;
     while (low <= high) {
-        entry =&(lpage->data[lpage->slot[-mid]]);
-        cmp = edubtm_KeyCompare(kdesc, kval, &entry->klen);
+        if (lpage->hdr.keyHead) {
+            memcpy(&slotHead, BL_SLOTPTR(lpage, mid), BL_KEYHEAD_SIZE);
+            if (head != slotHead) {
+                if (head > slotHead) low = mid + 1;
+                else high = mid - 1;
+                mid = (low + high) / 2;
+                continue;
+            }
+        }
+
+        entry = (btm_LeafEntry*)&(lpage->data[BL_SLOT(lpage, mid)]);
+        if (lpage->hdr.prefixLen != NIL)
+            cmp = edubtm_StringCompare(str, strLen, entry->kval, entry->klen);
+        else
+            cmp = BTM_KEYCOMPARE(handle, kval, (KeyValue*)&entry->klen);
         if (cmp == EQUAL) {
             *idx = mid;
             return TRUE;
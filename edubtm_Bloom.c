@@ -0,0 +1,297 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Bloom.c
+ *
+ * Description :
+ *  Many SM_EQ probes and deletes are for keys not in the index, and each of
+ *  them would descend the tree to find nothing. An opened index may keep a
+ *  counting Bloom filter of its keys (see EduBtM_BuildBloomFilter()); a key
+ *  with a zero counter among its BTM_BLOOMHASHES counters is surely not in
+ *  the index, so such a probe or delete is answered without page access.
+ *
+ *  A key is counted when its entry is made and uncounted when its entry
+ *  goes away, so that the filter follows inserts and deletes. Keys which go
+ *  with whole pages (EduBtM_DeleteRange()) and counters stuck at
+ *  BTM_BLOOMCOUNTMAX stay counted; they only make the filter answer fewer
+ *  probes until it is built again.
+ *
+ *  Equal keys are hashed alike: a string key is hashed up to its first NUL,
+ *  as edubtm_VarStringKeyCompare() compares it.
+ *
+ * Exports:
+ *  void edubtm_BloomAdd(BtreeHandle*, KeyValue*)
+ *  void edubtm_BloomRemove(BtreeHandle*, KeyValue*)
+ *  Boolean edubtm_BloomMayContain(BtreeHandle*, KeyValue*)
+ *  Four edubtm_BloomAddLeaves(BtreeHandle*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+void edubtm_BloomCounters(BtreeHandle*, KeyValue*, Four*);
+
+
+/*@ the counter 'c' of the filter 'bloom' */
+#define BLOOM_COUNTER(bloom, c) (((bloom)->counter[(c) >> 1] >> (((c) & 1) << 2)) & 0xF)
+
+
+
+/*@================================
+ * edubtm_BloomAdd()
+ *================================*/
+/*
+ * Function: void edubtm_BloomAdd(BtreeHandle*, KeyValue*)
+ *
+ * Description:
+ *  Count the new key 'kval' of the index in its Bloom filter.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_BloomAdd(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval)          /* IN the new key value */
+{
+    Two                 i;              /* index of a hash */
+    Four                c[BTM_BLOOMHASHES]; /* the counters of the key */
+
+
+    if (handle->bloom.nCounters == 0) return;
+
+    edubtm_BloomCounters(handle, kval, c);
+
+    for (i = 0; i < BTM_BLOOMHASHES; i++)
+        if (BLOOM_COUNTER(&handle->bloom, c[i]) < BTM_BLOOMCOUNTMAX)
+            handle->bloom.counter[c[i] >> 1] += 1 << ((c[i] & 1) << 2);
+
+} /* edubtm_BloomAdd() */
+
+
+
+/*@================================
+ * edubtm_BloomRemove()
+ *================================*/
+/*
+ * Function: void edubtm_BloomRemove(BtreeHandle*, KeyValue*)
+ *
+ * Description:
+ *  Uncount the key 'kval' whose entry has gone away from the index. The
+ *  counters stuck at BTM_BLOOMCOUNTMAX are left as they are.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_BloomRemove(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval)          /* IN the removed key value */
+{
+    Two                 i;              /* index of a hash */
+    Four                n;              /* value of a counter */
+    Four                c[BTM_BLOOMHASHES]; /* the counters of the key */
+
+
+    if (handle->bloom.nCounters == 0) return;
+
+    edubtm_BloomCounters(handle, kval, c);
+
+    for (i = 0; i < BTM_BLOOMHASHES; i++) {
+        n = BLOOM_COUNTER(&handle->bloom, c[i]);
+        if (n > 0 && n < BTM_BLOOMCOUNTMAX)
+            handle->bloom.counter[c[i] >> 1] -= 1 << ((c[i] & 1) << 2);
+    }
+
+} /* edubtm_BloomRemove() */
+
+
+
+/*@================================
+ * edubtm_BloomMayContain()
+ *================================*/
+/*
+ * Function: Boolean edubtm_BloomMayContain(BtreeHandle*, KeyValue*)
+ *
+ * Description:
+ *  Tell whether the key 'kval' may be in the index by its Bloom filter.
+ *  Without a filter, every key may be.
+ *
+ * Returns:
+ *  FALSE if the key is surely not in the index
+ */
+Boolean edubtm_BloomMayContain(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval)          /* IN key value */
+{
+    Two                 i;              /* index of a hash */
+    Four                c[BTM_BLOOMHASHES]; /* the counters of the key */
+
+
+    if (handle->bloom.nCounters == 0) return(TRUE);
+
+    edubtm_BloomCounters(handle, kval, c);
+
+    for (i = 0; i < BTM_BLOOMHASHES; i++)
+        if (BLOOM_COUNTER(&handle->bloom, c[i]) == 0) {
+            handle->bloom.nNegatives++;
+            return(FALSE);
+        }
+
+    return(TRUE);
+
+} /* edubtm_BloomMayContain() */
+
+
+
+/*@================================
+ * edubtm_BloomAddLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_BloomAddLeaves(BtreeHandle*)
+ *
+ * Description:
+ *  Count every key of the index in its emptied Bloom filter, going along
+ *  the leaves from the leftmost one.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_BloomAddLeaves(
+    BtreeHandle         *handle)        /* INOUT opened index */
+{
+    Four                e;              /* error number */
+    Two                 i;              /* slot No. */
+    PageID              pid;            /* the page visited */
+    PageID              next;           /* the page visited next */
+    BtreePage           *apage;         /* buffer of the page visited */
+    KeyValue            kval;           /* a key of a leaf */
+
+
+    memset(handle->bloom.counter, 0, (handle->bloom.nCounters + 1) / 2);
+
+    pid = handle->root;
+    next.volNo = pid.volNo;
+
+    /* down the leftmost children */
+    for (;;) {
+        e = BfM_GetTrain(&pid, (char**)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        if (apage->any.hdr.type & LEAF) break;
+
+        if (!(apage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, &pid, PAGE_BUF);
+
+        next.pageNo = apage->bi.hdr.p0;
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        pid = next;
+    }
+
+    /* and along the leaves */
+    for (;;) {
+        for (i = 0; i < apage->bl.hdr.nSlots; i++) {
+            edubtm_GetLeafObject(&apage->bl, i, &kval, NULL);
+            edubtm_BloomAdd(handle, &kval);
+        }
+
+        next.pageNo = apage->bl.hdr.nextPage;
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        if (next.pageNo == NIL) break;
+
+        pid = next;
+
+        e = BfM_GetTrain(&pid, (char**)&apage, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_BloomAddLeaves() */
+
+
+
+/*@================================
+ * edubtm_BloomCounters()
+ *================================*/
+/*
+ * Function: void edubtm_BloomCounters(BtreeHandle*, KeyValue*, Four*)
+ *
+ * Description:
+ *  Choose the counters of the key 'kval' by double hashing: the two halves
+ *  of the 64-bit FNV-1a hash of the key give the first counter and the
+ *  distance to the next ones.
+ *
+ * Returns:
+ *  None
+ *
+ * Side effects:
+ *  c : the BTM_BLOOMHASHES counters of the key
+ */
+void edubtm_BloomCounters(
+    BtreeHandle         *handle,        /* IN opened index */
+    KeyValue            *kval,          /* IN key value */
+    Four                *c)             /* OUT the counters of the key */
+{
+    Two                 i;              /* index of a byte or of a hash */
+    Two                 start;          /* first byte hashed */
+    Two                 len;            /* # of bytes hashed */
+    UEight_Invariable   hash;           /* hash value of the key */
+    UFour               h1, h2;         /* halves of the hash value */
+
+
+    start = 0;
+    if (handle->keyCompare == edubtm_IntKeyCompare)
+        len = sizeof(Four_Invariable);
+    else if (handle->keyCompare == edubtm_LongLongKeyCompare)
+        len = SM_LONG_LONG_SIZE;
+    else if (handle->keyCompare == edubtm_VarStringKeyCompare) {
+        start = sizeof(Two);
+        for (len = start; len < kval->len && kval->val[len] != 0; len++);
+    }
+    else
+        len = kval->len;
+
+    hash = 14695981039346656037UL;
+    for (i = start; i < len; i++)
+        hash = (hash ^ (unsigned char)kval->val[i]) * 1099511628211UL;
+
+    h1 = (UFour)hash;
+    h2 = (UFour)(hash >> 32) | 1;
+
+    for (i = 0; i < BTM_BLOOMHASHES; i++)
+        c[i] = (h1 + i * h2) % (UFour)handle->bloom.nCounters;
+
+} /* edubtm_BloomCounters() */
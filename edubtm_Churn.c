@@ -0,0 +1,119 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Churn.c
+ *
+ * Description :
+ *  An opened index logs the splits and merges of its leaves. A leaf merged
+ *  shortly after it was splitted, or splitted shortly after it was merged,
+ *  shows that the water marks of the index (see EduBtM_SetWaterMarks()) let
+ *  its pages thrash; EduBtM_GetStatistics() reports how often it happens.
+ *  "Shortly" means within the last BTM_CHURN_WINDOW splits and merges.
+ *
+ * Exports:
+ *  void edubtm_ResetChurn(BtreeHandle*)
+ *  void edubtm_LogChurn(BtreeHandle*, Two, ShortPageID, ShortPageID)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_ResetChurn()
+ *================================*/
+/*
+ * Function: void edubtm_ResetChurn(BtreeHandle*)
+ *
+ * Description:
+ *  Clear the counters and the log of 'handle'.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_ResetChurn(
+    BtreeHandle         *handle)        /* INOUT opened index */
+{
+    memset(&handle->churn, 0, sizeof(BtreeChurn));
+
+} /* edubtm_ResetChurn() */
+
+
+
+/*@================================
+ * edubtm_LogChurn()
+ *================================*/
+/*
+ * Function: void edubtm_LogChurn(BtreeHandle*, Two, ShortPageID, ShortPageID)
+ *
+ * Description:
+ *  Log a split of the leaf 'left' into 'left' and 'right', or a merge of
+ *  'right' into 'left', and count it as churn if the log still has a merge
+ *  into the splitted page, or a split of either merged page.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_LogChurn(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    Two                 kind,           /* IN BTM_CHURN_SPLIT or BTM_CHURN_MERGE */
+    ShortPageID         left,           /* IN the left page */
+    ShortPageID         right)          /* IN the right page */
+{
+    Two                 i;              /* index of an entry of the log */
+    BtreeChurn          *churn;         /* the log of 'handle' */
+
+
+    churn = &handle->churn;
+
+    for (i = 0; i < BTM_CHURN_WINDOW; i++) {
+        if (churn->kind[i] == 0 || churn->kind[i] == kind) continue;
+
+        /* the page freed by a merge may come back as the new page of a split */
+        if (churn->left[i] == left ||
+            (kind == BTM_CHURN_MERGE && (churn->right[i] == left || churn->right[i] == right ||
+                                         churn->left[i] == right))) {
+            if (kind == BTM_CHURN_SPLIT)
+                churn->nSplitsAfterMerge++;
+            else
+                churn->nMergesAfterSplit++;
+            break;
+        }
+    }
+
+    if (kind == BTM_CHURN_SPLIT)
+        churn->nSplits++;
+    else
+        churn->nMerges++;
+
+    churn->kind[churn->next] = kind;
+    churn->left[churn->next] = left;
+    churn->right[churn->next] = right;
+    churn->next = (churn->next + 1) % BTM_CHURN_WINDOW;
+
+} /* edubtm_LogChurn() */
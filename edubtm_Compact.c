@@ -147,23 +147,23 @@ void edubtm_CompactLeafPage(
 
     memcpy(&tpage, apage, PAGESIZE);
 
-    apageDataOffset = 0; // we start at 0 coz we compact data in Data Area
+    apageDataOffset = BL_PREFIX_AREA(apage); /* the page prefix, if any, stays in front */
     for (i = 0; i < tpage.hdr.nSlots; ++i) {
         if (i != slotNo){
-            entry = &(tpage.data[tpage.slot[-i]]);
+            entry = &(tpage.data[BL_SLOT(&tpage, i)]);
             alignedKlen = ALIGNED_LENGTH(entry->klen);
-            len = BTM_LEAFENTRY_FIXED +  alignedKlen + sizeof(ObjectID);
+            len = BTM_LEAFENTRY_FIXED +  alignedKlen + BTM_OBJECTS_LEN(entry->nObjects);
             memcpy(&apage->data[apageDataOffset], entry, len);
-            apage->slot[-i] = apageDataOffset;
+            BL_SLOT(apage, i) = apageDataOffset;
             apageDataOffset += len;
         }
     }
 
     if (slotNo != NIL) {
-        entry = &(tpage.data[tpage.slot[-slotNo]]);
+        entry = &(tpage.data[BL_SLOT(&tpage, slotNo)]);
         alignedKlen = ALIGNED_LENGTH(entry->klen);
-        len = BTM_LEAFENTRY_FIXED +  alignedKlen + sizeof(ObjectID);
-        apage->slot[-slotNo] = apageDataOffset;
+        len = BTM_LEAFENTRY_FIXED +  alignedKlen + BTM_OBJECTS_LEN(entry->nObjects);
+        BL_SLOT(apage, slotNo) = apageDataOffset;
         memcpy(&apage->data[apageDataOffset], entry, len);
         apageDataOffset += len;
     }
@@ -28,9 +28,16 @@
  * Description : 
  *  This file includes two compare routines, one for keys used in Btree Index
  *  and another for ObjectIDs.
+ *  edubtm_KeyCompare() handles any supported key descriptor; the comparators
+ *  specialized for one key layout are selected by EduBtM_OpenIndex().
  *
  * Exports: 
  *  Four edubtm_KeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *  Four edubtm_IntKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *  Four edubtm_LongLongKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *  Four edubtm_VarStringKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *  Four edubtm_NormalizedKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *  Four edubtm_StringCompare(char*, Two, char*, Two)
  *  Four edubtm_ObjectIdComp(ObjectID*, ObjectID*)
  */
 
@@ -53,6 +60,7 @@
  *
  *  Compare key1 with key2.
  *  key1 and key2 are described by the given parameter "kdesc".
+ *  Keys of several parts are compared in their normalized form.
  *
  * Returns:
  *  result of omparison (positive numbers)
@@ -62,73 +70,194 @@
  *
  * Note:
  *  We assume that the input data are all valid.
- *  User should check the KeyDesc is valid.
+ *  User should check the KeyDesc is valid; EduBtM_OpenIndex() does it.
  */
 Four edubtm_KeyCompare(
     KeyDesc                     *kdesc,		/* IN key descriptor for key1 and key2 */
     KeyValue                    *key1,		/* IN the first key value */
     KeyValue                    *key2)		/* IN the second key value */
 {
-    register unsigned char      *left;          /* left key value */
-    register unsigned char      *right;         /* right key value */
-    Two                         i;              /* index for # of key parts */
-    Two                         j;              /* temporary variable */
-    Two                         kpartSize;      /* size of the current kpart */
-    Two                         len1, len2;	/* string length */
-    Two_Invariable              s1, s2;         /* 2-byte short values */
+    /*  Compare two key values given by parameters, and return the comparison result */
+    if (kdesc->nparts > 1)
+        return(edubtm_NormalizedKeyCompare(kdesc, key1, key2));
+    else if (kdesc->kpart[0].type == SM_VARSTRING)
+        return(edubtm_VarStringKeyCompare(kdesc, key1, key2));
+    else if (kdesc->kpart[0].type == SM_INT)
+        return(edubtm_IntKeyCompare(kdesc, key1, key2));
+    else if (kdesc->kpart[0].type == SM_LONG_LONG)
+        return(edubtm_LongLongKeyCompare(kdesc, key1, key2));
+
+    ERR(eNOTSUPPORTED_EDUBTM);
+    
+}   /* edubtm_KeyCompare() */
+
+
+
+/*@================================
+ * edubtm_IntKeyCompare()
+ *================================*/
+/*
+ * Function: Four edubtm_IntKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Compare key1 with key2 of a key descriptor made of one SM_INT part.
+ *
+ * Returns:
+ *  result of comparison: EQUAL, GREAT or LESS
+ */
+Four edubtm_IntKeyCompare(
+    KeyDesc                     *kdesc,		/* IN key descriptor for key1 and key2 */
+    KeyValue                    *key1,		/* IN the first key value */
+    KeyValue                    *key2)		/* IN the second key value */
+{
     Four_Invariable             i1, i2;         /* 4-byte int values */
-    Four_Invariable             l1, l2;         /* 4-byte long values */
+
+
+    i1 = *(Four_Invariable*)key1->val;
+    i2 = *(Four_Invariable*)key2->val;
+
+    if (i1 == i2) return(EQUAL);
+    return((i1 > i2) ? GREAT : LESS);
+
+}   /* edubtm_IntKeyCompare() */
+
+
+
+/*@================================
+ * edubtm_LongLongKeyCompare()
+ *================================*/
+/*
+ * Function: Four edubtm_LongLongKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Compare key1 with key2 of a key descriptor made of one SM_LONG_LONG part.
+ *
+ * Returns:
+ *  result of comparison: EQUAL, GREAT or LESS
+ */
+Four edubtm_LongLongKeyCompare(
+    KeyDesc                     *kdesc,		/* IN key descriptor for key1 and key2 */
+    KeyValue                    *key1,		/* IN the first key value */
+    KeyValue                    *key2)		/* IN the second key value */
+{
     Eight_Invariable            ll1, ll2;       /* 8-byte long long values */
-    float                       f1, f2;         /* float values */
-    double                      d1, d2;		/* double values */
-    PageID                      pid1, pid2;	/* PageID values */
-    OID                         oid1, oid2;     /* OID values */
-    
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+
+    /* entries are only ALIGN-aligned, so an 8-byte key may straddle it */
+    memcpy(&ll1, key1->val, SM_LONG_LONG_SIZE);
+    memcpy(&ll2, key2->val, SM_LONG_LONG_SIZE);
+
+    if (ll1 == ll2) return(EQUAL);
+    return((ll1 > ll2) ? GREAT : LESS);
+
+}   /* edubtm_LongLongKeyCompare() */
+
+
+
+/*@================================
+ * edubtm_VarStringKeyCompare()
+ *================================*/
+/*
+ * Function: Four edubtm_VarStringKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Compare key1 with key2 of a key descriptor made of one SM_VARSTRING part.
+ *  The string starts after its 2-byte length and is compared up to the
+ *  first NUL; longer keys are greater when all shared bytes are equal.
+ *
+ * Returns:
+ *  result of comparison: EQUAL, GREAT or LESS
+ */
+Four edubtm_VarStringKeyCompare(
+    KeyDesc                     *kdesc,		/* IN key descriptor for key1 and key2 */
+    KeyValue                    *key1,		/* IN the first key value */
+    KeyValue                    *key2)		/* IN the second key value */
+{
+    register unsigned char      *left;          /* left key value */
+    register unsigned char      *right;         /* right key value */
+    Two                         i;              /* index of a byte */
+    Two                         len;            /* # of bytes to be compared */
+
+
+    left = (unsigned char*)key1->val;
+    right = (unsigned char*)key2->val;
+    len = MIN(key1->len, key2->len);
+
+    for (i = 2; i < len; i++) {
+        if (left[i] == 0 && right[i] == 0) return(EQUAL);
+        if (left[i] != right[i]) return(((char)left[i] < (char)right[i]) ? LESS : GREAT);
     }
-    /*  Compare two key values given by parameters, and return the comparison result */
-    if (kdesc->flag==KEYFLAG_UNIQUE){
-        if (kdesc->kpart[0].type == SM_VARSTRING) {
-            len1 = key1->len;
-            len2 = key2->len;
-
-            for (i=2; i< MIN(len1, len2); i++) {
-                if (key1->val[i] == 0 && key2->val[i] == 0) {
-                    return EQUAL;
-                } else if(key1->val[i] < key2->val[i]) {
-                    return LESS;
-                } else if(key1->val[i] > key2->val[i]) {
-                    return GREAT;
-                }
-            }
-
-            if (len1 == len2) {
-                return EQUAL;
-            } else if(len1 > len2) {
-                return GREAT;
-            } else if(len1 < len2) {
-                return LESS;
-            }
-
-        }
-        else if (kdesc->kpart[0].type == SM_INT) {
-            i1 = *(Four_Invariable*)key1->val;
-            i2 = *(Four_Invariable*)key2->val;
-
-            if (i1 == i2) {
-                return EQUAL;
-            } else if(i1 > i2) {
-                return GREAT;
-            } else if(i1 < i2) {
-                return LESS;
-            }
-        }
+
+    if (key1->len == key2->len) return(EQUAL);
+    return((key1->len > key2->len) ? GREAT : LESS);
+
+}   /* edubtm_VarStringKeyCompare() */
+
+
+
+/*@================================
+ * edubtm_NormalizedKeyCompare()
+ *================================*/
+/*
+ * Function: Four edubtm_NormalizedKeyCompare(KeyDesc*, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Compare key1 with key2 normalized by edubtm_NormalizeKey(), i.e. keys of
+ *  several parts. The bytes are compared as unsigned; longer keys are
+ *  greater when all shared bytes are equal.
+ *
+ * Returns:
+ *  result of comparison: EQUAL, GREAT or LESS
+ */
+Four edubtm_NormalizedKeyCompare(
+    KeyDesc                     *kdesc,		/* IN key descriptor for key1 and key2 */
+    KeyValue                    *key1,		/* IN the first key value */
+    KeyValue                    *key2)		/* IN the second key value */
+{
+    int                         cmp;            /* result of memcmp() */
+
+
+    cmp = memcmp(key1->val, key2->val, MIN(key1->len, key2->len));
+
+    if (cmp == 0) cmp = key1->len - key2->len;
+    if (cmp == 0) return(EQUAL);
+    return((cmp > 0) ? GREAT : LESS);
+
+}   /* edubtm_NormalizedKeyCompare() */
+
+
+
+/*@================================
+ * edubtm_StringCompare()
+ *================================*/
+/*
+ * Function: Four edubtm_StringCompare(char*, Two, char*, Two)
+ *
+ * Description:
+ *  Compare two strings given by their bytes and lengths in the order of
+ *  edubtm_VarStringKeyCompare(). Used on the parts of keys after a common
+ *  prefix, e.g. the suffixes stored in a prefix compressed leaf page.
+ *
+ * Returns:
+ *  result of comparison: EQUAL, GREAT or LESS
+ */
+Four edubtm_StringCompare(
+    char                        *str1,          /* IN the first string */
+    Two                         len1,           /* IN length of the first string */
+    char                        *str2,          /* IN the second string */
+    Two                         len2)           /* IN length of the second string */
+{
+    Two                         i;              /* index of a byte */
+    Two                         len;            /* # of bytes to be compared */
+
+
+    len = MIN(len1, len2);
+
+    for (i = 0; i < len; i++) {
+        if (str1[i] != str2[i]) return((str1[i] < str2[i]) ? LESS : GREAT);
     }
-    else ERR(eNOTSUPPORTED_EDUBTM);
-    
-}   /* edubtm_KeyCompare() */
+
+    if (len1 == len2) return(EQUAL);
+    return((len1 > len2) ? GREAT : LESS);
+
+}   /* edubtm_StringCompare() */
@@ -26,20 +26,19 @@
  * Module: edubtm_Delete.c
  *
  * Description : 
- *  This function edubtm_Delete(...) recursively calls itself until the type
- *  of root page becomes LEAF.  If the root page is an internal page, it
- *  may get the proper child page using the binary search routine and then
- *  recursively calls itself using the child as a root page. If the filled
- *  area of the child page is less than half of the page, it should merge
- *  or redistribute using the given root, and set the flag 'f' according to
- *  the result status of the given root page.
+ *  This function edubtm_Delete(...) descends from the root page to the leaf
+ *  for the given key using the binary search routine, keeping the internal
+ *  pages it passes on a path.  Walking back up the path, if the filled area
+ *  of a child page is less than half of the page, its parent should merge or
+ *  redistribute it, and the flag 'f' is set according to the result status
+ *  of the given root page.
  *
  *  If the root page is a leaf page , it find out the correct node (entry)
  *  using the binary search routine.  If the entry is normal,  it simply
  *  delete the ObjectID or the entry when the # of ObjectIDs becomes zero.
  *  The entry, however, is not normal, that is, if the overflow page is used,
- *  the special routine btm_DeleteOverflow(...) should be called. The # of
- *  ObjectIDs will be returned by the result of the btm_DeleteOverflow(...),
+ *  the special routine edubtm_DeleteOverflow(...) should be called. The # of
+ *  ObjectIDs will be returned by the result of the edubtm_DeleteOverflow(...),
  *  if the total # of ObjectIDs is less than 1/4 of the page and the ObjectIDs
  *  in the overflow page should be moved to the leaf page. (This process may
  *  has a complicate problem which the leaf page may be splitted in spite of
@@ -49,7 +48,7 @@
  *  page may be splitted.
  *
  * Exports:
- *  Four edubtm_Delete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *  Four edubtm_Delete(BtreeHandle*, PageID*, KeyValue*, ObjectID*, Boolean,
  *                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
  *
  */
@@ -59,12 +58,11 @@
 #include "EduBtM_common.h"
 #include "Util.h"
 #include "BfM.h"
-#include "OM_Internal.h"	/* for "SlottedPage" including catalog object */
 #include "EduBtM_Internal.h"
 
 
 /*@ Internal Function Prototypes */
-Four edubtm_DeleteLeaf(PhysicalFileID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*, ObjectID*,
+Four edubtm_DeleteLeaf(PageID*, BtreeLeaf*, BtreeHandle*, KeyValue*, ObjectID*, Boolean,
 		    Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
 
 
@@ -73,17 +71,28 @@ Four edubtm_DeleteLeaf(PhysicalFileID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*
  * edubtm_Delete()
  *================================*/
 /*
- * Function: Four edubtm_Delete(ObjectID*, PageID*, KeyDesc*, KeyValue*,
- *                           ObjectID*, Boolean*, Boolean*, InternalItem*)
+ * Function: Four edubtm_Delete(BtreeHandle*, PageID*, KeyValue*, ObjectID*,
+ *                           Boolean, Boolean*, Boolean*, InternalItem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
  *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
  *
+ *  The internal pages passed are kept on a path (see edubtm_Path.c); the
+ *  pages above one which neither underflows nor splits by any change of its
+ *  child are freed on the way down. Pinned pages are read from 'handle'
+ *  (see edubtm_Pin.c).
+ *
+ *  If 'byKey' is TRUE the key of a unique index is deleted with whatever
+ *  ObjectID it has, which is returned in 'oid'. A key which is not found is
+ *  then an expected result: eNOTFOUND_BTM is returned without being
+ *  reported, and no page has been changed.
  *
  * Returns:
  *  error code
+ *    eNOTFOUND_BTM
  *    eBADBTREEPAGE_BTM
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
  *    some errors caused by function calls
  *
  * Side effects:
@@ -92,11 +101,11 @@ Four edubtm_DeleteLeaf(PhysicalFileID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*
  *  item : The internal item to be inserted into the parent if 'h' is TRUE.
  */
 Four edubtm_Delete(
-    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreeHandle                 *handle,        /* IN opened index */
     PageID                      *root,          /* IN root page */
-    KeyDesc                     *kdesc,         /* IN a key descriptor */
     KeyValue                    *kval,          /* IN key value */
-    ObjectID                    *oid,           /* IN Object IDentifier which will be deleted */
+    ObjectID                    *oid,           /* INOUT Object IDentifier which will be deleted */
+    Boolean                     byKey,          /* IN TRUE if deleted by the key only */
     Boolean                     *f,             /* OUT whether the root page is half full */
     Boolean                     *h,             /* OUT TRUE if it is spiltted. */
     InternalItem                *item,          /* OUT The internal item to be returned */
@@ -107,80 +116,114 @@ Four edubtm_Delete(
     Boolean                     lf;             /* TRUE if a page is not half full */
     Boolean                     lh;             /* TRUE if a page is splitted */
     Two                         idx;            /* the index by the binary search */
-    PageID                      child;          /* a child page when the root is an internal page */
+    Two                         level;          /* level of a page on the path */
+    PageID                      pid;            /* the page visited */
+    PageID                      child;          /* the child of a page on the path */
     KeyValue                    tKey;           /* a temporary key */
-    BtreePage                   *rpage;         /* for a root page */
+    BtreePage                   *rpage;         /* the page visited */
+    BtreeInternal               *ipage;         /* a page on the path */
     InternalItem                litem;          /* local internal item */
     btm_InternalEntry           *iEntry;        /* an internal entry */
-    SlottedPage                 *catPage;       /* buffer page containing the catalog object */
-    sm_CatOverlayForBtree       *catEntry;      /* pointer to Btree file catalog information */
-    PhysicalFileID              pFid;           /* B+-tree file's FileID */
+    BtreePath                   path;           /* the internal pages passed */
+    Two                         slot;           /* slot of the page visited if it is pinned, else NIL */
   
 
-    /* Error check whether using not supported functionality by EduBtM */
-	int i;
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
 
         
     *h = *f = FALSE;
-    e = BfM_GetTrain(catObjForFile, &catPage, PAGE_BUF);
-    if(e<0) ERR(e);
-    
-    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
-    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
 
-    e = BfM_FreeTrain(catObjForFile, PAGE_BUF);
-    if(e < 0) ERR( e );
+    path.height = 0;
+    pid = *root;
 
-    e = BfM_GetTrain(root, &rpage, PAGE_BUF);
-    if(e < 0) ERR( e );
+    /*@ descend to the leaf page holding the key */
+    for (;;) {
+        e = edubtm_FixPage(handle, &pid, path.height, &rpage, &slot);
+        if (e < 0) ERRBPATH(e, &path);
 
-    if (rpage->any.hdr.type & LEAF) {
-        e = edubtm_DeleteLeaf(&pFid, root, rpage, kdesc, kval, oid, f, h, item, dlPool, dlHead);
-        if(e < 0) ERR( e );
+        if (rpage->any.hdr.type & LEAF) break;
 
-        e = BfM_SetDirty(root, PAGE_BUF);
-        if(e < 0) ERR( e );
-    }
+        if (!(rpage->any.hdr.type & INTERNAL)) {
+            (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+            ERRBPATH(eBADBTREEPAGE_BTM, &path);
+        }
 
-    if (rpage->any.hdr.type & INTERNAL) {
-        
-        edubtm_BinarySearchInternal(rpage, kdesc, kval, &idx);
+        edubtm_BinarySearchInternal(&rpage->bi, handle, kval, &idx);
+
+        e = edubtm_PushPath(&path, &pid, rpage, slot != NIL, idx);
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&pid, slot != NIL);
+            ERRBPATH(e, &path);
+        }
+
+        /* an underflow or a split below stops at this page, so the pages above are not needed */
+        if (BTM_SAFE_FOR_DELETE(&rpage->bi)) {
+            e = edubtm_ReleaseAncestors(&path);
+            if (e < 0) ERRBPATH(e, &path);
+        }
 
         if (idx == -1) {
-            child.volNo = root->volNo;
-            child.pageNo = rpage->bi.hdr.p0; 
+            pid.pageNo = rpage->bi.hdr.p0; 
         } else {
-            iEntry = &rpage->bi.data[rpage->bi.slot[-idx]];
-            child.volNo = root->volNo;
-            child.pageNo = iEntry->spid;
+            iEntry = (btm_InternalEntry*)&rpage->bi.data[rpage->bi.slot[-idx]];
+            pid.pageNo = iEntry->spid;
         }
+    }
 
-        e = edubtm_Delete(catObjForFile, &child, kdesc, kval, oid, &lf, &lh, &litem, dlPool, dlHead);
-        if (e < 0) ERR( e );
-
-        if (lf == TRUE) {
-            e = btm_Underflow(&pFid, rpage, &child, idx, f, &lh, &litem, dlPool, dlHead);
-            if(e < 0) ERR( e );            
-            if(lh == TRUE){
-                tKey.len = litem.klen;
-                memcpy(tKey.val, litem.kval, litem.klen);
-                edubtm_BinarySearchInternal(rpage, kdesc, &tKey, &idx);
-                e = edubtm_InsertInternal(catObjForFile, rpage, &litem, idx, h, item);
-                if(e < 0) ERR( e );
-                *h = TRUE;
-            }
+    e = edubtm_DeleteLeaf(&pid, &rpage->bl, handle, kval, oid, byKey, &lf, &lh, &litem, dlPool, dlHead);
+    if (e == eNOTFOUND_BTM && byKey) {
+        (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+        (Four) edubtm_FreePath(&path);
+        return(e);
+    }
+    if (e < 0) {
+        (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+        ERRBPATH(e, &path);
+    }
 
-            e = BfM_SetDirty(root, PAGE_BUF);
-            if(e < 0) ERR( e );
-        } 
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERRBPATH(e, &path);
+
+    /*@ walk up the path while the children are splitted or not half full */
+    for (level = path.height - 1; (lh || lf) && level >= 0; level--) {
+        /* the child is merged or redistributed unfixed */
+        if (level + 1 < path.height && path.page[level + 1] != NULL) {
+            e = edubtm_UnfixPage(&path.pid[level + 1], path.pinned[level + 1]);
+            path.page[level + 1] = NULL;
+            if (e < 0) ERRBPATH(e, &path);
+        }
+        child = (level + 1 < path.height) ? path.pid[level + 1] : pid;
+
+        e = edubtm_FixPathPage(&path, level);
+        if (e < 0) ERRBPATH(e, &path);
+        ipage = &path.page[level]->bi;
+
+        /* the child was splitted by a separator which no longer fits in it */
+        if (lh) {
+            tKey.len = litem.klen;
+            memcpy(tKey.val, litem.kval, litem.klen);
+            edubtm_BinarySearchInternal(ipage, handle, &tKey, &idx);
+            lf = FALSE;
+            e = edubtm_InsertInternal(&handle->catObjForFile, ipage, &litem, idx, FALSE, &lh, item);
+            if (e < 0) ERRBPATH(e, &path);
+        }
+        else {
+            e = edubtm_Underflow(handle, ipage, &child, path.idx[level], &lf, &lh, item, dlPool, dlHead);
+            if (e < 0) ERRBPATH(e, &path);
+        }
+        litem = *item;
+
+        e = BfM_SetDirty(&path.pid[level], PAGE_BUF);
+        if (e < 0) ERRBPATH(e, &path);
+    }
+
+    /* the flags of the root page itself */
+    if (level < 0) {
+        *f = lf;
+        *h = lh;
+        if (lh) *item = litem;
     }
 
-    e = BfM_FreeTrain(root, PAGE_BUF);
+    e = edubtm_FreePath(&path);
     if (e < 0) ERR( e );
 
     return(eNOERROR);
@@ -193,14 +236,16 @@ Four edubtm_Delete(
  * edubtm_DeleteLeaf()
  *================================*/
 /*
- * Function: Four edubtm_DeleteLeaf(PhysicalFileID*, PageID*, BtreeLeaf*, KeyDesc*,
- *                               KeyValue*, ObjectID*, Boolean*, Boolean*,
- *                               InternalItem*, Pool*, DeallocListElem*)
+ * Function: Four edubtm_DeleteLeaf(PageID*, BtreeLeaf*, BtreeHandle*,
+ *                               KeyValue*, ObjectID*, Boolean, Boolean*,
+ *                               Boolean*, InternalItem*, Pool*, DeallocListElem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
  *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
  *
+ *  If 'byKey' is TRUE the only ObjectID of the key is deleted and returned
+ *  in 'oid'; a missing key is then not reported as an error.
  *
  * Returns:
  *  Error code
@@ -213,12 +258,12 @@ Four edubtm_Delete(
  *  item : The internal item to be inserted into the parent if 'h' is TRUE.
  */ 
 Four edubtm_DeleteLeaf(
-    PhysicalFileID              *pFid,          /* IN FileID of the Btree file */
     PageID                      *pid,           /* IN PageID of the leaf page */
     BtreeLeaf                   *apage,         /* INOUT buffer for the Leaf Page */
-    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    BtreeHandle                 *handle,        /* IN opened index */
     KeyValue                    *kval,          /* IN key value */
-    ObjectID                    *oid,           /* IN ObjectID which will be deleted */
+    ObjectID                    *oid,           /* INOUT ObjectID which will be deleted */
+    Boolean                     byKey,          /* IN TRUE if deleted by the key only */
     Boolean                     *f,             /* OUT whether the root page is half full */
     Boolean                     *h,             /* OUT TRUE if it is spiltted. */
     InternalItem                *item,          /* OUT The internal item to be returned */
@@ -227,7 +272,8 @@ Four edubtm_DeleteLeaf(
 {
     Four                        e;              /* error number */
     Two                         i;              /* index */
-    Two                         of;             /* # of ObjectIDs of an overflow page when less than 1/4 */
+    Two                         of;             /* max # of ObjectIDs coming back from overflow pages */
+    Two                         nLeft;          /* # of ObjectIDs left in the entry, NIL in overflow pages */
     Two                         idx;            /* the index by the binary search */
     ObjectID                    tOid;           /* a Object IDentifier */
     BtreeOverflow               *opage;         /* for a overflow page */
@@ -241,54 +287,107 @@ Four edubtm_DeleteLeaf(
     Two                         alignedKlen;    /* aligned length of the key length */
     PageID                      ovPid;          /* overflow page's PageID */
     DeallocListElem             *dlElem;        /* an element of the dealloc list */
+    ObjectID                    oids[OVERFLOW_SPLIT/OBJECTID_SIZE]; /* ObjectIDs coming back from overflow pages */
+
 
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
+    *h = *f = FALSE;
+
+    found = edubtm_BinarySearchLeaf(apage, handle, kval, &idx); 
+    if (!found) {
+        if (byKey) return(eNOTFOUND_BTM);
+        ERR(eNOTFOUND_BTM);
     }
 
-    found = edubtm_BinarySearchLeaf(apage, kdesc, kval, &idx); 
-    if (found) {
-        lEntryOffset = apage->slot[-idx];
-        lEntry = &apage->data[lEntryOffset];
+    BTM_LEAF_CHANGED(handle, pid->pageNo);
+
+    if (apage->hdr.denseKeyLen != 0) {
+        if (byKey) *oid = *BL_DENSE_OID(apage, idx);
+        else if (btm_ObjectIdComp(oid, BL_DENSE_OID(apage, idx)) != EQUAL) ERR(eNOTFOUND_BTM);
+
+        edubtm_DeleteDenseEntry(apage, idx);
+        edubtm_BloomRemove(handle, kval);
+    }
+    else {
+        lEntryOffset = BL_SLOT(apage, idx);
+        lEntry = (btm_LeafEntry*)&apage->data[lEntryOffset];
 
         alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-        oidArray = &lEntry->kval[alignedKlen];
-        tOid = *oidArray;
-        entryLen = sizeof(Two) + sizeof(Two) + alignedKlen + sizeof(ObjectID);
-        // on vérifie que c'est bien les deux mêmes objets
-        if (btm_ObjectIdComp(oid, &tOid) == EQUAL) { 
-            /*Compact the slot array so that there is no empty slot deleted in the middle of the slot array.*/
-            for(i = idx + 1; i < apage->hdr.nSlots;++i){
-                apage->slot[-i+1] = apage->slot[-i];
+        oidArray = (ObjectID*)BTM_LEAFENTRY_OBJECTS(lEntry);
+        entryLen = BTM_LEAFENTRY_FIXED + alignedKlen + BTM_OBJECTS_LEN(lEntry->nObjects);
+
+        if (lEntry->nObjects == NIL) {
+            /*
+             * The ObjectIDs come back to the entry when they fit in half of
+             * OVERFLOW_SPLIT, so that an entry does not move back and forth,
+             * and in the free space of the page.
+             */
+            MAKE_PAGEID(ovPid, pid->volNo, *(ShortPageID*)oidArray);
+            of = MIN((OVERFLOW_SPLIT / 2 - BTM_LEAFENTRY_FIXED - alignedKlen) / (CONSTANT_CASTING_TYPE)OBJECTID_SIZE,
+                     (BL_FREE(apage) + (CONSTANT_CASTING_TYPE)sizeof(ShortPageID)) / (CONSTANT_CASTING_TYPE)OBJECTID_SIZE);
+
+            e = edubtm_DeleteOverflow(&ovPid, oid, of, oids, &nLeft, dlPool, dlHead);
+            if (e < 0) ERR(e);
+
+            if (nLeft == NIL)
+                *(ShortPageID*)oidArray = ovPid.pageNo;
+            else if (nLeft > 0) {
+                newLen = BTM_LEAFENTRY_FIXED + alignedKlen + BTM_OBJECTS_LEN(nLeft);
+
+                if (lEntryOffset + entryLen != apage->hdr.free || BL_CFREE(apage) < newLen - entryLen) {
+                    edubtm_CompactLeafPage(apage, idx);
+                    lEntry = (btm_LeafEntry*)&apage->data[BL_SLOT(apage, idx)];
+                }
+
+                lEntry->nObjects = nLeft;
+                memcpy(BTM_LEAFENTRY_OBJECTS(lEntry), oids, nLeft * OBJECTID_SIZE);
+                apage->hdr.free += newLen - entryLen;
             }
+        }
+        else {
+            /* an entry of a unique index has one ObjectID */
+            if (byKey) {
+                *oid = oidArray[0];
+                oidArrayElemNo = 0;
+            }
+            else if (!btm_BinarySearchOidArray(oidArray, oid, lEntry->nObjects, &oidArrayElemNo)) ERR(eNOTFOUND_BTM);
+
+            nLeft = lEntry->nObjects - 1;
+            if (nLeft > 0) {
+                memmove(&oidArray[oidArrayElemNo], &oidArray[oidArrayElemNo + 1],
+                        (nLeft - oidArrayElemNo) * OBJECTID_SIZE);
+                lEntry->nObjects = nLeft;
+
+                if (lEntryOffset + entryLen == apage->hdr.free)
+                    apage->hdr.free -= OBJECTID_SIZE;
+                else
+                    apage->hdr.unused += OBJECTID_SIZE;
+            }
+        }
+
+        /* The entry goes away with its last ObjectID. */
+        if (nLeft == 0) {
+            /* Compact the slot array so that there is no empty slot in the middle of it. */
+            memmove(BL_SLOTPTR(apage, apage->hdr.nSlots - 2), BL_SLOTPTR(apage, apage->hdr.nSlots - 1),
+                    (apage->hdr.nSlots - 1 - idx) * BL_SLOTSIZE(apage));
             apage->hdr.nSlots--;
-            if(lEntryOffset + entryLen == apage->hdr.free) {
+
+            if (lEntryOffset + entryLen == apage->hdr.free)
                 apage->hdr.free -= entryLen;
-            } else {
+            else
                 apage->hdr.unused += entryLen;
-            }
-        }
-        else {
-            err(eNOTFOUND_BTM);
+
+            edubtm_BloomRemove(handle, kval);
         }
     }
-    else {
-        err(eNOTFOUND_BTM);
-    }
-    /*If underflow has occurred in the leaf page (size of the free area of the data area of the page > (size of the total data area of the page / 2)), set the out parameter f to
-    TRUE.*/
-    if(BL_FREE(apage) > BL_HALF) {
+
+    /* Underflow: less than the low water mark of the data area is used. */
+    if (BTM_LEAF_UNDERFLOW(handle, apage))
         *f = TRUE;
-    }
-    else {
-        *f = FALSE;
-    }
+
     e = BfM_SetDirty(pid, PAGE_BUF);
     if (e<0) ERR(e);
+
     return(eNOERROR);
     
 } /* edubtm_DeleteLeaf() */
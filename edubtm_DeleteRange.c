@@ -0,0 +1,466 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_DeleteRange.c
+ *
+ * Description :
+ *  Delete all keys in a range by whole pages. The deletion runs in two
+ *  passes over the two paths from the root to the leaves holding the first
+ *  and the last key of the range:
+ *
+ *  1) edubtm_SpliceRange() trims the entries of the range out of the two
+ *     boundary leaves and frees, with edubtm_FreePages(), every subtree
+ *     lying between the two paths. A boundary page left empty is freed as
+ *     well. The leaf list is then linked across the freed leaves by
+ *     edubtm_LinkLeaves().
+ *
+ *  2) edubtm_RebalanceRange() descends the two paths again and merges or
+ *     redistributes the pages which underflow, bottom up, as a deletion of
+ *     a single key does. No other page is visited.
+ *
+ * Exports:
+ *  Four edubtm_SpliceRange(BtreeHandle*, PhysicalFileID*, PageID*, KeyValue*, KeyValue*,
+ *                          Boolean*, ShortPageID*, ShortPageID*, Boolean*, Pool*, DeallocListElem*)
+ *  Four edubtm_LinkLeaves(VolID, ShortPageID, ShortPageID)
+ *  Four edubtm_RebalanceRange(BtreeHandle*, PageID*, KeyValue*, KeyValue*,
+ *                             Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_TrimLeaf(BtreeHandle*, PageID*, BtreeLeaf*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
+void edubtm_RemoveChild(BtreeInternal*, Two);
+
+
+
+/*@================================
+ * edubtm_SpliceRange()
+ *================================*/
+/*
+ * Function: Four edubtm_SpliceRange(BtreeHandle*, PhysicalFileID*, PageID*, KeyValue*, KeyValue*,
+ *                                  Boolean*, ShortPageID*, ShortPageID*, Boolean*,
+ *                                  Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete the keys from 'start' to 'stop' inclusive from the subtree of
+ *  'pid' without rebalancing. In an internal page the children between the
+ *  child of 'start' and the child of 'stop' hold only keys of the range;
+ *  their subtrees are freed and their entries are deleted. The two boundary
+ *  children are spliced recursively, and deleted too if they become empty.
+ *
+ *  The leaves reached are the boundary leaves, the one of 'start' first.
+ *  'left' is set at the first of them to the leaf before the deleted ones,
+ *  and 'right' at each of them to the leaf after the deleted ones; the
+ *  caller links the two by edubtm_LinkLeaves() once 'visited' is TRUE.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  empty : TRUE if the page is freed because no key is left in it. The root
+ *          is not freed; it becomes an empty leaf instead.
+ */
+Four edubtm_SpliceRange(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PhysicalFileID              *pFid,          /* IN FileID of the Btree file */
+    PageID                      *pid,           /* IN root of the subtree */
+    KeyValue                    *start,         /* IN first key of the range */
+    KeyValue                    *stop,          /* IN last key of the range */
+    Boolean                     *empty,         /* OUT whether the page is freed */
+    ShortPageID                 *left,          /* INOUT leaf before the deleted leaves */
+    ShortPageID                 *right,         /* INOUT leaf after the deleted leaves */
+    Boolean                     *visited,       /* INOUT whether a boundary leaf is reached */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* slot No. */
+    Two                         a;              /* slot of the child of 'start' */
+    Two                         b;              /* slot of the child of 'stop' */
+    Boolean                     lempty;         /* whether a child is freed */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* buffer of the page */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    *empty = FALSE;
+
+    e = BfM_GetTrain(pid, (char**)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (apage->any.hdr.type & LEAF) {
+        e = edubtm_TrimLeaf(handle, pid, &apage->bl, start, stop, dlPool, dlHead);
+        if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+        *empty = (apage->bl.hdr.nSlots == 0 && !(apage->any.hdr.type & ROOT));
+
+        if (!*visited) *left = (*empty) ? apage->bl.hdr.prevPage : pid->pageNo;
+        *right = (*empty) ? apage->bl.hdr.nextPage : pid->pageNo;
+        *visited = TRUE;
+    }
+    else if (apage->any.hdr.type & INTERNAL) {
+        edubtm_BinarySearchInternal(&apage->bi, handle, start, &a);
+        edubtm_BinarySearchInternal(&apage->bi, handle, stop, &b);
+
+        /*@ free the subtrees between the two paths */
+        child.volNo = pid->volNo;
+        for (i = b - 1; i > a; i--) {
+            iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-i]];
+            child.pageNo = iEntry->spid;
+
+            e = edubtm_FreePages(pFid, &child, dlPool, dlHead);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+            edubtm_DeleteInternalEntry(&apage->bi, i);
+        }
+        if (b > a) b = a + 1;
+
+        /*@ splice the boundary children, the one of 'start' first */
+        for (i = a; i <= b; i++) {
+            if (i == -1)
+                child.pageNo = apage->bi.hdr.p0;
+            else {
+                iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-i]];
+                child.pageNo = iEntry->spid;
+            }
+
+            e = edubtm_SpliceRange(handle, pFid, &child, start, stop, &lempty, left, right, visited, dlPool, dlHead);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+            if (lempty) {
+                /* no key is left in the child */
+                if (apage->bi.hdr.nSlots == 0)
+                    *empty = TRUE;
+                else {
+                    edubtm_RemoveChild(&apage->bi, i);
+                    i--;
+                    b--;
+                }
+            }
+        }
+
+        /* the root stays; it becomes an empty leaf */
+        if (*empty && (apage->any.hdr.type & ROOT)) {
+            *empty = FALSE;
+
+            e = edubtm_InitLeaf(pid, TRUE, FALSE);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
+        }
+    }
+    else
+        ERRB1(eBADBTREEPAGE_BTM, pid, PAGE_BUF);
+
+    if (*empty) {
+        e = edubtm_FreePage(pid, apage, dlPool, dlHead);
+        if (e < 0) ERRB1(e, pid, PAGE_BUF);
+    }
+
+    e = BfM_SetDirty(pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_SpliceRange() */
+
+
+
+/*@================================
+ * edubtm_TrimLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_TrimLeaf(BtreeHandle*, PageID*, BtreeLeaf*, KeyValue*, KeyValue*,
+ *                               Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete the entries whose keys are from 'start' to 'stop' inclusive from
+ *  a leaf page, together with their overflow pages. The page is rebuilt in
+ *  its own format from the entries left.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_TrimLeaf(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *pid,           /* IN the leaf page */
+    BtreeLeaf                   *page,          /* INOUT buffer of the leaf page */
+    KeyValue                    *start,         /* IN first key of the range */
+    KeyValue                    *stop,          /* IN last key of the range */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of an entry */
+    Two                         n;              /* # of entries of the page */
+    Two                         nLeft;          /* # of entries left */
+    Four                        format;         /* format of the page */
+    KeyValue                    key;            /* key of an entry */
+    PageID                      ovPid;          /* the first overflow page of an entry */
+    BtreeLeaf                   tpage;          /* a copy of the page */
+    LeafEntryRef                refs[BL_MAXENTRIES+1]; /* entries of the page */
+
+
+    format = BTM_LEAF_FORMAT(handle, page);
+
+    memcpy(&tpage, page, PAGESIZE);
+    n = edubtm_GetLeafEntryRefs(&tpage, refs);
+
+    for (i = nLeft = 0; i < n; i++) {
+        edubtm_GetLeafEntryRefKey(&refs[i], &key);
+
+        if (BTM_KEYCOMPARE(handle, &key, start) == LESS || BTM_KEYCOMPARE(handle, &key, stop) == GREATER)
+            refs[nLeft++] = refs[i];
+        else if (refs[i].entry != NULL && refs[i].entry->nObjects == NIL) {
+            MAKE_PAGEID(ovPid, pid->volNo, *(ShortPageID*)BTM_LEAFENTRY_OBJECTS(refs[i].entry));
+
+            e = edubtm_FreeOverflow(&ovPid, dlPool, dlHead);
+            if (e < 0) ERR(e);
+        }
+    }
+
+    if (nLeft < n) edubtm_BuildLeafPage(handle, page, refs, nLeft, format);
+
+    return(eNOERROR);
+
+} /* edubtm_TrimLeaf() */
+
+
+
+/*@================================
+ * edubtm_RemoveChild()
+ *================================*/
+/*
+ * Function: void edubtm_RemoveChild(BtreeInternal*, Two)
+ *
+ * Description:
+ *  Delete the child pointed by the slot 'slotNo' (-1 for p0) from an
+ *  internal page having at least one entry. The child of the first entry
+ *  takes the place of a deleted p0.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_RemoveChild(
+    BtreeInternal               *page,          /* INOUT internal page */
+    Two                         slotNo)         /* IN slot pointing to the child */
+{
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    if (slotNo == -1) {
+        iEntry = (btm_InternalEntry*)&page->data[page->slot[0]];
+        page->hdr.p0 = iEntry->spid;
+        slotNo = 0;
+    }
+
+    edubtm_DeleteInternalEntry(page, slotNo);
+
+} /* edubtm_RemoveChild() */
+
+
+
+/*@================================
+ * edubtm_LinkLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_LinkLeaves(VolID, ShortPageID, ShortPageID)
+ *
+ * Description:
+ *  Make the leaves 'left' and 'right' neighbors in the list of leaves. One
+ *  of them may be NIL, at either end of the list.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_LinkLeaves(
+    VolID                       volNo,          /* IN volume of the Btree */
+    ShortPageID                 left,           /* IN the left leaf */
+    ShortPageID                 right)          /* IN the right leaf */
+{
+    Four                        e;              /* error number */
+    PageID                      pid;            /* a leaf page */
+    BtreeLeaf                   *page;          /* buffer of the leaf page */
+
+
+    if (left != NIL) {
+        MAKE_PAGEID(pid, volNo, left);
+
+        e = BfM_GetTrain(&pid, (char**)&page, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        page->hdr.nextPage = right;
+
+        e = BfM_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    if (right != NIL) {
+        MAKE_PAGEID(pid, volNo, right);
+
+        e = BfM_GetTrain(&pid, (char**)&page, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        page->hdr.prevPage = left;
+
+        e = BfM_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_LinkLeaves() */
+
+
+
+/*@================================
+ * edubtm_RebalanceRange()
+ *================================*/
+/*
+ * Function: Four edubtm_RebalanceRange(BtreeHandle*, PageID*, KeyValue*, KeyValue*,
+ *                                     Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Rebalance the subtree of 'pid' after edubtm_SpliceRange() along the
+ *  paths of 'start' and 'stop'. The child of 'stop' is rebalanced first and
+ *  then the child of 'start', so that the slot of the latter stays valid;
+ *  a child which underflows is merged or redistributed by edubtm_Underflow(),
+ *  and the item of a splitted child is inserted as edubtm_Delete() does.
+ *
+ *  If the page itself is splitted, the other child is left as it is; it
+ *  holds keys, so the tree stays valid.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  f    : TRUE if the page is not half full.
+ *  h    : TRUE if the page is splitted.
+ *  item : The internal item to be inserted into the parent if 'h' is TRUE.
+ */
+Four edubtm_RebalanceRange(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *pid,           /* IN root of the subtree */
+    KeyValue                    *start,         /* IN first key of the range */
+    KeyValue                    *stop,          /* IN last key of the range */
+    Boolean                     *f,             /* OUT whether the page is not half full */
+    Boolean                     *h,             /* OUT whether the page is splitted */
+    InternalItem                *item,          /* OUT The internal item to be returned */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* 0 for the child of 'stop', 1 for that of 'start' */
+    Two                         a;              /* slot of the child of 'start' */
+    Two                         b;              /* slot of the child of 'stop' */
+    Two                         idx;            /* slot of a child */
+    Boolean                     lf;             /* whether a child is not half full */
+    Boolean                     lh;             /* whether a child is splitted */
+    PageID                      child;          /* a child page */
+    KeyValue                    tKey;           /* a temporary key */
+    BtreePage                   *apage;         /* buffer of the page */
+    InternalItem                litem;          /* item of a splitted child */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    *f = *h = FALSE;
+
+    e = BfM_GetTrain(pid, (char**)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (apage->any.hdr.type & LEAF) {
+        *f = BTM_LEAF_UNDERFLOW(handle, &apage->bl);
+
+        e = BfM_FreeTrain(pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (!(apage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, pid, PAGE_BUF);
+
+    edubtm_BinarySearchInternal(&apage->bi, handle, start, &a);
+    edubtm_BinarySearchInternal(&apage->bi, handle, stop, &b);
+
+    child.volNo = pid->volNo;
+    for (i = 0; i < 2 && !*h; i++) {
+        /* a single path goes through this page */
+        if (i == 1 && a == b) break;
+        idx = (i == 0) ? b : a;
+
+        if (idx == -1)
+            child.pageNo = apage->bi.hdr.p0;
+        else {
+            iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-idx]];
+            child.pageNo = iEntry->spid;
+        }
+
+        e = edubtm_RebalanceRange(handle, &child, start, stop, &lf, &lh, &litem, dlPool, dlHead);
+        if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+        if (lh) {
+            tKey.len = litem.klen;
+            memcpy(tKey.val, litem.kval, litem.klen);
+            edubtm_BinarySearchInternal(&apage->bi, handle, &tKey, &idx);
+
+            e = edubtm_InsertInternal(&handle->catObjForFile, &apage->bi, &litem, idx, FALSE, h, item);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
+        }
+        else if (lf) {
+            e = edubtm_Underflow(handle, &apage->bi, &child, idx, f, h, item, dlPool, dlHead);
+            if (e < 0) ERRB1(e, pid, PAGE_BUF);
+        }
+    }
+
+    *f = (BI_FREE(&apage->bi) > BI_HALF);
+
+    e = BfM_SetDirty(pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_RebalanceRange() */
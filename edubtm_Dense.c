@@ -0,0 +1,434 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Dense.c
+ *
+ * Description :
+ *  A dense leaf page keeps the keys of an SM_INT or SM_LONG_LONG index in a
+ *  sorted array next to the array of their ObjectIDs (see BL_DENSE_KEY()).
+ *  It is searched without slot indirection: a branch-free binary search
+ *  narrows the keys down to a window of DENSE_WINDOW_INT (DENSE_WINDOW_LONG)
+ *  keys, and the keys of the window less than the search key are counted
+ *  with AVX2 or SSE2 compares when the processor has them.
+ *
+ * Exports:
+ *  Boolean edubtm_BinarySearchDenseLeaf(BtreeLeaf*, KeyValue*, Two*)
+ *  void edubtm_InsertDenseEntry(BtreeLeaf*, Two, char*, ObjectID*)
+ *  void edubtm_DeleteDenseEntry(BtreeLeaf*, Two)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DENSE_X86_SIMD
+#endif
+
+
+/*@ # of keys counted at once at the end of the search */
+#define DENSE_WINDOW_INT        16
+#define DENSE_WINDOW_LONG       8
+
+
+/*@ Internal Function Prototypes */
+Two edubtm_DenseLowerBoundInt(Four_Invariable*, Two, Four_Invariable);
+Two edubtm_DenseLowerBoundLong(Eight_Invariable*, Two, Eight_Invariable);
+Two edubtm_CountLessInt(Four_Invariable*, Four_Invariable);
+Two edubtm_CountLessLong(Eight_Invariable*, Eight_Invariable);
+#ifdef DENSE_X86_SIMD
+Boolean edubtm_HasAvx2(void);
+Two edubtm_CountLessIntAvx2(Four_Invariable*, Four_Invariable);
+Two edubtm_CountLessLongAvx2(Eight_Invariable*, Eight_Invariable);
+#endif
+
+
+
+/*@================================
+ * edubtm_BinarySearchDenseLeaf()
+ *================================*/
+/*
+ * Function: Boolean edubtm_BinarySearchDenseLeaf(BtreeLeaf*, KeyValue*, Two*)
+ *
+ * Description:
+ *  Search the dense leaf page 'lpage' for 'kval' in the same way as
+ *  edubtm_BinarySearchLeaf() does.
+ *
+ * Returns:
+ *  1) TRUE if the key is found, FALSE otherwise
+ *  2) parameter idx : entry No. of the key, or of the largest key less than
+ *                     it (-1 if there is none)
+ */
+Boolean edubtm_BinarySearchDenseLeaf(
+    BtreeLeaf                   *lpage,         /* IN Page Pointer to a Leaf Page */
+    KeyValue                    *kval,          /* IN key value to find */
+    Two                         *idx)           /* OUT index to be returned */
+{
+    Two                         lb;             /* # of keys less than 'kval' */
+    Boolean                     found;          /* search result */
+    Four_Invariable             i4;             /* 4-byte int key */
+    Eight_Invariable            i8;             /* 8-byte long long key */
+
+
+    if (lpage->hdr.denseKeyLen == SM_INT_SIZE) {
+        memcpy(&i4, kval->val, SM_INT_SIZE);
+        lb = edubtm_DenseLowerBoundInt((Four_Invariable*)lpage->data, lpage->hdr.nSlots, i4);
+        found = (lb < lpage->hdr.nSlots && ((Four_Invariable*)lpage->data)[lb] == i4);
+    }
+    else {
+        memcpy(&i8, kval->val, SM_LONG_LONG_SIZE);
+        lb = edubtm_DenseLowerBoundLong((Eight_Invariable*)lpage->data, lpage->hdr.nSlots, i8);
+        found = (lb < lpage->hdr.nSlots && ((Eight_Invariable*)lpage->data)[lb] == i8);
+    }
+
+    *idx = found ? lb : lb - 1;
+
+    return(found);
+
+} /* edubtm_BinarySearchDenseLeaf() */
+
+
+
+/*@================================
+ * edubtm_DenseLowerBoundInt()
+ *================================*/
+/*
+ * Function: Two edubtm_DenseLowerBoundInt(Four_Invariable*, Two, Four_Invariable)
+ *
+ * Description:
+ *  Return the # of the 'n' sorted keys less than 'x'. Every step of the
+ *  binary search keeps the answer within [base, base+len]; once 'len' is
+ *  at most the window, the keys of a window covering that range are
+ *  counted instead.
+ *
+ * Returns:
+ *  # of keys less than 'x'
+ */
+Two edubtm_DenseLowerBoundInt(
+    Four_Invariable             *keys,          /* IN sorted keys */
+    Two                         n,              /* IN # of keys */
+    Four_Invariable             x)              /* IN key to be searched */
+{
+    Two                         base;           /* start of the range holding the answer */
+    Two                         len;            /* length of that range */
+    Two                         half;           /* half of 'len' */
+    Two                         i;              /* index of a key */
+    Two                         count;          /* # of keys less than 'x' */
+
+
+    if (n < DENSE_WINDOW_INT) {
+        for (count = 0, i = 0; i < n; i++) count += (keys[i] < x);
+        return(count);
+    }
+
+    for (base = 0, len = n; len > DENSE_WINDOW_INT; len -= half) {
+        half = len / 2;
+        base = (keys[base + half] < x) ? base + half : base;
+    }
+
+    /* the window may not run past the last key */
+    base = MIN(base, n - DENSE_WINDOW_INT);
+
+    return(base + edubtm_CountLessInt(&keys[base], x));
+
+} /* edubtm_DenseLowerBoundInt() */
+
+
+
+/*@================================
+ * edubtm_DenseLowerBoundLong()
+ *================================*/
+/*
+ * Function: Two edubtm_DenseLowerBoundLong(Eight_Invariable*, Two, Eight_Invariable)
+ *
+ * Description:
+ *  The SM_LONG_LONG version of edubtm_DenseLowerBoundInt().
+ *
+ * Returns:
+ *  # of keys less than 'x'
+ */
+Two edubtm_DenseLowerBoundLong(
+    Eight_Invariable            *keys,          /* IN sorted keys */
+    Two                         n,              /* IN # of keys */
+    Eight_Invariable            x)              /* IN key to be searched */
+{
+    Two                         base;           /* start of the range holding the answer */
+    Two                         len;            /* length of that range */
+    Two                         half;           /* half of 'len' */
+    Two                         i;              /* index of a key */
+    Two                         count;          /* # of keys less than 'x' */
+
+
+    if (n < DENSE_WINDOW_LONG) {
+        for (count = 0, i = 0; i < n; i++) count += (keys[i] < x);
+        return(count);
+    }
+
+    for (base = 0, len = n; len > DENSE_WINDOW_LONG; len -= half) {
+        half = len / 2;
+        base = (keys[base + half] < x) ? base + half : base;
+    }
+
+    /* the window may not run past the last key */
+    base = MIN(base, n - DENSE_WINDOW_LONG);
+
+    return(base + edubtm_CountLessLong(&keys[base], x));
+
+} /* edubtm_DenseLowerBoundLong() */
+
+
+
+/*@================================
+ * edubtm_CountLessInt()
+ *================================*/
+/*
+ * Function: Two edubtm_CountLessInt(Four_Invariable*, Four_Invariable)
+ *
+ * Description:
+ *  Count the keys less than 'x' among the DENSE_WINDOW_INT keys of 'keys'.
+ *
+ * Returns:
+ *  # of keys less than 'x'
+ */
+Two edubtm_CountLessInt(
+    Four_Invariable             *keys,          /* IN a window of keys */
+    Four_Invariable             x)              /* IN key to be searched */
+{
+    Two                         i;              /* index of a key */
+    Two                         count;          /* # of keys less than 'x' */
+#ifdef DENSE_X86_SIMD
+    __m128i                     xv;             /* 'x' in every lane */
+    __m128i                     lt;             /* lanes whose key is less than 'x' */
+
+
+    if (edubtm_HasAvx2()) return(edubtm_CountLessIntAvx2(keys, x));
+
+    xv = _mm_set1_epi32(x);
+    for (count = 0, i = 0; i < DENSE_WINDOW_INT; i += 4) {
+        lt = _mm_cmpgt_epi32(xv, _mm_loadu_si128((__m128i*)&keys[i]));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(lt)));
+    }
+#else
+    for (count = 0, i = 0; i < DENSE_WINDOW_INT; i++) count += (keys[i] < x);
+#endif
+
+    return(count);
+
+} /* edubtm_CountLessInt() */
+
+
+
+/*@================================
+ * edubtm_CountLessLong()
+ *================================*/
+/*
+ * Function: Two edubtm_CountLessLong(Eight_Invariable*, Eight_Invariable)
+ *
+ * Description:
+ *  Count the keys less than 'x' among the DENSE_WINDOW_LONG keys of 'keys'.
+ *  SSE2 has no 64-bit compare, so it is counted by scalar code without AVX2.
+ *
+ * Returns:
+ *  # of keys less than 'x'
+ */
+Two edubtm_CountLessLong(
+    Eight_Invariable            *keys,          /* IN a window of keys */
+    Eight_Invariable            x)              /* IN key to be searched */
+{
+    Two                         i;              /* index of a key */
+    Two                         count;          /* # of keys less than 'x' */
+
+
+#ifdef DENSE_X86_SIMD
+    if (edubtm_HasAvx2()) return(edubtm_CountLessLongAvx2(keys, x));
+#endif
+
+    for (count = 0, i = 0; i < DENSE_WINDOW_LONG; i++) count += (keys[i] < x);
+
+    return(count);
+
+} /* edubtm_CountLessLong() */
+
+
+
+#ifdef DENSE_X86_SIMD
+/*@================================
+ * edubtm_HasAvx2()
+ *================================*/
+/*
+ * Function: Boolean edubtm_HasAvx2(void)
+ *
+ * Description:
+ *  Check once whether the processor supports AVX2.
+ *
+ * Returns:
+ *  TRUE if AVX2 is supported, FALSE otherwise
+ */
+Boolean edubtm_HasAvx2(void)
+{
+    static Four                 hasAvx2 = NIL;  /* NIL until checked */
+
+
+    if (hasAvx2 == NIL) {
+        __builtin_cpu_init();
+        hasAvx2 = __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+    }
+
+    return(hasAvx2);
+
+} /* edubtm_HasAvx2() */
+
+
+
+/*@================================
+ * edubtm_CountLessIntAvx2()
+ *================================*/
+/*
+ * Function: Two edubtm_CountLessIntAvx2(Four_Invariable*, Four_Invariable)
+ *
+ * Description:
+ *  The AVX2 version of edubtm_CountLessInt().
+ *
+ * Returns:
+ *  # of keys less than 'x'
+ */
+__attribute__((target("avx2")))
+Two edubtm_CountLessIntAvx2(
+    Four_Invariable             *keys,          /* IN a window of keys */
+    Four_Invariable             x)              /* IN key to be searched */
+{
+    __m256i                     xv;             /* 'x' in every lane */
+    __m256i                     lt0, lt1;       /* lanes whose key is less than 'x' */
+
+
+    xv = _mm256_set1_epi32(x);
+    lt0 = _mm256_cmpgt_epi32(xv, _mm256_loadu_si256((__m256i*)&keys[0]));
+    lt1 = _mm256_cmpgt_epi32(xv, _mm256_loadu_si256((__m256i*)&keys[8]));
+
+    return(__builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(lt0))) +
+           __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(lt1))));
+
+} /* edubtm_CountLessIntAvx2() */
+
+
+
+/*@================================
+ * edubtm_CountLessLongAvx2()
+ *================================*/
+/*
+ * Function: Two edubtm_CountLessLongAvx2(Eight_Invariable*, Eight_Invariable)
+ *
+ * Description:
+ *  The AVX2 version of edubtm_CountLessLong().
+ *
+ * Returns:
+ *  # of keys less than 'x'
+ */
+__attribute__((target("avx2")))
+Two edubtm_CountLessLongAvx2(
+    Eight_Invariable            *keys,          /* IN a window of keys */
+    Eight_Invariable            x)              /* IN key to be searched */
+{
+    __m256i                     xv;             /* 'x' in every lane */
+    __m256i                     lt0, lt1;       /* lanes whose key is less than 'x' */
+
+
+    xv = _mm256_set1_epi64x(x);
+    lt0 = _mm256_cmpgt_epi64(xv, _mm256_loadu_si256((__m256i*)&keys[0]));
+    lt1 = _mm256_cmpgt_epi64(xv, _mm256_loadu_si256((__m256i*)&keys[4]));
+
+    return(__builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(lt0))) +
+           __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(lt1))));
+
+} /* edubtm_CountLessLongAvx2() */
+#endif
+
+
+
+/*@================================
+ * edubtm_InsertDenseEntry()
+ *================================*/
+/*
+ * Function: void edubtm_InsertDenseEntry(BtreeLeaf*, Two, char*, ObjectID*)
+ *
+ * Description:
+ *  Insert <key, oid> as the entry 'slotNo' of the dense leaf page 'page'.
+ *  The caller checks that the page is not full.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_InsertDenseEntry(
+    BtreeLeaf                   *page,          /* INOUT dense leaf page */
+    Two                         slotNo,         /* IN entry No. of the new entry */
+    char                        *key,           /* IN key of the new entry */
+    ObjectID                    *oid)           /* IN ObjectID of the new entry */
+{
+    Two                         n;              /* # of entries moved */
+
+
+    n = page->hdr.nSlots - slotNo;
+    memmove(BL_DENSE_KEY(page, slotNo + 1), BL_DENSE_KEY(page, slotNo), n * page->hdr.denseKeyLen);
+    memmove(BL_DENSE_OID(page, slotNo + 1), BL_DENSE_OID(page, slotNo), n * OBJECTID_SIZE);
+
+    memcpy(BL_DENSE_KEY(page, slotNo), key, page->hdr.denseKeyLen);
+    memcpy(BL_DENSE_OID(page, slotNo), oid, OBJECTID_SIZE);
+
+    page->hdr.nSlots++;
+    page->hdr.free += page->hdr.denseKeyLen + OBJECTID_SIZE;
+
+} /* edubtm_InsertDenseEntry() */
+
+
+
+/*@================================
+ * edubtm_DeleteDenseEntry()
+ *================================*/
+/*
+ * Function: void edubtm_DeleteDenseEntry(BtreeLeaf*, Two)
+ *
+ * Description:
+ *  Delete the entry 'slotNo' of the dense leaf page 'page'.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_DeleteDenseEntry(
+    BtreeLeaf                   *page,          /* INOUT dense leaf page */
+    Two                         slotNo)         /* IN entry No. of the deleted entry */
+{
+    Two                         n;              /* # of entries moved */
+
+
+    n = page->hdr.nSlots - slotNo - 1;
+    memmove(BL_DENSE_KEY(page, slotNo), BL_DENSE_KEY(page, slotNo + 1), n * page->hdr.denseKeyLen);
+    memmove(BL_DENSE_OID(page, slotNo), BL_DENSE_OID(page, slotNo + 1), n * OBJECTID_SIZE);
+
+    page->hdr.nSlots--;
+    page->hdr.free -= page->hdr.denseKeyLen + OBJECTID_SIZE;
+
+} /* edubtm_DeleteDenseEntry() */
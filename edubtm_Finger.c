@@ -0,0 +1,183 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Finger.c
+ *
+ * Description :
+ *  An opened index keeps a finger on the leaf reached by its last descent:
+ *  the leaf, the internal pages on the way to it and the range of keys the
+ *  way leads to, taken from the internal entries around each chosen child.
+ *  Successive operations on nearby keys, e.g. increasing keys appended one
+ *  after another, then go to the leaf directly instead of descending again.
+ *
+ *  A descent resets the finger at the root and narrows it on every internal
+ *  page. Since the range of a leaf and the path to it change only when
+ *  pages are split, merged or redistributed, those operations invalidate the
+ *  finger with BTM_INVALIDATE_FINGER(); other changes leave it valid. The
+ *  finger assumes the index is changed only through its handle while the
+ *  handle is open.
+ *
+ * Exports:
+ *  void edubtm_ResetFinger(BtreeHandle*)
+ *  void edubtm_NarrowFinger(BtreeHandle*, PageID*, BtreeInternal*, Two)
+ *  void edubtm_SetFingerLeaf(BtreeHandle*, PageID*)
+ *  Boolean edubtm_FingerCovers(BtreeHandle*, KeyValue*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_ResetFinger()
+ *================================*/
+/*
+ * Function: void edubtm_ResetFinger(BtreeHandle*)
+ *
+ * Description:
+ *  Start a descent from the root; the finger has no leaf and the range of
+ *  all keys until the descent reaches a leaf.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_ResetFinger(
+    BtreeHandle                 *handle)        /* INOUT opened index */
+{
+    handle->finger.leaf.pageNo = NIL;
+    handle->finger.height = 0;
+    handle->finger.nRightmost = 0;
+    handle->finger.lowSet = FALSE;
+    handle->finger.highSet = FALSE;
+
+} /* edubtm_ResetFinger() */
+
+
+
+/*@================================
+ * edubtm_NarrowFinger()
+ *================================*/
+/*
+ * Function: void edubtm_NarrowFinger(BtreeHandle*, PageID*, BtreeInternal*, Two)
+ *
+ * Description:
+ *  Record that the descent passes the internal page 'pid' and goes on to
+ *  the child of entry 'idx' (p0 if 'idx' is -1). The keys routed to that
+ *  child are at least the key of entry 'idx' and less than the key of
+ *  entry 'idx'+1.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_NarrowFinger(
+    BtreeHandle                 *handle,        /* INOUT opened index */
+    PageID                      *pid,           /* IN the internal page */
+    BtreeInternal               *page,          /* IN buffer of the page */
+    Two                         idx)            /* IN entry of the chosen child */
+{
+    BtreeFinger                 *finger;        /* the finger of 'handle' */
+    btm_InternalEntry           *entry;         /* an entry around the child */
+
+
+    finger = &handle->finger;
+
+    if (finger->height < BTM_MAXLEVEL) finger->path[finger->height] = *pid;
+    if (finger->nRightmost == finger->height && idx == page->hdr.nSlots - 1) finger->nRightmost++;
+    finger->height++;
+
+    if (idx >= 0) {
+        entry = (btm_InternalEntry*)&page->data[page->slot[-idx]];
+        finger->low.len = entry->klen;
+        memcpy(finger->low.val, entry->kval, entry->klen);
+        finger->lowSet = TRUE;
+    }
+
+    if (idx + 1 < page->hdr.nSlots) {
+        entry = (btm_InternalEntry*)&page->data[page->slot[-(idx + 1)]];
+        finger->high.len = entry->klen;
+        memcpy(finger->high.val, entry->kval, entry->klen);
+        finger->highSet = TRUE;
+    }
+
+} /* edubtm_NarrowFinger() */
+
+
+
+/*@================================
+ * edubtm_SetFingerLeaf()
+ *================================*/
+/*
+ * Function: void edubtm_SetFingerLeaf(BtreeHandle*, PageID*)
+ *
+ * Description:
+ *  Record that the descent has reached the leaf 'pid'. The finger is left
+ *  unset if the path is longer than it can keep.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_SetFingerLeaf(
+    BtreeHandle                 *handle,        /* INOUT opened index */
+    PageID                      *pid)           /* IN the leaf */
+{
+    if (handle->finger.height <= BTM_MAXLEVEL) handle->finger.leaf = *pid;
+
+} /* edubtm_SetFingerLeaf() */
+
+
+
+/*@================================
+ * edubtm_FingerCovers()
+ *================================*/
+/*
+ * Function: Boolean edubtm_FingerCovers(BtreeHandle*, KeyValue*)
+ *
+ * Description:
+ *  Tell whether a descent for 'kval' would reach the leaf of the finger.
+ *
+ * Returns:
+ *  TRUE if the finger is set and 'kval' is in its range
+ */
+Boolean edubtm_FingerCovers(
+    BtreeHandle                 *handle,        /* IN opened index */
+    KeyValue                    *kval)          /* IN key value */
+{
+    BtreeFinger                 *finger;        /* the finger of 'handle' */
+
+
+    finger = &handle->finger;
+
+    if (finger->leaf.pageNo == NIL) return(FALSE);
+
+    if (finger->lowSet && BTM_KEYCOMPARE(handle, kval, &finger->low) == LESS) return(FALSE);
+
+    if (finger->highSet && BTM_KEYCOMPARE(handle, kval, &finger->high) != LESS) return(FALSE);
+
+    return(TRUE);
+
+} /* edubtm_FingerCovers() */
@@ -29,7 +29,7 @@
  *  Find the first ObjectID of the given Btree. 
  *
  * Exports:
- *  Four edubtm_FirstObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*)
+ *  Four edubtm_FirstObject(BtreeHandle*, KeyValue*, Four, BtreeCursor*)
  */
 
 
@@ -44,7 +44,7 @@
  * edubtm_FirstObject()
  *================================*/
 /*
- * Function: Four edubtm_FirstObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*)
+ * Function: Four edubtm_FirstObject(BtreeHandle*, KeyValue*, Four, BtreeCursor*)
  *
  * Description : 
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -64,68 +64,64 @@
  *             The first object's object identifier is also returned via this.
  */
 Four edubtm_FirstObject(
-    PageID  		*root,		/* IN The root of Btree */
-    KeyDesc 		*kdesc,		/* IN Btree key descriptor */
+    BtreeHandle		*handle,	/* IN opened index */
     KeyValue 		*stopKval,	/* IN key value of stop condition */
     Four     		stopCompOp,	/* IN comparison operator of stop condition */
     BtreeCursor 	*cursor)	/* OUT The first ObjectID in the Btree */
 {
-    int			i;
     Four 		e;		/* error */
     Four 		cmp;		/* result of comparison */
     PageID 		curPid;		/* PageID of the current page */
     PageID 		child;		/* PageID of the child page */
     BtreePage 		*apage;		/* a page pointer */
-    Two                 lEntryOffset;   /* starting offset of a leaf entry */
-    btm_LeafEntry 	*lEntry;	/* a leaf entry */
-    Two                 alignedKlen;    /* aligned length of the key length */
+    Two 		level;		/* level of the current page, 0 for the root */
+    Two 		slot;		/* slot of the current page if it is pinned, else NIL */
     
 
-    if (root == NULL) ERR(eBADPAGE_BTM);
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
 
-    e = BfM_GetTrain(&root, (char**)&apage, PAGE_BUF);
+    curPid = handle->root;
+    level = 0;
+    e = edubtm_FixPage(handle, &curPid, level, &apage, &slot);
     if(e<0)ERR(e);
-    curPid.pageNo = root->pageNo;
-    curPid.volNo = root->volNo;
 
-    while (apage->any.hdr.type & LEAF == FALSE) {
-        // we choose the first left child until the child is a Leaf page 
-        child.pageNo = apage->bi.hdr.p0;
-        child.pageNo = root->volNo;
-        e = BfM_FreeTrain(&curPid, PAGE_BUF);
-        if (e<0)ERR(e);
-        e = BfM_GetTrain(&child, (char**)&apage, PAGE_BUF);
+    /* Follow the leftmost child (p0) down to the leftmost leaf. */
+    while (apage->any.hdr.type & INTERNAL) {
+        MAKE_PAGEID(child, curPid.volNo, apage->bi.hdr.p0);
+
+        e = edubtm_UnfixPage(&curPid, slot != NIL);
         if(e<0)ERR(e);
+
+        level++;
+        e = edubtm_FixPage(handle, &child, level, &apage, &slot);
+        if(e<0)ERR(e);
+
         curPid = child;
     }
 
-    // we now have our left leaf page of our tree
+    if (!(apage->any.hdr.type & LEAF)) ERRB1(eBADBTREEPAGE_BTM, &curPid, PAGE_BUF);
 
-    lEntry =&(apage->bl.data[apage->bl.slot[0]]);
-    alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-    //cursor setup
-    cursor->flag = CURSOR_ON;
-    cursor->key.len = lEntry->klen;
-    memcpy(cursor->key.val, lEntry->kval, lEntry->klen);
-    cursor->leaf = curPid;
-    cursor->slotNo = 0;
-    cursor->oid = *(ObjectID*)&(lEntry->kval[alignedKlen]);
+    /* Only an empty root can be an empty leaf. */
+    if (apage->bl.hdr.nSlots == 0) {
+        cursor->flag = CURSOR_EOS;
+        e = BfM_FreeTrain(&curPid, PAGE_BUF);
+        if(e<0)ERR(e);
+        return(eNOERROR);
+    }
 
-    cmp = edubtm_KeyCompare(kdesc, &cursor->key, stopKval);
+    e = edubtm_SetCursorObject(&apage->bl, &curPid, 0, FALSE, cursor);
+    if(e<0) ERRB1(e, &curPid, PAGE_BUF);
 
-    if (cmp == EQUAL) {
-        cursor->flag = CURSOR_ON;
-        if (stopCompOp == SM_LT) cursor->flag = CURSOR_EOS; 
+    /* Check the stop condition */
+    if (stopCompOp != SM_EOF && stopCompOp != SM_BOF) {
+        cmp = BTM_KEYCOMPARE(handle, &cursor->key, stopKval);
+
+        /* the scan starts from the smallest key: only a stop key below it ends the scan */
+        if (cmp == GREAT || (cmp == EQUAL && stopCompOp == SM_LT))
+            cursor->flag = CURSOR_EOS;
     }
-    else if (cmp == GREATER) cursor->flag = CURSOR_EOS;
-    else if (cmp == LESS) cursor->flag = CURSOR_ON;
+
     e = BfM_FreeTrain(&curPid, PAGE_BUF);
     if(e<0)ERR(e);
 
@@ -98,6 +98,17 @@ Four edubtm_FreePages(
             if(e<0)ERR(e);
         }
     }
+    else if ((apage->any.hdr.type & LEAF) && apage->bl.hdr.denseKeyLen == 0) {
+        for (i=0; i<apage->bl.hdr.nSlots; ++i) {
+            lEntryOffset = BL_SLOT(&apage->bl, i);
+            lEntry = (btm_LeafEntry*)&apage->bl.data[lEntryOffset];
+            if (lEntry->nObjects == NIL) {
+                MAKE_PAGEID(ovPid, curPid->volNo, *(ShortPageID*)BTM_LEAFENTRY_OBJECTS(lEntry));
+                e = edubtm_FreeOverflow(&ovPid, dlPool, dlHead);
+                if(e<0)ERRB1(e, curPid, PAGE_BUF);
+            }
+        }
+    }
 
     apage->any.hdr.type = FREEPAGE;
     e = BfM_SetDirty(curPid, PAGE_BUF);
@@ -0,0 +1,201 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_HotKey.c
+ *
+ * Description :
+ *  Under skewed traffic a few keys take most SM_EQ probes. An opened index
+ *  may keep the results of recent SM_EQ probes (see EduBtM_CacheHotKeys()),
+ *  each in the entry chosen by the hash of its key; a probe of a kept key
+ *  is then answered without any page access.
+ *
+ *  An entry holds the position of the key in its leaf, so it is valid only
+ *  while the leaf is unchanged. Every change of a leaf made through the
+ *  handle bumps the version of the leaf (BTM_LEAF_CHANGED()), which plays
+ *  the role of a page LSN: an entry made under another version is ignored.
+ *  The versions are shared by the leaves whose page numbers are equal
+ *  modulo BTM_LEAFVERSIONS, so a change may void a few more entries than
+ *  needed but never too few. Changes which free or move leaves wholesale
+ *  clear all entries instead.
+ *
+ * Exports:
+ *  void edubtm_ClearHotKeys(BtreeHandle*)
+ *  Boolean edubtm_LookUpHotKey(BtreeHandle*, KeyValue*, BtreeCursor*)
+ *  void edubtm_KeepHotKey(BtreeHandle*, KeyValue*, BtreeCursor*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+BtreeHotKey *edubtm_HotKeyEntry(BtreeHotKeyCache*, KeyValue*);
+
+
+
+/*@================================
+ * edubtm_ClearHotKeys()
+ *================================*/
+/*
+ * Function: void edubtm_ClearHotKeys(BtreeHandle*)
+ *
+ * Description:
+ *  Void all entries of the hot keys of 'handle'.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_ClearHotKeys(
+    BtreeHandle         *handle)        /* INOUT opened index */
+{
+    Four                i;              /* index of an entry */
+
+
+    for (i = 0; i < handle->hot.nEntries; i++)
+        handle->hot.entry[i].klen = NIL;
+
+} /* edubtm_ClearHotKeys() */
+
+
+
+/*@================================
+ * edubtm_LookUpHotKey()
+ *================================*/
+/*
+ * Function: Boolean edubtm_LookUpHotKey(BtreeHandle*, KeyValue*, BtreeCursor*)
+ *
+ * Description:
+ *  Answer an SM_EQ probe of the key 'kval' from the hot keys of 'handle'
+ *  if they hold a valid result for it.
+ *
+ * Returns:
+ *  TRUE if the probe is answered
+ *
+ * Side effects:
+ *  cursor : the first ObjectID of the key if the probe is answered
+ */
+Boolean edubtm_LookUpHotKey(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval,          /* IN key value probed */
+    BtreeCursor         *cursor)        /* OUT cursor on the first ObjectID of the key */
+{
+    BtreeHotKey         *entry;         /* the entry for the key */
+    VolID               volNo;          /* volume of the index */
+
+
+    entry = edubtm_HotKeyEntry(&handle->hot, kval);
+
+    if (entry == NULL || entry->klen != kval->len || memcmp(entry->kval, kval->val, kval->len) != 0 ||
+        entry->version != BTM_LEAF_VERSION(handle, entry->leaf)) {
+        handle->hot.nMisses++;
+        return(FALSE);
+    }
+
+    volNo = handle->root.volNo;
+
+    cursor->flag = CURSOR_ON;
+    cursor->oid = entry->oid;
+    cursor->key = *kval;
+    MAKE_PAGEID(cursor->leaf, volNo, entry->leaf);
+    MAKE_PAGEID(cursor->overflow, volNo, entry->overflow);
+    cursor->slotNo = entry->slotNo;
+    cursor->oidArrayElemNo = entry->oidArrayElemNo;
+
+    handle->hot.nHits++;
+
+    return(TRUE);
+
+} /* edubtm_LookUpHotKey() */
+
+
+
+/*@================================
+ * edubtm_KeepHotKey()
+ *================================*/
+/*
+ * Function: void edubtm_KeepHotKey(BtreeHandle*, KeyValue*, BtreeCursor*)
+ *
+ * Description:
+ *  Keep the result 'cursor' of an SM_EQ probe of the key 'kval' which has
+ *  just descended the tree, replacing the result kept in its entry.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_KeepHotKey(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval,          /* IN key value probed */
+    BtreeCursor         *cursor)        /* IN cursor on the first ObjectID of the key */
+{
+    BtreeHotKey         *entry;         /* the entry for the key */
+
+
+    entry = edubtm_HotKeyEntry(&handle->hot, kval);
+    if (entry == NULL) return;
+
+    entry->klen = kval->len;
+    memcpy(entry->kval, kval->val, kval->len);
+    entry->oid = cursor->oid;
+    entry->leaf = cursor->leaf.pageNo;
+    entry->overflow = cursor->overflow.pageNo;
+    entry->slotNo = cursor->slotNo;
+    entry->oidArrayElemNo = cursor->oidArrayElemNo;
+    entry->version = BTM_LEAF_VERSION(handle, entry->leaf);
+
+} /* edubtm_KeepHotKey() */
+
+
+
+/*@================================
+ * edubtm_HotKeyEntry()
+ *================================*/
+/*
+ * Function: BtreeHotKey *edubtm_HotKeyEntry(BtreeHotKeyCache*, KeyValue*)
+ *
+ * Description:
+ *  Choose the entry for the key 'kval' by the FNV-1a hash of its bytes.
+ *
+ * Returns:
+ *  the entry, NULL if no key is kept or the key is too long to be kept
+ */
+BtreeHotKey *edubtm_HotKeyEntry(
+    BtreeHotKeyCache    *hot,           /* IN the hot keys */
+    KeyValue            *kval)          /* IN key value */
+{
+    Two                 i;              /* index of a byte of the key */
+    unsigned int        hash;           /* hash value of the key */
+
+
+    if (hot->nEntries == 0 || kval->len > BTM_HOTKEYLEN) return(NULL);
+
+    hash = 2166136261U;
+    for (i = 0; i < kval->len; i++)
+        hash = (hash ^ (unsigned char)kval->val[i]) * 16777619U;
+
+    return(&hot->entry[hash % hot->nEntries]);
+
+} /* edubtm_HotKeyEntry() */
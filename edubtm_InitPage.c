@@ -32,6 +32,7 @@
  * Exports:
  *  Four edubtm_InitInternal(PageID*, Boolean)
  *  Four edubtm_InitLeaf(PageID*, Boolean)
+ *  Four edubtm_InitOverflow(PageID*)
  */
 
 
@@ -72,7 +73,7 @@ Four edubtm_InitInternal(
     page->hdr.pid = *internal;
     SET_PAGE_TYPE(page, BTREE_PAGE_TYPE);
 
-    if(root)page->hdr.type = ROOT;
+    if(root)page->hdr.type = ROOT | INTERNAL;
     else page->hdr.type = INTERNAL;
 
     page->hdr.nSlots = 0;
@@ -123,12 +124,15 @@ Four edubtm_InitLeaf(
 
     page->hdr.pid = *leaf;
     SET_PAGE_TYPE(page, BTREE_PAGE_TYPE);
-    if(root)page->hdr.type = ROOT;
+    if(root)page->hdr.type = ROOT | LEAF;
     else  page->hdr.type = LEAF;
     
     page->hdr.free = 0; 
     page->hdr.nSlots = 0;
     page->hdr.unused = 0;
+    page->hdr.prefixLen = NIL;
+    page->hdr.keyHead = FALSE;
+    page->hdr.denseKeyLen = 0;
     page->hdr.prevPage = NIL;
     page->hdr.nextPage = NIL;
 
@@ -141,3 +145,46 @@ Four edubtm_InitLeaf(
     return(eNOERROR);
     
 }  /* edubtm_InitLeaf() */
+
+
+
+/*@================================
+ * edubtm_InitOverflow()
+ *================================*/
+/*
+ * Function: Four edubtm_InitOverflow(PageID*)
+ *
+ * Description:
+ *  Initialize as an overflow page which holds no ObjectID and is not linked
+ *  to other overflow pages yet.
+ *
+ * Returns:
+ *  Error code
+ *    some errors caused by function calls
+ */
+Four edubtm_InitOverflow(
+    PageID *overflow)		/* IN the PageID to be initialized */
+{
+    Four e;			/* error number */
+    BtreeOverflow *page;	/* a page pointer */
+
+    e = BfM_GetNewTrain(overflow, (char**)&page, PAGE_BUF);
+    if (e<0)ERR(e);
+
+    page->hdr.pid = *overflow;
+    SET_PAGE_TYPE(page, BTREE_PAGE_TYPE);
+    page->hdr.type = OVERFLOW;
+
+    page->hdr.nObjects = 0;
+    page->hdr.prevPage = NIL;
+    page->hdr.nextPage = NIL;
+
+    e = BfM_SetDirty(overflow, PAGE_BUF);
+    if(e<0)ERR(e);
+
+    e = BfM_FreeTrain(overflow, PAGE_BUF);
+    if(e<0)ERR(e);
+
+    return(eNOERROR);
+
+}  /* edubtm_InitOverflow() */
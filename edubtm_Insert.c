@@ -26,19 +26,20 @@
  * Module: edubtm_Insert.c
  *
  * Description : 
- *  This function edubtm_Insert(...) recursively calls itself until the type
- *  of a root page becomes LEAF.  If the given root page is an internal,
- *  it recursively calls itself using a proper child.  If the result of
- *  the call occur spliting, merging, or redistributing the children, it
- *  may insert, delete, or replace its own internal item, and if the given
- *  root page may be merged, splitted, or redistributed, it affects the
- *  return values.
+ *  This function edubtm_Insert(...) descends from the root page to the leaf
+ *  for the given key, keeping the internal pages it passes on a path.  After
+ *  inserting into the leaf, the items of splitted pages are inserted into
+ *  their parents walking back up the path, and if the root page is
+ *  splitted, it affects the return values.
  *
  * Exports:
- *  Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *  Four edubtm_Insert(BtreeHandle*, PageID*, KeyValue*, ObjectID*, Boolean,
  *                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
- *  Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*,
- *                      ObjectID*, Boolean*, Boolean*, InternalItem*)
+ *  Four edubtm_InsertLeaf(BtreeHandle*, PageID*, BtreeLeaf*, KeyValue*,
+ *                      ObjectID*, Boolean, Boolean*, Boolean*, InternalItem*)
+ *  Four edubtm_InsertBatch(BtreeHandle*, PageID*, KeyValue*, ObjectID*,
+ *                      Two*, Two, Two*, Boolean*, InternalItem*)
+ *  Four edubtm_InsertAtFinger(BtreeHandle*, KeyValue*, ObjectID*, Boolean, Boolean*, InternalItem*)
  *  Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*,
  *                          Two, Boolean*, InternalItem*)
  */
@@ -51,14 +52,19 @@
 #include "EduBtM_Internal.h"
 
 
+/*@ Internal Function Prototypes */
+Four edubtm_InsertDuplicate(BtreeHandle*, PageID*, BtreeLeaf*, Two, ObjectID*, Boolean*, InternalItem*);
+Four edubtm_PropagateSplit(BtreeHandle*, BtreePath*, Boolean*, InternalItem*);
+
+
 
 /*@================================
  * edubtm_Insert()
  *================================*/
 /*
- * Function: Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*,
- *                           ObjectID*, Boolean*, Boolean*, InternalItem*,
- *                           Pool*, DeallocListElem*)
+ * Function: Four edubtm_Insert(BtreeHandle*, PageID*, KeyValue*,
+ *                           ObjectID*, Boolean, Boolean*, Boolean*,
+ *                           InternalItem*, Pool*, DeallocListElem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -71,22 +77,32 @@
  *  If there is not enough spage in the leaf, the page should be splitted.  The
  *  overflow page may be used or created by this routine. It is created when
  *  the size of the entry is greater than a third of a page.
- * 
+ *
  *  'h' is TRUE if the given root page is splitted and the entry item will be
  *  inserted into the parent page.  'f' is TRUE if the given page is not half
  *  full because of creating a new overflow page.
  *
+ *  The internal pages passed are kept on a path (see edubtm_Path.c); the
+ *  pages above one with room for any new item are freed on the way down.
+ *  Pinned pages are read from 'handle' (see edubtm_Pin.c).
+ *  The descent is recorded in the finger of 'handle'; the caller resets the
+ *  finger before descending from the root.
+ *
+ *  If 'replace' is TRUE an existing key of a unique index is re-pointed to
+ *  'oid' instead of being reported as a duplicate (see edubtm_InsertLeaf()).
+ *
  * Returns:
  *  Error code
  *    eBADBTREEPAGE_BTM
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
  *    some errors caused by function calls
  */
 Four edubtm_Insert(
-    ObjectID                    *catObjForFile,         /* IN catalog object of B+-tree file */
+    BtreeHandle                 *handle,                /* IN opened index */
     PageID                      *root,                  /* IN the root of a Btree */
-    KeyDesc                     *kdesc,                 /* IN Btree key descriptor */
     KeyValue                    *kval,                  /* IN key value */
     ObjectID                    *oid,                   /* IN ObjectID which will be inserted */
+    Boolean                     replace,                /* IN TRUE if an existing key takes 'oid' */
     Boolean                     *f,                     /* OUT whether it is merged by creating a new overflow page */
     Boolean                     *h,                     /* OUT whether it is splitted */
     InternalItem                *item,                  /* OUT Internal Item which will be inserted */
@@ -95,81 +111,371 @@ Four edubtm_Insert(
     DeallocListElem             *dlHead)                /* INOUT head of the dealloc list */
 {
     Four                        e;                      /* error number */
-    Boolean                     lh;                     /* local 'h' */
     Boolean                     lf;                     /* local 'f' */
     Two                         idx;                    /* index for the given key value */
-    PageID                      newPid;                 /* a new PageID */
-    KeyValue                    tKey;                   /* a temporary key */
-    InternalItem                litem;                  /* a local internal item */
-    BtreePage                   *apage;                 /* a pointer to the root page */
+    PageID                      pid;                    /* the page visited */
+    BtreePage                   *apage;                 /* a pointer to the page visited */
     btm_InternalEntry           *iEntry;                /* an internal entry */
-    Two                         iEntryOffset;           /* starting offset of an internal entry */
-    SlottedPage                 *catPage;               /* buffer page containing the catalog object */
-    sm_CatOverlayForBtree       *catEntry;              /* pointer to Btree file catalog information */
-    PhysicalFileID              pFid;                   /* B+-tree file's FileID */
-
-
-    /* Error check whether using not supported functionality by EduBtM */
-    int i;
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
+    BtreePath                   path;                   /* the internal pages passed */
+    Two                         slot;                   /* slot of the page visited if it is pinned, else NIL */
+
 
-    e = BfM_GetTrain(root, &apage, PAGE_BUF);
-    if(e<0)ERR(e);
 
-    if(apage->any.hdr.type & INTERNAL){
-        /*  Determine the next child page to visit to find the leaf page to insert the <object’s key, object ID> pair.*/
-        edubtm_BinarySearchInternal(apage, kdesc, kval, &idx);
-        if(idx == -1){
-            newPid.volNo = root->volNo;
-            newPid.pageNo = apage->bi.hdr.p0;
+    /*@ Initially the flags are FALSE */
+    *h = *f = FALSE;
+
+    path.height = 0;
+    pid = *root;
+
+    /*@ descend to the leaf page to insert the <object's key, object ID> pair into */
+    for (;;) {
+        e = edubtm_FixPage(handle, &pid, path.height, &apage, &slot);
+        if (e < 0) ERRBPATH(e, &path);
+
+        if (apage->any.hdr.type & LEAF) break;
+
+        if (!(apage->any.hdr.type & INTERNAL)) {
+            (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+            ERRBPATH(eBADBTREEPAGE_BTM, &path);
         }
-        else {
-            iEntryOffset = apage->bi.slot[-idx];
-            iEntry = &apage->bi.data[iEntryOffset];
-            newPid.volNo = root->volNo;
-            newPid.pageNo = iEntry->spid;
+
+        /*  Determine the next child page to visit */
+        edubtm_BinarySearchInternal(&apage->bi, handle, kval, &idx);
+        edubtm_NarrowFinger(handle, &pid, &apage->bi, idx);
+
+        e = edubtm_PushPath(&path, &pid, apage, slot != NIL, idx);
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&pid, slot != NIL);
+            ERRBPATH(e, &path);
         }
-        e = edubtm_Insert(catObjForFile, &newPid, kdesc, kval, oid, &lf, &lh, &litem, dlPool, dlHead);
-        if(e<0)ERR(e);
-        
-        /*  If split occurs in the child page determined, insert the internal index entry pointing to the new page created by the split into the root page given as a parameter.*/
-        /*  Determine the position (slot number) to insert the index entry. Offsets of the index entries must be stored in the slot array in a sorted order of the keys of the index entries. Call edubtm_InsertInternal() to insert the index entry with the slot number determined.*/
-        if(lh){
-            tKey.len = litem.klen;
-            memcpy(&tKey.val[0], &litem.kval[0], litem.klen);
-            //we need to find the position to insert the index entry
-            edubtm_BinarySearchInternal(apage, kdesc, &tKey, &idx);
-            e = edubtm_InsertInternal(catObjForFile, apage, &litem, idx, h, item); // h will return true if split occurs at the root
-            if(e<0)ERR(e);
-            // now if a split occurs at the top top root, this is EduBtM who take care of fix the root
+
+        /* a split below stops at this page, so the pages above are not needed */
+        if (BTM_SAFE_FOR_INSERT(&apage->bi)) {
+            e = edubtm_ReleaseAncestors(&path);
+            if (e < 0) ERRBPATH(e, &path);
         }
 
+        if (idx == -1)
+            pid.pageNo = apage->bi.hdr.p0;
+        else {
+            iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-idx]];
+            pid.pageNo = iEntry->spid;
+        }
     }
-    else if (apage->any.hdr.type & LEAF){
-        /*  If the root page is a leaf page, insert the <object’s key, object ID> pair into the leaf page. */
-        e = edubtm_InsertLeaf(catObjForFile, root, apage, kdesc, kval, oid, f, h, item); // h will return true if split occurs at the root
-        if(e<0)ERR(e);
+
+    /*@ insert the <object's key, object ID> pair into the leaf page */
+    edubtm_SetFingerLeaf(handle, &pid);
+
+    e = edubtm_InsertLeaf(handle, &pid, &apage->bl, kval, oid, replace, &lf, h, item);
+    if (e < 0) {
+        (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+        ERRBPATH(e, &path);
     }
-    else{
-        ERR(eBADBTREEPAGE_BTM);
+
+    e = BfM_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) {
+        (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+        ERRBPATH(e, &path);
     }
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERRBPATH(e, &path);
+
+    /* only a leaf which is the root itself tells its parent about overflow pages */
+    if (path.height == 0) *f = lf;
+
+    /*@ insert the items of the splitted pages into their parents */
+    e = edubtm_PropagateSplit(handle, &path, h, item);
+    if (e < 0) ERRBPATH(e, &path);
+
+    e = edubtm_FreePath(&path);
+    if (e < 0) ERR(e);
+
     return(eNOERROR);
-    
+
 }   /* edubtm_Insert() */
 
 
 
+/*@================================
+ * edubtm_PropagateSplit()
+ *================================*/
+/*
+ * Function: Four edubtm_PropagateSplit(BtreeHandle*, BtreePath*, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Insert the item of a splitted child of the last page of 'path' into that
+ *  page, and so on up the path while the pages are splitted in turn. Pages
+ *  of the path which are not fixed are fixed as they are reached; the caller
+ *  frees the path. Only a page on the right edge of the tree is split for
+ *  appending (see edubtm_SplitInternal()).
+ *
+ * Returns:
+ *  Error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) h : TRUE if the first page of the path is splitted
+ *  2) item : item to be inserted into the new root when 'h' is TRUE
+ */
+Four edubtm_PropagateSplit(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreePath                   *path,          /* INOUT the path to the splitted child */
+    Boolean                     *h,             /* INOUT whether the child is splitted */
+    InternalItem                *item)          /* INOUT item of the splitted child */
+{
+    Four                        e;              /* error number */
+    Two                         level;          /* level of a page on the path */
+    Two                         idx;            /* index for the new item */
+    KeyValue                    tKey;           /* a temporary key */
+    InternalItem                litem;          /* item of the child */
+    BtreeInternal               *apage;         /* buffer of a page on the path */
+
+
+    for (level = path->height - 1; *h && level >= 0; level--) {
+        e = edubtm_FixPathPage(path, level);
+        if (e < 0) ERR(e);
+        apage = &path->page[level]->bi;
+
+        litem = *item;
+        tKey.len = litem.klen;
+        memcpy(&tKey.val[0], &litem.kval[0], litem.klen);
+        /* the new entry goes right after the largest entry not greater than its key */
+        edubtm_BinarySearchInternal(apage, handle, &tKey, &idx);
+
+        e = edubtm_InsertInternal(&handle->catObjForFile, apage, &litem, idx, level <= path->nRightmost, h, item);
+        if (e < 0) ERR(e);
+
+        e = BfM_SetDirty(&path->pid[level], PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_PropagateSplit() */
+
+
+
+/*@================================
+ * edubtm_InsertBatch()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertBatch(BtreeHandle*, PageID*, KeyValue*, ObjectID*,
+ *                                Two*, Two, Two*, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Insert the first objects <keys[order[i]], oids[order[i]]> of the 'n'
+ *  objects, whose keys are in ascending order, which go to the same leaf.
+ *  The tree is descended once for the first key as by edubtm_Insert(); on
+ *  every internal page the run is cut before the first key belonging to a
+ *  later child, so the run left at the leaf is inserted one object after
+ *  another without descending again.
+ *
+ *  A split, or a move of entries to a sibling, ends the run, since the rest
+ *  of it may belong to another leaf; the items of the splitted pages go up
+ *  the path as for edubtm_Insert(). 'nDone' may thus be less than the run.
+ *  The descent is recorded in the finger of 'handle', which a change of the
+ *  key ranges of the leaves invalidates.
+ *
+ * Returns:
+ *  Error code
+ *    eBADBTREEPAGE_BTM
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) nDone : # of objects inserted, at least 1 unless an error occurs
+ *  2) h : TRUE if the root is splitted
+ *  3) item : item to be inserted into the new root when 'h' is TRUE
+ */
+Four edubtm_InsertBatch(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *root,          /* IN the root of a Btree */
+    KeyValue                    *keys,          /* IN key values */
+    ObjectID                    *oids,          /* IN ObjectIDs which will be inserted */
+    Two                         *order,         /* IN indexes of the objects in ascending key order */
+    Two                         n,              /* IN # of objects */
+    Two                         *nDone,         /* OUT # of objects inserted */
+    Boolean                     *h,             /* OUT whether the root is splitted */
+    InternalItem                *item)          /* OUT Internal Item which will be inserted */
+                                                /*     into the new root when 'h' is TRUE */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of an object */
+    Two                         m;              /* # of objects of the run */
+    Two                         idx;            /* index of the child of the run */
+    Boolean                     lf;             /* whether an overflow page is created */
+    PageID                      pid;            /* the page visited */
+    BtreePage                   *apage;         /* a pointer to the page visited */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+    BtreePath                   path;           /* the internal pages passed */
+    Two                         slot;           /* slot of the page visited if it is pinned, else NIL */
+
+
+    *h = FALSE;
+    *nDone = 0;
+
+    edubtm_ResetFinger(handle);
+
+    path.height = 0;
+    pid = *root;
+    m = n;
+
+    /*@ descend to the leaf of the first key, narrowing the run on the way */
+    for (;;) {
+        e = edubtm_FixPage(handle, &pid, path.height, &apage, &slot);
+        if (e < 0) ERRBPATH(e, &path);
+
+        if (apage->any.hdr.type & LEAF) break;
+
+        if (!(apage->any.hdr.type & INTERNAL)) {
+            (Four) edubtm_UnfixPage(&pid, slot != NIL);
+            ERRBPATH(eBADBTREEPAGE_BTM, &path);
+        }
+
+        edubtm_BinarySearchInternal(&apage->bi, handle, &keys[order[0]], &idx);
+        edubtm_NarrowFinger(handle, &pid, &apage->bi, idx);
+
+        e = edubtm_PushPath(&path, &pid, apage, slot != NIL, idx);
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&pid, slot != NIL);
+            ERRBPATH(e, &path);
+        }
+
+        if (BTM_SAFE_FOR_INSERT(&apage->bi)) {
+            e = edubtm_ReleaseAncestors(&path);
+            if (e < 0) ERRBPATH(e, &path);
+        }
+
+        /* the run of the child ends before the key of the next entry */
+        if (idx + 1 < apage->bi.hdr.nSlots) {
+            iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-(idx + 1)]];
+            for (i = 1; i < m && BTM_KEYCOMPARE(handle, &keys[order[i]], (KeyValue*)&iEntry->klen) == LESS; i++);
+            m = i;
+        }
+
+        if (idx == -1)
+            pid.pageNo = apage->bi.hdr.p0;
+        else {
+            iEntry = (btm_InternalEntry*)&apage->bi.data[apage->bi.slot[-idx]];
+            pid.pageNo = iEntry->spid;
+        }
+    }
+
+    /*@ insert the run into the leaf page */
+    edubtm_SetFingerLeaf(handle, &pid);
+
+    do {
+        i = order[*nDone];
+        e = edubtm_InsertLeaf(handle, &pid, &apage->bl, &keys[i], &oids[i], FALSE, &lf, h, item);
+        if (e < 0) {
+            (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+            ERRBPATH(e, &path);
+        }
+        (*nDone)++;
+    } while (*nDone < m && !*h && !IS_NILPAGEID(handle->finger.leaf));
+
+    e = BfM_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) {
+        (Four) BfM_FreeTrain(&pid, PAGE_BUF);
+        ERRBPATH(e, &path);
+    }
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERRBPATH(e, &path);
+
+    /*@ insert the items of the splitted pages into their parents */
+    e = edubtm_PropagateSplit(handle, &path, h, item);
+    if (e < 0) ERRBPATH(e, &path);
+
+    e = edubtm_FreePath(&path);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_InsertBatch() */
+
+
+
+/*@================================
+ * edubtm_InsertAtFinger()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertAtFinger(BtreeHandle*, KeyValue*, ObjectID*,
+ *                                   Boolean, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Insert an ObjectID with the given key, which is in the range of the
+ *  finger of 'handle', into the leaf of the finger without descending from
+ *  the root. If the leaf is splitted, the new items go up the path of the
+ *  finger as they would return from edubtm_Insert(). 'replace' is as for
+ *  edubtm_Insert().
+ *
+ * Returns:
+ *  Error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) h : TRUE if the root is splitted
+ *  2) item : item to be inserted into the new root when 'h' is TRUE
+ */
+Four edubtm_InsertAtFinger(
+    BtreeHandle                 *handle,        /* IN opened index */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid,           /* IN ObjectID which will be inserted */
+    Boolean                     replace,        /* IN TRUE if an existing key takes 'oid' */
+    Boolean                     *h,             /* OUT whether the root is splitted */
+    InternalItem                *item)          /* OUT Internal Item which will be inserted */
+                                                /*     into the new root when 'h' is TRUE */
+{
+    Four                        e;              /* error number */
+    Two                         level;          /* level of a page on the path */
+    Boolean                     lf;             /* whether an overflow page is created */
+    PageID                      pid;            /* the leaf of the finger */
+    BtreePage                   *apage;         /* buffer of the leaf */
+    BtreePath                   path;           /* the path of the finger */
+
+
+    /* a split invalidates the finger, so its path is saved first; its pages are fixed only if reached */
+    path.height = handle->finger.height;
+    path.nRightmost = handle->finger.nRightmost;
+    for (level = 0; level < path.height; level++) {
+        path.pid[level] = handle->finger.path[level];
+        path.page[level] = NULL;
+    }
+    pid = handle->finger.leaf;
+
+    e = BfM_GetTrain(&pid, (char**)&apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    e = edubtm_InsertLeaf(handle, &pid, &apage->bl, kval, oid, replace, &lf, h, item);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    e = edubtm_PropagateSplit(handle, &path, h, item);
+    if (e < 0) ERRBPATH(e, &path);
+
+    e = edubtm_FreePath(&path);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_InsertAtFinger() */
+
+
+
 /*@================================
  * edubtm_InsertLeaf()
  *================================*/
 /*
- * Function: Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*,
- *                               KeyValue*, ObjectID*, Boolean*, Boolean*,
- *                               InternalItem*)
+ * Function: Four edubtm_InsertLeaf(BtreeHandle*, PageID*, BtreeLeaf*,
+ *                               KeyValue*, ObjectID*, Boolean, Boolean*,
+ *                               Boolean*, InternalItem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -177,6 +483,10 @@ Four edubtm_Insert(
  *
  *  Insert into the given leaf page an ObjectID with the given key.
  *
+ *  If 'replace' is TRUE and a unique index has the key already, the only
+ *  ObjectID of its entry is overwritten with 'oid' in place; the entry keeps
+ *  its length, so the page is neither splitted nor compacted.
+ *
  * Returns:
  *  Error code
  *    eDUPLICATEDKEY_BTM
@@ -189,12 +499,12 @@ Four edubtm_Insert(
  *  3) item : item to be inserted into the parent
  */
 Four edubtm_InsertLeaf(
-    ObjectID                    *catObjForFile, /* IN catalog object of B+-tree file */
+    BtreeHandle                 *handle,        /* IN opened index */
     PageID                      *pid,           /* IN PageID of Leag Page */
     BtreeLeaf                   *page,          /* INOUT pointer to buffer page of Leaf page */
-    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
     KeyValue                    *kval,          /* IN key value */
     ObjectID                    *oid,           /* IN ObjectID which will be inserted */
+    Boolean                     replace,        /* IN TRUE if an existing key takes 'oid' */
     Boolean                     *f,             /* OUT whether it is merged by creating */
                                                 /*     a new overflow page */
     Boolean                     *h,             /* OUT whether it is splitted */
@@ -204,75 +514,110 @@ Four edubtm_InsertLeaf(
     Four                        e;              /* error number */
     Two                         i;
     Two                         idx;            /* index for the given key value */
-    LeafItem                    leaf;           /* a Leaf Item */
     Boolean                     found;          /* search result */
     btm_LeafEntry               *entry;         /* an entry in a leaf page */
     Two                         entryOffset;    /* start position of an entry */
     Two                         alignedKlen;    /* aligned length of the key length */
+    Two                         klen;           /* length of the key part stored in the entry */
+    char                        *keyPart;       /* key part stored in the entry */
     PageID                      ovPid;          /* PageID of an overflow page */
     Two                         entryLen;       /* length of an entry */
     ObjectID                    *oidArray;      /* an array of ObjectIDs */
     Two                         oidArrayElemNo; /* an index for the ObjectID array */
+    ALIGN_TYPE                  entryBuf[PAGESIZE/sizeof(ALIGN_TYPE)]; /* the entry inserted by a split */
 
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
 
     
     /*@ Initially the flags are FALSE */
     *h = *f = FALSE;
 
+    /* the hot keys taken from this page are void, even if it is not changed after all */
+    BTM_LEAF_CHANGED(handle, pid->pageNo);
+
+    /* An empty page, e.g. the root of a new index, takes the format of the index. */
+    if (page->hdr.nSlots == 0)
+        edubtm_BuildLeafPage(handle, page, NULL, 0, BTM_LEAF_FORMAT(handle, page));
+
     /*Insert a new index entry into a leaf page, and if split occurs, return the internal
 index entry pointing to the new leaf page created by the split.*/
 
-    found = edubtm_BinarySearchLeaf(page, kdesc, kval, &idx); // idx tells us where to insert kval in slot Array 
-    if(found) ERR(eDUPLICATEDKEY_BTM);
-    /*Calculate the size of free area required for inserting the new index entry.*/
-    alignedKlen = ALIGNED_LENGTH(kval->len);
-    entryLen = BTM_LEAFENTRY_FIXED + alignedKlen + sizeof(ObjectID);
+    found = edubtm_BinarySearchLeaf(page, handle, kval, &idx); /* the new entry goes to slot idx+1 */
+    if(found) {
+        if ((handle->kdesc.flag & KEYFLAG_UNIQUE) && replace) {
+            if (page->hdr.denseKeyLen != 0)
+                *BL_DENSE_OID(page, idx) = *oid;
+            else {
+                entry = (btm_LeafEntry*)&page->data[BL_SLOT(page, idx)];
+                memcpy(BTM_LEAFENTRY_OBJECTS(entry), oid, OBJECTID_SIZE);
+            }
+
+            return(eNOERROR);
+        }
+
+        if (handle->kdesc.flag & KEYFLAG_UNIQUE) ERR(eDUPLICATEDKEY_BTM);
+
+        /* the ObjectID joins the entry of its key */
+        e = edubtm_InsertDuplicate(handle, pid, page, idx, oid, h, item);
+        if(e<0) ERR(e);
 
-    /*If there is available free area in the page*/
-    if (BL_CFREE(page) > entryLen + sizeof(Two)){
+        return(eNOERROR);
+    }
+
+    /* a new entry is made for the key */
+    edubtm_BloomAdd(handle, kval);
+
+    /* On a prefix compressed page only the rest of the string after the page prefix is stored. */
+    if (page->hdr.prefixLen == NIL) {
+        keyPart = kval->val;
+        klen = kval->len;
+    }
+    else {
+        keyPart = &kval->val[sizeof(Two) + page->hdr.prefixLen];
+        klen = kval->len - sizeof(Two) - page->hdr.prefixLen;
+    }
+
+    /*Calculate the size of free area required for inserting the new index entry.*/
+    alignedKlen = ALIGNED_LENGTH(klen);
+    entryLen = BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;
+
+    /*
+     * If there is available free area in the page. A key not sharing the
+     * prefix of a compressed page makes the page be rebuilt by the split.
+     */
+    if (page->hdr.denseKeyLen != 0 && page->hdr.nSlots < BL_DENSE_MAXENTRIES(page)) {
+        edubtm_InsertDenseEntry(page, idx+1, kval->val, oid);
+    }
+    else if (page->hdr.denseKeyLen == 0 && klen >= 0 && (page->hdr.prefixLen == NIL || memcmp(&kval->val[sizeof(Two)], page->data, page->hdr.prefixLen) == 0) &&
+        BL_FREE(page) >= entryLen + BL_SLOTSIZE(page)){
         /*Compact the page if necessary.*/
-        if (BL_CFREE(page) < entryLen + sizeof(Two)){
+        if (BL_CFREE(page) < entryLen + BL_SLOTSIZE(page))
             edubtm_CompactLeafPage(page, NIL);
-            entryOffset = page->hdr.free;
-        }
-        else{
-            entryOffset = page->hdr.free;
-        }
+
         /*Insert the new index entry with the slot number determined.*/
-        // we first shift all the slots to the right by one
-        for (i = page->hdr.nSlots - 1; i > idx; --i) {
-            page->slot[-i - 1] = page->slot[-i];
-        }
-        // a new slot is available
-        page->slot[-idx -1] = page->hdr.free;
+        memmove(BL_SLOTPTR(page, page->hdr.nSlots), BL_SLOTPTR(page, page->hdr.nSlots - 1),
+                (page->hdr.nSlots - 1 - idx) * BL_SLOTSIZE(page));
+
         entryOffset = page->hdr.free;
-        entry = &page->data[entryOffset];
+        entry = (btm_LeafEntry*)&page->data[entryOffset];
         entry->nObjects = 1;
-        entry->klen = kval->len;
-        memcpy(entry->kval, kval->val, kval->len);
-        *(ObjectID*)(&entry->kval[alignedKlen])= *oid;
+        entry->klen = klen;
+        memcpy(entry->kval, keyPart, klen);
+        memcpy(&entry->kval[alignedKlen], oid, OBJECTID_SIZE);
+        edubtm_SetLeafSlot(handle, page, idx+1, entryOffset);
+
         page->hdr.free += entryLen;
         page->hdr.nSlots++;
-
-
     }
-    else { /*If there is no available free area in the page (page overflow), Call edubtm_SplitLeaf() to split the page. Return the internal index entry pointing to the new leaf page created by the*/
-        // we have to initialize a leaf object 
-        leaf.oid = *oid;
-        leaf.nObjects = 1;
-        leaf.klen = kval->len;
-        memcpy(leaf.kval, kval->val, kval->len);
-        e = edubtm_SplitLeaf(catObjForFile,pid, page, idx, &leaf, item); // Split Leaf will update the page and return the item to be inserted into the parent
-        if(e<0) ERR(e);
-        *h = TRUE;
+    else { /*If there is no available free area in the page (page overflow), split the page and return the internal index entry pointing to the new leaf page.*/
+        entry = (btm_LeafEntry*)entryBuf;
+        entry->nObjects = 1;
+        entry->klen = kval->len;
+        memcpy(entry->kval, kval->val, kval->len);
+        memcpy(BTM_LEAFENTRY_OBJECTS(entry), oid, OBJECTID_SIZE);
 
+        e = edubtm_SplitLeaf(handle, pid, page, idx, entry, h, item);
+        if(e<0) ERR(e);
     }
 
     return(eNOERROR);
@@ -281,11 +626,124 @@ index entry pointing to the new leaf page created by the split.*/
 
 
 
+/*@================================
+ * edubtm_InsertDuplicate()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertDuplicate(BtreeHandle*, PageID*, BtreeLeaf*, Two,
+ *                                    ObjectID*, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Insert 'oid' into the ObjectIDs of the entry in the slot 'slotNo' of
+ *  'page' of a non-unique index. The ObjectIDs of an entry which would
+ *  grow beyond OVERFLOW_SPLIT move to an overflow page. An entry growing
+ *  in the page is moved to the end of the data area; if the page has no
+ *  room for it, the entry is taken out and inserted again by a split.
+ *
+ * Returns:
+ *  Error code
+ *    eDUPLICATEDOBJECTID_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) h : TRUE if the leaf page is splitted by inserting the given ObjectID
+ *  2) item : item to be inserted into the parent
+ */
+Four edubtm_InsertDuplicate(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *pid,           /* IN PageID of the leaf page */
+    BtreeLeaf                   *page,          /* INOUT pointer to buffer page of the leaf page */
+    Two                         slotNo,         /* IN slot of the entry of the key */
+    ObjectID                    *oid,           /* IN ObjectID which will be inserted */
+    Boolean                     *h,             /* OUT whether it is splitted */
+    InternalItem                *item)          /* OUT Internal Item which will be inserted */
+                                                /*     into its parent when 'h' is TRUE */
+{
+    Four                        e;              /* error number */
+    Two                         n;              /* # of ObjectIDs of the entry */
+    Two                         idx;            /* the ObjectID goes after element 'idx' */
+    Two                         entryOffset;    /* starting offset of the entry */
+    Two                         entryLen;       /* length of the entry */
+    PageID                      ovPid;          /* the first overflow page of the entry */
+    KeyValue                    key;            /* full key of the entry */
+    btm_LeafEntry               *entry;         /* the entry of the key */
+    btm_LeafEntry               *newEntry;      /* the grown entry inserted by a split */
+    ObjectID                    *oidArray;      /* ObjectIDs of the entry */
+    ALIGN_TYPE                  entryBuf[PAGESIZE/sizeof(ALIGN_TYPE)]; /* buffer of 'newEntry' */
+
+
+    entryOffset = BL_SLOT(page, slotNo);
+    entry = (btm_LeafEntry*)&page->data[entryOffset];
+    n = entry->nObjects;
+
+    if (n == NIL) {
+        MAKE_PAGEID(ovPid, pid->volNo, *(ShortPageID*)BTM_LEAFENTRY_OBJECTS(entry));
+
+        e = edubtm_InsertOverflow(handle, &ovPid, oid);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    oidArray = (ObjectID*)BTM_LEAFENTRY_OBJECTS(entry);
+    if (btm_BinarySearchOidArray(oidArray, oid, n, &idx)) ERR(eDUPLICATEDOBJECTID_BTM);
+
+    entryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(entry->klen) + BTM_OBJECTS_LEN(n);
+
+    if (entryLen + OBJECTID_SIZE > OVERFLOW_SPLIT) {
+        e = edubtm_CreateOverflow(handle, pid, page, slotNo, oid);
+        if (e < 0) ERR(e);
+    }
+    else if (BL_FREE(page) >= OBJECTID_SIZE) {
+        /* the entry grows at the end of the data area */
+        if (entryOffset + entryLen != page->hdr.free || BL_CFREE(page) < OBJECTID_SIZE) {
+            edubtm_CompactLeafPage(page, slotNo);
+            entry = (btm_LeafEntry*)&page->data[BL_SLOT(page, slotNo)];
+            oidArray = (ObjectID*)BTM_LEAFENTRY_OBJECTS(entry);
+        }
+
+        memmove(&oidArray[idx + 2], &oidArray[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+        oidArray[idx + 1] = *oid;
+        entry->nObjects++;
+        page->hdr.free += OBJECTID_SIZE;
+    }
+    else {
+        /* build the grown entry with the full key */
+        edubtm_GetLeafObject(page, slotNo, &key, NULL);
+
+        newEntry = (btm_LeafEntry*)entryBuf;
+        newEntry->nObjects = n + 1;
+        newEntry->klen = key.len;
+        memcpy(newEntry->kval, key.val, key.len);
+        memcpy(BTM_LEAFENTRY_OBJECTS(newEntry), oidArray, (idx + 1) * OBJECTID_SIZE);
+        ((ObjectID*)BTM_LEAFENTRY_OBJECTS(newEntry))[idx + 1] = *oid;
+        memcpy(&((ObjectID*)BTM_LEAFENTRY_OBJECTS(newEntry))[idx + 2], &oidArray[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+
+        /* take the old entry out of the page */
+        memmove(BL_SLOTPTR(page, page->hdr.nSlots - 2), BL_SLOTPTR(page, page->hdr.nSlots - 1),
+                (page->hdr.nSlots - 1 - slotNo) * BL_SLOTSIZE(page));
+        page->hdr.nSlots--;
+
+        if (entryOffset + entryLen == page->hdr.free)
+            page->hdr.free -= entryLen;
+        else
+            page->hdr.unused += entryLen;
+
+        e = edubtm_SplitLeaf(handle, pid, page, slotNo - 1, newEntry, h, item);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_InsertDuplicate() */
+
+
+
 /*@================================
  * edubtm_InsertInternal()
  *================================*/
 /*
- * Function: Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*, Two, Boolean*, InternalItem*)
+ * Function: Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*, Two, Boolean, Boolean*, InternalItem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -294,6 +752,7 @@ index entry pointing to the new leaf page created by the split.*/
  *  This routine insert the given internal item into the given page. If there
  *  is not enough space in the page, it should split the page and the new
  *  internal item should be returned for inserting into the parent.
+ *  'rightmost' tells whether the page is the last one on its level.
  *
  * Returns:
  *  Error code
@@ -309,6 +768,7 @@ Four edubtm_InsertInternal(
     BtreeInternal       *page,          /* INOUT Page Pointer */
     InternalItem        *item,          /* IN Iternal item which is inserted */
     Two                 high,           /* IN index in the given page */
+    Boolean             rightmost,      /* IN TRUE if the page is the last one on its level */
     Boolean             *h,             /* OUT whether the given page is splitted */
     InternalItem        *ritem)         /* OUT if the given page is splitted, the internal item may be returned by 'ritem'. */
 {
@@ -323,38 +783,36 @@ Four edubtm_InsertInternal(
     /*@ Initially the flag are FALSE */
     *h = FALSE;
 
-    // Calculate the size of free area required for inserting the new index entry.
-    entryLen = sizeof(Four) + ALIGNED_LENGTH(item->klen + sizeof(Two));
+    /* Calculate the size of free area required for inserting the new index entry. */
+    entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen);
     
-    //If there is available free area in the page
-    if (BI_FREE(page) > entryLen + sizeof(Two)){
-        if (BI_CFREE(page) < entryLen + sizeof(Two)) {
+    /* If there is available free area in the page */
+    if (BI_FREE(page) >= entryLen + sizeof(Two)){
+        if (BI_CFREE(page) < entryLen + sizeof(Two))
             edubtm_CompactInternalPage(page, NIL);
-            entryOffset = page->hdr.free;
-        }
-        else {
-            entryOffset = page->hdr.free;
-        }
-        //Insert the new index entry with the slot number next to the slot number given as a parameter
-        for (i = page->hdr.nSlots - 1; i > high; i--) {
-            page->slot[-i - 1] = page->slot[-i];
-        }
-        page->slot[-high - 1] = page->hdr.free;
+
+        /* Insert the new index entry with the slot number next to the slot number given as a parameter */
+        for (i = page->hdr.nSlots - 1; i > high; i--)
+            page->slot[-(i+1)] = page->slot[-i];
+
         entryOffset = page->hdr.free;
-        entry = &page->data[entryOffset];
+        page->slot[-(high+1)] = entryOffset;
+
+        entry = (btm_InternalEntry*)&page->data[entryOffset];
         entry->spid = item->spid;
         entry->klen = item->klen;
         memcpy(entry->kval, item->kval, item->klen);
+
         page->hdr.free += entryLen;
         page->hdr.nSlots++;
-
     }
-    else { //there is no available free area in the page (page overflow)
-        e = edubtm_SplitInternal(catObjForFile, page, high, item, ritem);
+    else { /* there is no available free area in the page (page overflow) */
+        e = edubtm_SplitInternal(catObjForFile, page, high, rightmost, item, ritem);
         if(e<0) ERR(e);
-        *h = TRUE;
 
+        *h = TRUE;
     }
+
     return(eNOERROR);
     
 } /* edubtm_InsertInternal() */
@@ -0,0 +1,145 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_KeyHead.c
+ *
+ * Description :
+ *  A leaf page whose 'keyHead' is TRUE keeps, next to the offset of each
+ *  entry, a 4-byte head of the entry's key. Heads compare as unsigned
+ *  integers in the order of the keys, so a binary search decides most
+ *  probes within the slot array and reads the entry only when two heads
+ *  are equal.
+ *
+ * Exports:
+ *  UFour edubtm_LeafKeyHead(BtreeHandle*, BtreeLeaf*, char*, Two)
+ *  void edubtm_SetLeafSlot(BtreeHandle*, BtreeLeaf*, Two, Two)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_LeafKeyHead()
+ *================================*/
+/*
+ * Function: UFour edubtm_LeafKeyHead(BtreeHandle*, BtreeLeaf*, char*, Two)
+ *
+ * Description:
+ *  Return the head of a key whose part stored in 'page' is 'kpart' of length
+ *  'klen', i.e. the suffix after the page prefix on a prefix compressed page.
+ *  If the head of key1 is less than the head of key2, key1 is less than key2.
+ *
+ *  An SM_INT head is the whole key with its sign bit flipped and an
+ *  SM_LONG_LONG head is the upper half of it. An SM_VARSTRING head is the
+ *  first 4 bytes of the string with their sign bit flipped, so that the
+ *  signed byte order of edubtm_VarStringKeyCompare() is kept, padded with 0.
+ *  A normalized key of several parts has its first 4 bytes as its head.
+ *
+ * Returns:
+ *  head of the key
+ */
+UFour edubtm_LeafKeyHead(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeLeaf                   *page,          /* IN leaf page the key part is stored in */
+    char                        *kpart,         /* IN key part */
+    Two                         klen)           /* IN length of the key part */
+{
+    Two                         i;              /* index of a byte */
+    UFour                       head;           /* head of the key */
+    Four_Invariable             i4;             /* 4-byte int key */
+    Eight_Invariable            i8;             /* 8-byte long long key */
+
+
+    if (BTM_NORMALIZED(handle)) {
+        head = 0;
+        for (i = 0; i < BL_KEYHEAD_SIZE; i++)
+            head = (head << 8) | ((i < klen) ? (UOne_Invariable)kpart[i] : 0);
+
+        return(head);
+    }
+
+    switch (handle->kdesc.kpart[0].type) {
+      case SM_INT:
+        memcpy(&i4, kpart, SM_INT_SIZE);
+        return((UFour)i4 ^ 0x80000000);
+
+      case SM_LONG_LONG:
+        memcpy(&i8, kpart, SM_LONG_LONG_SIZE);
+        return((UFour)(((UEight_Invariable)i8 ^ ((UEight_Invariable)1 << 63)) >> 32));
+
+      default:
+        /* a plain entry starts with the 2-byte length of the string */
+        if (page->hdr.prefixLen == NIL) {
+            kpart += sizeof(Two);
+            klen -= sizeof(Two);
+        }
+
+        head = 0;
+        for (i = 0; i < BL_KEYHEAD_SIZE; i++)
+            head = (head << 8) | ((i < klen) ? ((UOne_Invariable)kpart[i] ^ 0x80) : 0);
+
+        return(head);
+    }
+
+} /* edubtm_LeafKeyHead() */
+
+
+
+/*@================================
+ * edubtm_SetLeafSlot()
+ *================================*/
+/*
+ * Function: void edubtm_SetLeafSlot(BtreeHandle*, BtreeLeaf*, Two, Two)
+ *
+ * Description:
+ *  Let the slot 'slotNo' of 'page' point to the entry at 'offset', and store
+ *  the head of its key in the slot if the page keeps key heads.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_SetLeafSlot(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeLeaf                   *page,          /* INOUT leaf page */
+    Two                         slotNo,         /* IN slot No. */
+    Two                         offset)         /* IN offset of the entry */
+{
+    btm_LeafEntry               *entry;         /* the entry */
+    UFour                       head;           /* head of its key */
+
+
+    BL_SLOT(page, slotNo) = offset;
+
+    if (page->hdr.keyHead) {
+        entry = (btm_LeafEntry*)&page->data[offset];
+        head = edubtm_LeafKeyHead(handle, page, entry->kval, entry->klen);
+        memcpy(BL_SLOTPTR(page, slotNo), &head, BL_KEYHEAD_SIZE);
+    }
+
+} /* edubtm_SetLeafSlot() */
@@ -29,7 +29,7 @@
  *  Find the last ObjectID of the given Btree.
  *
  * Exports:
- *  Four edubtm_LastObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*) 
+ *  Four edubtm_LastObject(BtreeHandle*, KeyValue*, Four, BtreeCursor*) 
  */
 
 
@@ -44,7 +44,7 @@
  * edubtm_LastObject()
  *================================*/
 /*
- * Function:  Four edubtm_LastObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*) 
+ * Function:  Four edubtm_LastObject(BtreeHandle*, KeyValue*, Four, BtreeCursor*) 
  *
  * Description : 
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -63,76 +63,76 @@
  *  cursor : the last ObjectID and its position in the Btree
  */
 Four edubtm_LastObject(
-    PageID   		*root,		/* IN the root of Btree */
-    KeyDesc  		*kdesc,		/* IN key descriptor */
+    BtreeHandle		*handle,	/* IN opened index */
     KeyValue 		*stopKval,	/* IN key value of stop condition */
     Four     		stopCompOp,	/* IN comparison operator of stop condition */
     BtreeCursor 	*cursor)	/* OUT the last BtreeCursor to be returned */
 {
-    int			i;
     Four 		e;		/* error number */
     Four 		cmp;		/* result of comparison */
     BtreePage 		*apage;		/* pointer to the buffer holding current page */
+    Two 		level;		/* level of the current page, 0 for the root */
+    Two 		slot;		/* slot of the current page if it is pinned, else NIL */
     BtreeOverflow 	*opage;		/* pointer to the buffer holding overflow page */
     PageID 		curPid;		/* PageID of the current page */
     PageID 		child;		/* PageID of the child page */
     PageID 		ovPid;		/* PageID of the current overflow page */
     PageID 		nextOvPid;	/* PageID of the next overflow page */
-    Two 		lEntryOffset;	/* starting offset of a leaf entry */
     Two 		iEntryOffset;	/* starting offset of an internal entry */
-    btm_LeafEntry 	*lEntry;	/* a leaf entry */
     btm_InternalEntry 	*iEntry;	/* an internal entry */
-    Four 		alignedKlen;	/* aligned length of the key length */
         
 
-    if (root == NULL) ERR(eBADPAGE_BTM);
+    if (handle == NULL) ERR(eBADPARAMETER_BTM);
 
-    /* Error check whether using not supported functionality by EduBtM */
-    for(i=0; i<kdesc->nparts; i++)
-    {
-        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
-            ERR(eNOTSUPPORTED_EDUBTM);
-    }
 
-    /*same resoning as first object, except we retrieve the right most index entry of b+tree*/
-    e = BfM_GetTrain(&root, (char**)&apage, PAGE_BUF);
+    curPid = handle->root;
+    level = 0;
+    e = edubtm_FixPage(handle, &curPid, level, &apage, &slot);
     if(e<0)ERR(e);
-    curPid.pageNo = root->pageNo;
-    curPid.volNo = root->volNo;
-
-    while (apage->any.hdr.type & LEAF == FALSE) {
-        // we choose the last right child until the child is a Leaf page 
-        iEntryOffset = apage->bi.slot[-(apage->bi.hdr.nSlots - 1)];
-        iEntry = (btm_InternalEntry*)&apage->bi.data[iEntryOffset];
-        child.pageNo = iEntry->spid;
-        child.volNo = root->volNo;
-        e = BfM_FreeTrain(&curPid, PAGE_BUF);
+
+    /* Follow the rightmost child down to the rightmost leaf. */
+    while (apage->any.hdr.type & INTERNAL) {
+        if (apage->bi.hdr.nSlots == 0) {
+            MAKE_PAGEID(child, curPid.volNo, apage->bi.hdr.p0);
+        }
+        else {
+            iEntryOffset = apage->bi.slot[-(apage->bi.hdr.nSlots - 1)];
+            iEntry = (btm_InternalEntry*)&apage->bi.data[iEntryOffset];
+            MAKE_PAGEID(child, curPid.volNo, iEntry->spid);
+        }
+
+        e = edubtm_UnfixPage(&curPid, slot != NIL);
         if(e<0)ERR(e);
-        e = BfM_GetTrain(&child, (char**)&apage, PAGE_BUF);
+
+        level++;
+        e = edubtm_FixPage(handle, &child, level, &apage, &slot);
         if(e<0)ERR(e);
+
         curPid = child;
     }
-    // we now have our right leaf page of our  B+ tree
-    lEntryOffset = apage->bl.slot[-(apage->bl.hdr.nSlots - 1)];
-    lEntry = &apage->bl.data[lEntryOffset];
-    alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-    //cursor setup
-    cursor->flag = CURSOR_ON;
-    cursor->key.len = lEntry->klen;
-    memcpy(cursor->key.val, lEntry->kval, lEntry->klen);
-    cursor->leaf = curPid;
-    cursor->slotNo = apage->bl.hdr.nSlots - 1;
-    cursor->oid = *(ObjectID*)&lEntry->kval[alignedKlen];
-
-    cmp = edubtm_KeyCompare(kdesc, &cursor->key, stopKval);
-
-    if (cmp == EQUAL) {
-        cursor->flag = CURSOR_ON;
-        if (stopCompOp == SM_GT) cursor->flag = CURSOR_EOS;
+
+    if (!(apage->any.hdr.type & LEAF)) ERRB1(eBADBTREEPAGE_BTM, &curPid, PAGE_BUF);
+
+    /* Only an empty root can be an empty leaf. */
+    if (apage->bl.hdr.nSlots == 0) {
+        cursor->flag = CURSOR_EOS;
+        e = BfM_FreeTrain(&curPid, PAGE_BUF);
+        if(e<0)ERR(e);
+        return(eNOERROR);
+    }
+
+    e = edubtm_SetCursorObject(&apage->bl, &curPid, apage->bl.hdr.nSlots - 1, TRUE, cursor);
+    if(e<0) ERRB1(e, &curPid, PAGE_BUF);
+
+    /* Check the stop condition */
+    if (stopCompOp != SM_EOF && stopCompOp != SM_BOF) {
+        cmp = BTM_KEYCOMPARE(handle, &cursor->key, stopKval);
+
+        /* the scan starts from the largest key: only a stop key above it ends the scan */
+        if (cmp == LESS || (cmp == EQUAL && stopCompOp == SM_GT))
+            cursor->flag = CURSOR_EOS;
     }
-    else if (cmp == GREATER) cursor->flag = CURSOR_ON;
-    else if (cmp == LESS) cursor->flag = CURSOR_EOS;
-    
+
     e = BfM_FreeTrain(&curPid, PAGE_BUF);
     if(e<0)ERR(e);
 
@@ -0,0 +1,230 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_LeafHash.c
+ *
+ * Description :
+ *  Under repeated point access a few leaves take most SM_EQ probes, and
+ *  each probe descends all internal levels to reach them. An opened index
+ *  may map the keys of its hot leaves to the leaves (see
+ *  EduBtM_HashHotLeaves()), each key in the entry chosen by its hash; a
+ *  probe of a mapped key starts at the leaf, first trying the slot where
+ *  the key was last seen.
+ *
+ *  A leaf is hot once SM_EQ descents have reached it BTM_HOTLEAF times;
+ *  the keys found in it from then on are mapped to it. The entries are
+ *  allocated when the first leaf gets hot, so an index without hot leaves
+ *  takes no memory for them. A mapped key stays
+ *  in the range of its leaf until the leaf is split, merged or
+ *  redistributed, so inserts and deletes in the leaf leave the mapping
+ *  valid; only the slot may have to be searched again, and it is then
+ *  repaired. The moves of entries bump the shape of the leaves
+ *  (BTM_LEAF_MOVED()), which voids the keys mapped to them; as for the
+ *  versions of the hot keys, leaves whose page numbers are equal modulo
+ *  BTM_LEAFVERSIONS share a shape. Changes which free or move leaves
+ *  wholesale clear all entries instead.
+ *
+ * Exports:
+ *  void edubtm_ClearLeafHints(BtreeHandle*)
+ *  Boolean edubtm_LookUpLeafHint(BtreeHandle*, KeyValue*, PageID*, Two*)
+ *  void edubtm_KeepLeafHint(BtreeHandle*, KeyValue*, BtreeCursor*)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+BtreeLeafHint *edubtm_LeafHintEntry(BtreeLeafHash*, KeyValue*);
+
+
+
+/*@================================
+ * edubtm_ClearLeafHints()
+ *================================*/
+/*
+ * Function: void edubtm_ClearLeafHints(BtreeHandle*)
+ *
+ * Description:
+ *  Void all entries mapping keys of 'handle' to leaves.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_ClearLeafHints(
+    BtreeHandle         *handle)        /* INOUT opened index */
+{
+    Four                i;              /* index of an entry */
+
+
+    if (handle->leafHash.entry == NULL) return;
+
+    for (i = 0; i < handle->leafHash.nEntries; i++)
+        handle->leafHash.entry[i].klen = NIL;
+
+} /* edubtm_ClearLeafHints() */
+
+
+
+/*@================================
+ * edubtm_LookUpLeafHint()
+ *================================*/
+/*
+ * Function: Boolean edubtm_LookUpLeafHint(BtreeHandle*, KeyValue*, PageID*, Two*)
+ *
+ * Description:
+ *  Find the leaf to which the key 'kval' is mapped, if it is.
+ *
+ * Returns:
+ *  TRUE if the key is mapped to a leaf
+ *
+ * Side effects:
+ *  1) leaf : the leaf of the key
+ *  2) slotNo : the slot where the key was last seen in the leaf
+ */
+Boolean edubtm_LookUpLeafHint(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval,          /* IN key value probed */
+    PageID              *leaf,          /* OUT the leaf of the key */
+    Two                 *slotNo)        /* OUT slot of the key in the leaf */
+{
+    BtreeLeafHint       *entry;         /* the entry for the key */
+
+
+    entry = edubtm_LeafHintEntry(&handle->leafHash, kval);
+
+    if (entry == NULL || entry->klen != kval->len || memcmp(entry->kval, kval->val, kval->len) != 0 ||
+        entry->shape != BTM_LEAF_SHAPE(handle, entry->leaf)) {
+        if (handle->leafHash.nEntries > 0 && kval->len <= BTM_HOTKEYLEN) handle->leafHash.nMisses++;
+        return(FALSE);
+    }
+
+    MAKE_PAGEID(*leaf, handle->root.volNo, entry->leaf);
+    *slotNo = entry->slotNo;
+    entry->used = TRUE;
+
+    handle->leafHash.nHits++;
+
+    return(TRUE);
+
+} /* edubtm_LookUpLeafHint() */
+
+
+
+/*@================================
+ * edubtm_KeepLeafHint()
+ *================================*/
+/*
+ * Function: void edubtm_KeepLeafHint(BtreeHandle*, KeyValue*, BtreeCursor*)
+ *
+ * Description:
+ *  Note that an SM_EQ probe of the key 'kval' has found it at 'cursor',
+ *  and map the key to the leaf of the cursor if the leaf is hot. A key
+ *  already mapped has its slot repaired; a valid entry of another key is
+ *  taken only if it has not been used since it was made or last spared.
+ *  The entries are allocated when the first leaf gets hot; if they cannot
+ *  be, no key is mapped from then on.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_KeepLeafHint(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    KeyValue            *kval,          /* IN key value probed */
+    BtreeCursor         *cursor)        /* IN cursor on the key */
+{
+    BtreeLeafHint       *entry;         /* the entry for the key */
+    Four                i;              /* index of an entry */
+
+
+    if (handle->leafHash.nEntries == 0 || kval->len > BTM_HOTKEYLEN) return;
+
+    if (BTM_LEAF_HEAT(handle, cursor->leaf.pageNo) < BTM_HOTLEAF) {
+        BTM_LEAF_HEAT(handle, cursor->leaf.pageNo)++;
+        return;
+    }
+
+    if (handle->leafHash.entry == NULL) {
+        handle->leafHash.entry = (BtreeLeafHint*)malloc(handle->leafHash.nEntries * sizeof(BtreeLeafHint));
+        if (handle->leafHash.entry == NULL) {
+            handle->leafHash.nEntries = 0;
+            return;
+        }
+        for (i = 0; i < handle->leafHash.nEntries; i++)
+            handle->leafHash.entry[i].klen = NIL;
+    }
+
+    entry = edubtm_LeafHintEntry(&handle->leafHash, kval);
+
+    /* keys hashed to the same entry take turns only if neither is probed often */
+    if (entry->klen != NIL && entry->shape == BTM_LEAF_SHAPE(handle, entry->leaf) && entry->used &&
+        (entry->klen != kval->len || memcmp(entry->kval, kval->val, kval->len) != 0)) {
+        entry->used = FALSE;
+        return;
+    }
+
+    entry->klen = kval->len;
+    memcpy(entry->kval, kval->val, kval->len);
+    entry->leaf = cursor->leaf.pageNo;
+    entry->slotNo = cursor->slotNo;
+    entry->shape = BTM_LEAF_SHAPE(handle, entry->leaf);
+    entry->used = FALSE;
+
+} /* edubtm_KeepLeafHint() */
+
+
+
+/*@================================
+ * edubtm_LeafHintEntry()
+ *================================*/
+/*
+ * Function: BtreeLeafHint *edubtm_LeafHintEntry(BtreeLeafHash*, KeyValue*)
+ *
+ * Description:
+ *  Choose the entry for the key 'kval' by the FNV-1a hash of its bytes.
+ *
+ * Returns:
+ *  the entry, NULL if no key is mapped or the key is too long to be mapped
+ */
+BtreeLeafHint *edubtm_LeafHintEntry(
+    BtreeLeafHash       *leafHash,      /* IN the keys mapped to hot leaves */
+    KeyValue            *kval)          /* IN key value */
+{
+    Two                 i;              /* index of a byte of the key */
+    unsigned int        hash;           /* hash value of the key */
+
+
+    if (leafHash->entry == NULL || kval->len > BTM_HOTKEYLEN) return(NULL);
+
+    hash = 2166136261U;
+    for (i = 0; i < kval->len; i++)
+        hash = (hash ^ (unsigned char)kval->val[i]) * 16777619U;
+
+    return(&leafHash->entry[hash % leafHash->nEntries]);
+
+} /* edubtm_LeafHintEntry() */
@@ -0,0 +1,216 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Normalize.c
+ *
+ * Description :
+ *  A key made of several parts is given by the user as its parts one after
+ *  another: an SM_INT in 4 bytes, an SM_LONG_LONG in 8 bytes and an
+ *  SM_VARSTRING as its 2-byte length followed by the string. Such a key is
+ *  normalized before it enters the B+ tree into a byte string whose order
+ *  under memcmp() is the order of the keys, so that the pages compare keys
+ *  of any key descriptor by edubtm_NormalizedKeyCompare(). Keys returned to
+ *  the user are denormalized again.
+ *
+ *  An integer part is normalized to its big endian bytes with the sign bit
+ *  flipped. Each byte of a string part is stored with its sign bit flipped,
+ *  as in edubtm_VarStringKeyCompare(), where 0x00 is escaped to 0x00 0xFF,
+ *  and the string is terminated by 0x00 0x00; a string thus sorts before
+ *  every longer string starting with it, whatever parts follow.
+ *
+ * Exports:
+ *  Four edubtm_NormalizeKey(KeyDesc*, KeyValue*, KeyValue*)
+ *  void edubtm_DenormalizeKey(KeyDesc*, KeyValue*, KeyValue*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_NormalizeKey()
+ *================================*/
+/*
+ * Function: Four edubtm_NormalizeKey(KeyDesc*, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Normalize the user key 'kval' described by 'kdesc' into 'nkval'.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM : 'kval' does not match 'kdesc' or is too long
+ *                        when normalized
+ */
+Four edubtm_NormalizeKey(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *kval,          /* IN key value given by the user */
+    KeyValue                    *nkval)         /* OUT normalized key value */
+{
+    Two                         i;              /* index of a key part */
+    Two                         j;              /* index of a byte */
+    Two                         pos;            /* position in 'kval' */
+    Two                         len;            /* length of 'nkval' */
+    Two                         strLen;         /* length of a string part */
+    Two                         size;           /* size of an integer part */
+    Four_Invariable             i4;             /* 4-byte int part */
+    Eight_Invariable            i8;             /* 8-byte long long part */
+    UEight_Invariable           u;              /* integer part with its sign bit flipped */
+    UOne_Invariable             c;              /* a byte of a string part */
+
+
+    pos = 0;
+    len = 0;
+
+    for (i = 0; i < kdesc->nparts; i++) {
+
+        if (kdesc->kpart[i].type == SM_VARSTRING) {
+            if (pos + (Two)sizeof(Two) > kval->len) ERR(eBADPARAMETER_BTM);
+            memcpy(&strLen, &kval->val[pos], sizeof(Two));
+            pos += sizeof(Two);
+
+            if (strLen < 0 || pos + strLen > kval->len) ERR(eBADPARAMETER_BTM);
+
+            for (j = 0; j < strLen; j++) {
+                if (len + 2 > MAXKEYLEN) ERR(eBADPARAMETER_BTM);
+
+                c = (UOne_Invariable)kval->val[pos + j] ^ 0x80;
+                nkval->val[len++] = c;
+                if (c == 0x00) nkval->val[len++] = (char)0xFF;
+            }
+            pos += strLen;
+
+            if (len + 2 > MAXKEYLEN) ERR(eBADPARAMETER_BTM);
+            nkval->val[len++] = 0x00;
+            nkval->val[len++] = 0x00;
+
+            continue;
+        }
+
+        if (kdesc->kpart[i].type == SM_INT) {
+            size = SM_INT_SIZE;
+            if (pos + size > kval->len) ERR(eBADPARAMETER_BTM);
+            memcpy(&i4, &kval->val[pos], size);
+            u = (UFour)i4 ^ 0x80000000;
+        }
+        else {
+            size = SM_LONG_LONG_SIZE;
+            if (pos + size > kval->len) ERR(eBADPARAMETER_BTM);
+            memcpy(&i8, &kval->val[pos], size);
+            u = (UEight_Invariable)i8 ^ ((UEight_Invariable)1 << 63);
+        }
+        pos += size;
+
+        if (len + size > MAXKEYLEN) ERR(eBADPARAMETER_BTM);
+        for (j = size - 1; j >= 0; j--, u >>= 8)
+            nkval->val[len + j] = (char)(u & 0xFF);
+        len += size;
+    }
+
+    if (pos != kval->len) ERR(eBADPARAMETER_BTM);
+
+    nkval->len = len;
+
+    return(eNOERROR);
+
+} /* edubtm_NormalizeKey() */
+
+
+
+/*@================================
+ * edubtm_DenormalizeKey()
+ *================================*/
+/*
+ * Function: void edubtm_DenormalizeKey(KeyDesc*, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Restore into 'kval' the user key of the normalized key 'nkval' described
+ *  by 'kdesc'. 'nkval' and 'kval' may be the same.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_DenormalizeKey(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *nkval,         /* IN normalized key value */
+    KeyValue                    *kval)          /* OUT key value for the user */
+{
+    Two                         i;              /* index of a key part */
+    Two                         j;              /* index of a byte */
+    Two                         pos;            /* position in 'nkval' */
+    Two                         strPos;         /* position of a string part in 'key' */
+    Two                         strLen;         /* length of a string part */
+    Two                         size;           /* size of an integer part */
+    Four_Invariable             i4;             /* 4-byte int part */
+    Eight_Invariable            i8;             /* 8-byte long long part */
+    UEight_Invariable           u;              /* integer part with its sign bit flipped */
+    UOne_Invariable             c;              /* a byte of a string part */
+    KeyValue                    key;            /* the key being restored */
+
+
+    pos = 0;
+    key.len = 0;
+
+    for (i = 0; i < kdesc->nparts; i++) {
+
+        if (kdesc->kpart[i].type == SM_VARSTRING) {
+            strPos = key.len;
+            key.len += sizeof(Two);
+
+            for (;;) {
+                c = (UOne_Invariable)nkval->val[pos++];
+                if (c == 0x00 && (UOne_Invariable)nkval->val[pos++] == 0x00) break;
+
+                key.val[key.len++] = (char)(c ^ 0x80);
+            }
+
+            strLen = key.len - strPos - sizeof(Two);
+            memcpy(&key.val[strPos], &strLen, sizeof(Two));
+
+            continue;
+        }
+
+        size = (kdesc->kpart[i].type == SM_INT) ? SM_INT_SIZE : SM_LONG_LONG_SIZE;
+
+        for (u = 0, j = 0; j < size; j++)
+            u = (u << 8) | (UOne_Invariable)nkval->val[pos++];
+
+        if (size == SM_INT_SIZE) {
+            i4 = (Four_Invariable)((UFour)u ^ 0x80000000);
+            memcpy(&key.val[key.len], &i4, size);
+        }
+        else {
+            i8 = (Eight_Invariable)(u ^ ((UEight_Invariable)1 << 63));
+            memcpy(&key.val[key.len], &i8, size);
+        }
+        key.len += size;
+    }
+
+    kval->len = key.len;
+    memcpy(kval->val, key.val, key.len);
+
+} /* edubtm_DenormalizeKey() */
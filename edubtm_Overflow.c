@@ -0,0 +1,713 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Overflow.c
+ *
+ * Description :
+ *  The ObjectIDs of a key of a non-unique index are kept in its leaf entry
+ *  as a sorted array. When the entry would grow beyond OVERFLOW_SPLIT, they
+ *  move to a doubly linked chain of overflow pages, each of which holds a
+ *  sorted array of ObjectIDs greater than those of the previous page, and
+ *  the entry keeps only the first page of the chain (see btm_LeafEntry).
+ *  The functions in this file maintain such chains and move a cursor over
+ *  the ObjectIDs of one entry.
+ *
+ * Exports:
+ *  Four edubtm_CreateOverflow(BtreeHandle*, PageID*, BtreeLeaf*, Two, ObjectID*)
+ *  Four edubtm_InsertOverflow(BtreeHandle*, PageID*, ObjectID*)
+ *  Four edubtm_DeleteOverflow(PageID*, ObjectID*, Two, ObjectID*, Two*, Pool*, DeallocListElem*)
+ *  Four edubtm_FreeOverflow(PageID*, Pool*, DeallocListElem*)
+ *  Four edubtm_SetCursorObject(BtreeLeaf*, PageID*, Two, Boolean, BtreeCursor*)
+ *  Four edubtm_NextObjectOfEntry(BtreeLeaf*, BtreeCursor*, Boolean, BtreeCursor*, Boolean*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_FindOverflowPage(PageID*, ObjectID*, PageID*, BtreeOverflow**);
+Four edubtm_UnlinkOverflow(PageID*, PageID*, BtreeOverflow*, Pool*, DeallocListElem*);
+
+
+
+/*@================================
+ * edubtm_CreateOverflow()
+ *================================*/
+/*
+ * Function: Four edubtm_CreateOverflow(BtreeHandle*, PageID*, BtreeLeaf*, Two, ObjectID*)
+ *
+ * Description:
+ * (Following description is for original ODYSSEUS/COSMOS BtM.
+ *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
+ *
+ *  Move the ObjectIDs of the entry in the slot 'slotNo' of 'page' together
+ *  with 'oid' to a new overflow page, and let the entry point to the page.
+ *  The space the entry no longer takes is freed in 'page'.
+ *
+ * Returns:
+ *  error code
+ *    eDUPLICATEDOBJECTID_BTM
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for 'page'.
+ */
+Four edubtm_CreateOverflow(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *pid,           /* IN PageID of the leaf page */
+    BtreeLeaf                   *page,          /* INOUT the leaf page */
+    Two                         slotNo,         /* IN slot of the entry */
+    ObjectID                    *oid)           /* IN ObjectID to be inserted */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* the ObjectID goes after element 'idx' */
+    Two                         n;              /* # of ObjectIDs of the entry */
+    Two                         entryOffset;    /* starting offset of the entry */
+    Two                         entryLen;       /* length of the entry before */
+    Two                         newLen;         /* length of the entry after */
+    PageID                      ovPid;          /* the new overflow page */
+    BtreeOverflow               *opage;         /* buffer of the overflow page */
+    btm_LeafEntry               *entry;         /* the leaf entry */
+    ObjectID                    *oidArray;      /* ObjectIDs of the entry */
+
+
+    entryOffset = BL_SLOT(page, slotNo);
+    entry = (btm_LeafEntry*)&page->data[entryOffset];
+    oidArray = (ObjectID*)BTM_LEAFENTRY_OBJECTS(entry);
+    n = entry->nObjects;
+
+    if (btm_BinarySearchOidArray(oidArray, oid, n, &idx)) ERR(eDUPLICATEDOBJECTID_BTM);
+
+    e = btm_AllocPage(&handle->catObjForFile, pid, &ovPid);
+    if (e < 0) ERR(e);
+
+    e = edubtm_InitOverflow(&ovPid);
+    if (e < 0) ERR(e);
+
+    e = BfM_GetTrain(&ovPid, (char**)&opage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    memcpy(opage->oid, oidArray, (idx + 1) * OBJECTID_SIZE);
+    opage->oid[idx + 1] = *oid;
+    memcpy(&opage->oid[idx + 2], &oidArray[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+    opage->hdr.nObjects = n + 1;
+
+    e = BfM_SetDirty(&ovPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &ovPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&ovPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    /*@ the entry keeps only the first overflow page */
+    entryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(entry->klen) + BTM_OBJECTS_LEN(n);
+    entry->nObjects = NIL;
+    *(ShortPageID*)BTM_LEAFENTRY_OBJECTS(entry) = ovPid.pageNo;
+    newLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(entry->klen) + BTM_OBJECTS_LEN(NIL);
+
+    if (entryOffset + entryLen == page->hdr.free)
+        page->hdr.free -= entryLen - newLen;
+    else
+        page->hdr.unused += entryLen - newLen;
+
+    return(eNOERROR);
+
+} /* edubtm_CreateOverflow() */
+
+
+
+/*@================================
+ * edubtm_InsertOverflow()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertOverflow(BtreeHandle*, PageID*, ObjectID*)
+ *
+ * Description:
+ * (Following description is for original ODYSSEUS/COSMOS BtM.
+ *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
+ *
+ *  Insert 'oid' into the overflow chain starting at 'first'. A full page is
+ *  splitted by halves, except that an ObjectID appended after the last one
+ *  of the chain starts a new page, so that ObjectIDs inserted in increasing
+ *  order fill the pages up. The first page of the chain does not change.
+ *
+ * Returns:
+ *  error code
+ *    eDUPLICATEDOBJECTID_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_InsertOverflow(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *first,         /* IN the first page of the chain */
+    ObjectID                    *oid)           /* IN ObjectID to be inserted */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* the ObjectID goes after element 'idx' */
+    Two                         n;              /* # of ObjectIDs of the page */
+    Two                         s;              /* # of ObjectIDs staying in the page */
+    PageID                      pid;            /* the page taking 'oid' */
+    PageID                      newPid;         /* a new overflow page */
+    PageID                      nextPid;        /* the page following the new page */
+    BtreeOverflow               *opage;         /* buffer of the page 'pid' */
+    BtreeOverflow               *npage;         /* buffer of the new page */
+    BtreeOverflow               *mpage;         /* buffer of the page 'nextPid' */
+    ObjectID                    oids[BO_MAXOBJECTIDS+1]; /* ObjectIDs of a splitted page and 'oid' */
+
+
+    e = edubtm_FindOverflowPage(first, oid, &pid, &opage);
+    if (e < 0) ERR(e);
+
+    n = opage->hdr.nObjects;
+    if (btm_BinarySearchOidArray(opage->oid, oid, n, &idx)) ERRB1(eDUPLICATEDOBJECTID_BTM, &pid, PAGE_BUF);
+
+    if (n < BO_MAXOBJECTIDS) {
+        memmove(&opage->oid[idx + 2], &opage->oid[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+        opage->oid[idx + 1] = *oid;
+        opage->hdr.nObjects++;
+    }
+    else {
+        e = btm_AllocPage(&handle->catObjForFile, &pid, &newPid);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = edubtm_InitOverflow(&newPid);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        if (idx == n - 1 && opage->hdr.nextPage == NIL) {
+            npage->oid[0] = *oid;
+            npage->hdr.nObjects = 1;
+        }
+        else {
+            memcpy(oids, opage->oid, (idx + 1) * OBJECTID_SIZE);
+            oids[idx + 1] = *oid;
+            memcpy(&oids[idx + 2], &opage->oid[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+
+            s = (n + 1) / 2;
+            memcpy(opage->oid, oids, s * OBJECTID_SIZE);
+            opage->hdr.nObjects = s;
+            memcpy(npage->oid, &oids[s], (n + 1 - s) * OBJECTID_SIZE);
+            npage->hdr.nObjects = n + 1 - s;
+        }
+
+        /*@ Maintain the doubly linked list: opage <-> npage <-> next */
+        npage->hdr.prevPage = pid.pageNo;
+        npage->hdr.nextPage = opage->hdr.nextPage;
+        opage->hdr.nextPage = newPid.pageNo;
+
+        if (npage->hdr.nextPage != NIL) {
+            MAKE_PAGEID(nextPid, pid.volNo, npage->hdr.nextPage);
+
+            e = BfM_GetTrain(&nextPid, (char**)&mpage, PAGE_BUF);
+            if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &pid, PAGE_BUF);
+
+            mpage->hdr.prevPage = newPid.pageNo;
+
+            e = BfM_SetDirty(&nextPid, PAGE_BUF);
+            if (e < 0) ERRB2(e, &nextPid, PAGE_BUF, &newPid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&nextPid, PAGE_BUF);
+            if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &pid, PAGE_BUF);
+        }
+
+        e = BfM_SetDirty(&newPid, PAGE_BUF);
+        if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&newPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    }
+
+    e = BfM_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_InsertOverflow() */
+
+
+
+/*@================================
+ * edubtm_DeleteOverflow()
+ *================================*/
+/*
+ * Function: Four edubtm_DeleteOverflow(PageID*, ObjectID*, Two, ObjectID*, Two*,
+ *                                   Pool*, DeallocListElem*)
+ *
+ * Description:
+ * (Following description is for original ODYSSEUS/COSMOS BtM.
+ *  For ODYSSEUS/EduCOSMOS EduBtM, refer to the EduBtM project manual.)
+ *
+ *  Delete 'oid' from the overflow chain starting at 'first'. An emptied page
+ *  is freed, and a page less than a fourth full is merged into a neighbour
+ *  which has room for its ObjectIDs.
+ *
+ *  If the chain is left with one page of at most 'maxLeft' ObjectIDs, they
+ *  are copied into 'left' and the page is freed, so that the leaf entry can
+ *  take them back; 'nLeft' is their number then, 0 if the chain has become
+ *  empty, and NIL if the chain stays.
+ *
+ * Returns:
+ *  error code
+ *    eNOTFOUND_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  first : the new first page of the chain if 'nLeft' is NIL
+ */
+Four edubtm_DeleteOverflow(
+    PageID                      *first,         /* INOUT the first page of the chain */
+    ObjectID                    *oid,           /* IN ObjectID to be deleted */
+    Two                         maxLeft,        /* IN max # of ObjectIDs to be returned to the leaf entry */
+    ObjectID                    *left,          /* OUT ObjectIDs returned to the leaf entry */
+    Two                         *nLeft,         /* OUT # of ObjectIDs in 'left', or NIL */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* element of 'oid' */
+    Two                         n;              /* # of ObjectIDs of the page */
+    PageID                      pid;            /* the page holding 'oid' */
+    PageID                      nbPid;          /* a neighbour of the page */
+    BtreeOverflow               *opage;         /* buffer of the page 'pid' */
+    BtreeOverflow               *npage;         /* buffer of the neighbour */
+
+
+    *nLeft = NIL;
+
+    e = edubtm_FindOverflowPage(first, oid, &pid, &opage);
+    if (e < 0) ERR(e);
+
+    n = opage->hdr.nObjects;
+    if (!btm_BinarySearchOidArray(opage->oid, oid, n, &idx)) ERRB1(eNOTFOUND_BTM, &pid, PAGE_BUF);
+
+    memmove(&opage->oid[idx], &opage->oid[idx + 1], (n - idx - 1) * OBJECTID_SIZE);
+    opage->hdr.nObjects--;
+
+    e = BfM_SetDirty(&pid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+    if (opage->hdr.nObjects == 0) {
+        e = edubtm_UnlinkOverflow(first, &pid, opage, dlPool, dlHead);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+    }
+    else if (opage->hdr.nObjects < A_FOURTH_OF_OBJECTS &&
+             (opage->hdr.nextPage != NIL || opage->hdr.prevPage != NIL)) {
+        /*@ merge the page into its next page, or into its previous one if it is the last */
+        MAKE_PAGEID(nbPid, pid.volNo, (opage->hdr.nextPage != NIL) ? opage->hdr.nextPage : opage->hdr.prevPage);
+
+        e = BfM_GetTrain(&nbPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        if (npage->hdr.nObjects + opage->hdr.nObjects <= NO_OF_OBJECTS) {
+            if (nbPid.pageNo == opage->hdr.nextPage) {
+                memmove(&npage->oid[opage->hdr.nObjects], npage->oid, npage->hdr.nObjects * OBJECTID_SIZE);
+                memcpy(npage->oid, opage->oid, opage->hdr.nObjects * OBJECTID_SIZE);
+            }
+            else
+                memcpy(&npage->oid[npage->hdr.nObjects], opage->oid, opage->hdr.nObjects * OBJECTID_SIZE);
+            npage->hdr.nObjects += opage->hdr.nObjects;
+
+            e = BfM_SetDirty(&nbPid, PAGE_BUF);
+            if (e < 0) ERRB2(e, &nbPid, PAGE_BUF, &pid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            e = edubtm_UnlinkOverflow(first, &pid, opage, dlPool, dlHead);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        }
+        else {
+            e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+        }
+    }
+
+    e = BfM_FreeTrain(&pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (first->pageNo == NIL) {
+        *nLeft = 0;
+        return(eNOERROR);
+    }
+
+    /*@ a short chain of one page goes back to the leaf entry */
+    e = BfM_GetTrain(first, (char**)&opage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (opage->hdr.nextPage == NIL && opage->hdr.nObjects <= maxLeft) {
+        memcpy(left, opage->oid, opage->hdr.nObjects * OBJECTID_SIZE);
+        *nLeft = opage->hdr.nObjects;
+
+        e = edubtm_FreePage(first, (BtreePage*)opage, dlPool, dlHead);
+        if (e < 0) ERRB1(e, first, PAGE_BUF);
+
+        e = BfM_SetDirty(first, PAGE_BUF);
+        if (e < 0) ERRB1(e, first, PAGE_BUF);
+    }
+
+    e = BfM_FreeTrain(first, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_DeleteOverflow() */
+
+
+
+/*@================================
+ * edubtm_FreeOverflow()
+ *================================*/
+/*
+ * Function: Four edubtm_FreeOverflow(PageID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Free all pages of the overflow chain starting at 'first'.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FreeOverflow(
+    PageID                      *first,         /* IN the first page of the chain */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    PageID                      pid;            /* a page of the chain */
+    ShortPageID                 nextPage;       /* the page following 'pid' */
+    BtreeOverflow               *opage;         /* buffer of the page 'pid' */
+
+
+    pid = *first;
+    while (pid.pageNo != NIL) {
+        e = BfM_GetTrain(&pid, (char**)&opage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        nextPage = opage->hdr.nextPage;
+
+        e = edubtm_FreePage(&pid, (BtreePage*)opage, dlPool, dlHead);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_SetDirty(&pid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        pid.pageNo = nextPage;
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_FreeOverflow() */
+
+
+
+/*@================================
+ * edubtm_SetCursorObject()
+ *================================*/
+/*
+ * Function: Four edubtm_SetCursorObject(BtreeLeaf*, PageID*, Two, Boolean, BtreeCursor*)
+ *
+ * Description:
+ *  Let 'cursor' point to the first ObjectID of the entry in the slot
+ *  'slotNo' of 'page', or to its last one if 'last' is TRUE. The 'overflow'
+ *  of the cursor is the overflow page holding the ObjectID, whose pageNo is
+ *  NIL if the ObjectID is in the leaf entry.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_SetCursorObject(
+    BtreeLeaf                   *page,          /* IN leaf page */
+    PageID                      *leafPid,       /* IN PageID of 'page' */
+    Two                         slotNo,         /* IN slot of the entry */
+    Boolean                     last,           /* IN TRUE for the last ObjectID of the entry */
+    BtreeCursor                 *cursor)        /* OUT cursor on the ObjectID */
+{
+    Four                        e;              /* error number */
+    PageID                      ovPid;          /* an overflow page of the entry */
+    BtreeOverflow               *opage;         /* buffer of the page 'ovPid' */
+    btm_LeafEntry               *entry;         /* the leaf entry */
+
+
+    cursor->flag = CURSOR_ON;
+    cursor->leaf = *leafPid;
+    cursor->slotNo = slotNo;
+    MAKE_PAGEID(cursor->overflow, leafPid->volNo, NIL);
+    edubtm_GetLeafObject(page, slotNo, &cursor->key, NULL);
+
+    if (page->hdr.denseKeyLen != 0) {
+        cursor->oidArrayElemNo = 0;
+        cursor->oid = *BL_DENSE_OID(page, slotNo);
+        return(eNOERROR);
+    }
+
+    entry = (btm_LeafEntry*)&page->data[BL_SLOT(page, slotNo)];
+
+    if (entry->nObjects != NIL) {
+        cursor->oidArrayElemNo = last ? entry->nObjects - 1 : 0;
+        cursor->oid = ((ObjectID*)BTM_LEAFENTRY_OBJECTS(entry))[cursor->oidArrayElemNo];
+        return(eNOERROR);
+    }
+
+    MAKE_PAGEID(ovPid, leafPid->volNo, *(ShortPageID*)BTM_LEAFENTRY_OBJECTS(entry));
+
+    e = BfM_GetTrain(&ovPid, (char**)&opage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    while (last && opage->hdr.nextPage != NIL) {
+        e = BfM_FreeTrain(&ovPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        ovPid.pageNo = opage->hdr.nextPage;
+
+        e = BfM_GetTrain(&ovPid, (char**)&opage, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    cursor->overflow = ovPid;
+    cursor->oidArrayElemNo = last ? opage->hdr.nObjects - 1 : 0;
+    cursor->oid = opage->oid[cursor->oidArrayElemNo];
+
+    e = BfM_FreeTrain(&ovPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_SetCursorObject() */
+
+
+
+/*@================================
+ * edubtm_NextObjectOfEntry()
+ *================================*/
+/*
+ * Function: Four edubtm_NextObjectOfEntry(BtreeLeaf*, BtreeCursor*, Boolean, BtreeCursor*, Boolean*)
+ *
+ * Description:
+ *  Find the ObjectID following the one pointed by 'cur' among the ObjectIDs
+ *  of the same entry, which is in 'page', in the given direction.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  found : TRUE if there is such an ObjectID; 'next' points to it then
+ */
+Four edubtm_NextObjectOfEntry(
+    BtreeLeaf                   *page,          /* IN leaf page holding the entry */
+    BtreeCursor                 *cur,           /* IN cursor on an ObjectID of the entry */
+    Boolean                     backward,       /* IN TRUE for the preceding ObjectID */
+    BtreeCursor                 *next,          /* OUT cursor on the next ObjectID */
+    Boolean                     *found)         /* OUT whether the next ObjectID exists */
+{
+    Four                        e;              /* error number */
+    Two                         elemNo;         /* element of the next ObjectID */
+    PageID                      ovPid;          /* overflow page of the next ObjectID */
+    ShortPageID                 nbPage;         /* neighbour of the overflow page */
+    BtreeOverflow               *opage;         /* buffer of the page 'ovPid' */
+    btm_LeafEntry               *entry;         /* the leaf entry */
+
+
+    *found = FALSE;
+    elemNo = cur->oidArrayElemNo + (backward ? -1 : 1);
+
+    if (cur->overflow.pageNo == NIL) {
+        /* an entry of a dense page has one ObjectID */
+        if (page->hdr.denseKeyLen != 0) return(eNOERROR);
+
+        entry = (btm_LeafEntry*)&page->data[BL_SLOT(page, cur->slotNo)];
+        if (elemNo < 0 || elemNo >= entry->nObjects) return(eNOERROR);
+
+        *next = *cur;
+        next->oidArrayElemNo = elemNo;
+        next->oid = ((ObjectID*)BTM_LEAFENTRY_OBJECTS(entry))[elemNo];
+        *found = TRUE;
+
+        return(eNOERROR);
+    }
+
+    ovPid = cur->overflow;
+    e = BfM_GetTrain(&ovPid, (char**)&opage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    /* the ObjectID may be in the neighbour page */
+    if (elemNo < 0 || elemNo >= opage->hdr.nObjects) {
+        nbPage = backward ? opage->hdr.prevPage : opage->hdr.nextPage;
+
+        e = BfM_FreeTrain(&ovPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        if (nbPage == NIL) return(eNOERROR);
+
+        ovPid.pageNo = nbPage;
+        e = BfM_GetTrain(&ovPid, (char**)&opage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        elemNo = backward ? opage->hdr.nObjects - 1 : 0;
+    }
+
+    *next = *cur;
+    next->overflow = ovPid;
+    next->oidArrayElemNo = elemNo;
+    next->oid = opage->oid[elemNo];
+    *found = TRUE;
+
+    e = BfM_FreeTrain(&ovPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_NextObjectOfEntry() */
+
+
+
+/*@================================
+ * edubtm_FindOverflowPage()
+ *================================*/
+/*
+ * Function: Four edubtm_FindOverflowPage(PageID*, ObjectID*, PageID*, BtreeOverflow**)
+ *
+ * Description:
+ *  Find and fix the page of the overflow chain starting at 'first' where
+ *  'oid' is or is to be inserted: the first page whose last ObjectID is not
+ *  less than 'oid', or the last page of the chain.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  The caller should call BfM_FreeTrain() for 'pid'.
+ */
+Four edubtm_FindOverflowPage(
+    PageID                      *first,         /* IN the first page of the chain */
+    ObjectID                    *oid,           /* IN ObjectID to be looked for */
+    PageID                      *pid,           /* OUT the page found */
+    BtreeOverflow               **opage)        /* OUT buffer of the page found */
+{
+    Four                        e;              /* error number */
+
+
+    *pid = *first;
+    e = BfM_GetTrain(pid, (char**)opage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    while ((*opage)->hdr.nextPage != NIL &&
+           btm_ObjectIdComp(oid, &(*opage)->oid[(*opage)->hdr.nObjects - 1]) == GREAT) {
+        e = BfM_FreeTrain(pid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        pid->pageNo = (*opage)->hdr.nextPage;
+
+        e = BfM_GetTrain(pid, (char**)opage, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_FindOverflowPage() */
+
+
+
+/*@================================
+ * edubtm_UnlinkOverflow()
+ *================================*/
+/*
+ * Function: Four edubtm_UnlinkOverflow(PageID*, PageID*, BtreeOverflow*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Take the page 'pid' held in 'opage' out of the overflow chain starting
+ *  at 'first' and free it. 'first' becomes the next page, NIL at the end
+ *  of the chain, if 'pid' is the first page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() and BfM_FreeTrain() for 'pid'.
+ */
+Four edubtm_UnlinkOverflow(
+    PageID                      *first,         /* INOUT the first page of the chain */
+    PageID                      *pid,           /* IN the page to be freed */
+    BtreeOverflow               *opage,         /* INOUT buffer of the page */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    PageID                      nbPid;          /* a neighbour of the page */
+    BtreeOverflow               *npage;         /* buffer of the neighbour */
+
+
+    if (opage->hdr.prevPage == NIL)
+        first->pageNo = opage->hdr.nextPage;
+    else {
+        MAKE_PAGEID(nbPid, pid->volNo, opage->hdr.prevPage);
+
+        e = BfM_GetTrain(&nbPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        npage->hdr.nextPage = opage->hdr.nextPage;
+
+        e = BfM_SetDirty(&nbPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &nbPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    if (opage->hdr.nextPage != NIL) {
+        MAKE_PAGEID(nbPid, pid->volNo, opage->hdr.nextPage);
+
+        e = BfM_GetTrain(&nbPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        npage->hdr.prevPage = opage->hdr.prevPage;
+
+        e = BfM_SetDirty(&nbPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &nbPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nbPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+    }
+
+    e = edubtm_FreePage(pid, (BtreePage*)opage, dlPool, dlHead);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_UnlinkOverflow() */
@@ -0,0 +1,210 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Path.c
+ *
+ * Description :
+ *  A descent from the root keeps the internal pages it passes on a path
+ *  (BtreePath) instead of on the call stack. The leaf is changed first;
+ *  a split or an underflow of a child then walks back up the path, so each
+ *  page on it is needed again only while a change of its child may still
+ *  reach it.
+ *
+ *  A page which takes any change of its child without being changed in
+ *  size class itself (see BTM_SAFE_FOR_INSERT() and BTM_SAFE_FOR_DELETE())
+ *  stops the walk up, and the pages above it are freed as soon as it is
+ *  reached. A freed page is fixed again by its PageID if it is needed after
+ *  all, so the early release never costs correctness.
+ *
+ *  A pinned page (see edubtm_Pin.c) is kept on the path as well but is
+ *  never freed by it.
+ *
+ * Exports:
+ *  Four edubtm_PushPath(BtreePath*, PageID*, BtreePage*, Boolean, Two)
+ *  Four edubtm_FixPathPage(BtreePath*, Two)
+ *  Four edubtm_ReleaseAncestors(BtreePath*)
+ *  Four edubtm_FreePath(BtreePath*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_PushPath()
+ *================================*/
+/*
+ * Function: Four edubtm_PushPath(BtreePath*, PageID*, BtreePage*, Boolean, Two)
+ *
+ * Description:
+ *  Append the fixed internal page 'pid' to 'path'. 'pinned' tells whether
+ *  the page is pinned by the index; 'idx' is the entry of the child taken
+ *  from it. The pages from the root which take their last child are
+ *  counted, so that a page of the path is known to be the last one on its
+ *  level.
+ *
+ * Returns:
+ *  error code
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
+ *
+ * Note:
+ *  The page stays fixed on any error; the caller frees it with the path.
+ */
+Four edubtm_PushPath(
+    BtreePath           *path,          /* INOUT the path of a descent */
+    PageID              *pid,           /* IN the internal page */
+    BtreePage           *apage,         /* IN buffer of the page */
+    Boolean             pinned,         /* IN TRUE if the page is pinned */
+    Two                 idx)            /* IN entry of the child taken */
+{
+    if (path->height >= BTM_MAXLEVEL) return(eEXCEEDMAXDEPTHOFBTREE_BTM);
+
+    path->pid[path->height] = *pid;
+    path->page[path->height] = apage;
+    path->pinned[path->height] = pinned;
+    path->idx[path->height] = idx;
+
+    if (path->height == 0) path->nRightmost = 0;
+    if (path->nRightmost == path->height && idx == apage->bi.hdr.nSlots - 1) path->nRightmost++;
+    path->height++;
+
+    return(eNOERROR);
+
+} /* edubtm_PushPath() */
+
+
+
+/*@================================
+ * edubtm_FixPathPage()
+ *================================*/
+/*
+ * Function: Four edubtm_FixPathPage(BtreePath*, Two)
+ *
+ * Description:
+ *  Make sure the page on level 'level' of 'path' is fixed, fixing it again
+ *  if it was released. A page fixed again is fixed by the path itself.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FixPathPage(
+    BtreePath           *path,          /* INOUT the path of a descent */
+    Two                 level)          /* IN level of the page on the path */
+{
+    Four                e;              /* error number */
+
+
+    if (path->page[level] != NULL) return(eNOERROR);
+
+    path->pinned[level] = FALSE;
+    e = BfM_GetTrain(&path->pid[level], (char**)&path->page[level], PAGE_BUF);
+    if (e < 0) {
+        path->page[level] = NULL;
+        ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_FixPathPage() */
+
+
+
+/*@================================
+ * edubtm_ReleaseAncestors()
+ *================================*/
+/*
+ * Function: Four edubtm_ReleaseAncestors(BtreePath*)
+ *
+ * Description:
+ *  Free the pages on 'path' above its last page. The caller does so when
+ *  the last page is safe, i.e. no change below it can reach them.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ReleaseAncestors(
+    BtreePath           *path)          /* INOUT the path of a descent */
+{
+    Four                e;              /* error number */
+    Two                 level;          /* level of a page on the path */
+
+
+    for (level = path->height - 2; level >= 0 && path->page[level] != NULL; level--) {
+        e = edubtm_UnfixPage(&path->pid[level], path->pinned[level]);
+        path->page[level] = NULL;
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_ReleaseAncestors() */
+
+
+
+/*@================================
+ * edubtm_FreePath()
+ *================================*/
+/*
+ * Function: Four edubtm_FreePath(BtreePath*)
+ *
+ * Description:
+ *  Free all pages still fixed on 'path'.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  Every page is freed even if freeing one of them fails; the first error
+ *  is returned.
+ */
+Four edubtm_FreePath(
+    BtreePath           *path)          /* INOUT the path of a descent */
+{
+    Four                e;              /* error number */
+    Four                first;          /* the first error */
+    Two                 level;          /* level of a page on the path */
+
+
+    first = eNOERROR;
+
+    for (level = path->height - 1; level >= 0; level--) {
+        if (path->page[level] == NULL) continue;
+
+        e = edubtm_UnfixPage(&path->pid[level], path->pinned[level]);
+        path->page[level] = NULL;
+        if (e < 0 && first == eNOERROR) first = e;
+    }
+
+    if (first < 0) ERR(first);
+
+    return(eNOERROR);
+
+} /* edubtm_FreePath() */
@@ -0,0 +1,305 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Pin.c
+ *
+ * Description :
+ *  The root and the internal pages near it are passed by every descent.
+ *  An opened index may keep those on its top levels fixed (see
+ *  EduBtM_PinUpperLevels()); a descent then takes a pinned page from the
+ *  handle instead of fixing it through the buffer manager.
+ *
+ *  A pinned page is the buffer the buffer manager would return for it, so
+ *  changes made to it through either way are seen by the other. A page is
+ *  pinned by the first descent which reaches it on a pinned level while
+ *  there is room; a pinned page which is no longer an internal page is
+ *  unpinned when it is reached again.
+ *
+ * Exports:
+ *  Four edubtm_FixPage(BtreeHandle*, PageID*, Two, BtreePage**, Two*)
+ *  Four edubtm_UnfixPage(PageID*, Boolean)
+ *  Four edubtm_UnpinPage(BtreeHandle*, PageID*)
+ *  Four edubtm_UnpinAll(BtreeHandle*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Boolean edubtm_SearchPinned(BtreePinCache*, ShortPageID, Two*);
+
+
+
+/*@================================
+ * edubtm_FixPage()
+ *================================*/
+/*
+ * Function: Four edubtm_FixPage(BtreeHandle*, PageID*, Two, BtreePage**, Two*)
+ *
+ * Description:
+ *  Get the buffer of the page 'pid' reached by a descent on level 'level'
+ *  from the root. A pinned page is returned as it is; any
+ *  other page is fixed, and an internal page on a pinned level is pinned if
+ *  there is room. 'slot' is the slot of the page, NIL if it is not pinned;
+ *  the caller frees the page by edubtm_UnfixPage().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  Only internal pages are pinned.
+ */
+Four edubtm_FixPage(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    PageID              *pid,           /* IN the page to be fixed */
+    Two                 level,          /* IN level of the page, 0 for the root */
+    BtreePage           **apage,        /* OUT buffer of the page */
+    Two                 *slot)          /* OUT slot of the page, NIL if it is not pinned */
+{
+    Four                e;              /* error number */
+    Two                 i;              /* index of the page in the order of the pinned pages */
+    Two                 s;              /* a slot */
+    BtreePinCache       *pin;           /* the pinned pages */
+
+
+    pin = &handle->pin;
+    *slot = NIL;
+
+    if (level < BTM_MAXLEVEL) pin->nAccesses[level]++;
+
+    if (level < pin->levels) {
+        if (edubtm_SearchPinned(pin, pid->pageNo, &i)) {
+            s = pin->order[i];
+
+            if (pin->page[s]->any.hdr.type & INTERNAL) {
+                *apage = pin->page[s];
+                *slot = s;
+                pin->nHits[level]++;
+
+                return(eNOERROR);
+            }
+
+            /* the page became a leaf or was freed */
+            e = edubtm_UnpinPage(handle, pid);
+            if (e < 0) ERR(e);
+        }
+    }
+
+    e = BfM_GetTrain(pid, (char**)apage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    /* the page keeps the fix just made while it is pinned */
+    if (level < pin->levels && pin->nPages < pin->maxPages && ((*apage)->any.hdr.type & INTERNAL)) {
+        for (s = 0; pin->page[s] != NULL; s++);
+
+        pin->pageNo[s] = pid->pageNo;
+        pin->page[s] = *apage;
+
+        (void) edubtm_SearchPinned(pin, pid->pageNo, &i);
+        i++;
+        memmove(&pin->order[i + 1], &pin->order[i], (pin->nPages - i) * sizeof(Two));
+        pin->order[i] = s;
+        pin->nPages++;
+
+        *slot = s;
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_FixPage() */
+
+
+
+/*@================================
+ * edubtm_UnfixPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnfixPage(PageID*, Boolean)
+ *
+ * Description:
+ *  Free the page 'pid' got by edubtm_FixPage(). A pinned page stays fixed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnfixPage(
+    PageID              *pid,           /* IN the page to be freed */
+    Boolean             pinned)         /* IN TRUE if the page is pinned */
+{
+    Four                e;              /* error number */
+
+
+    if (pinned) return(eNOERROR);
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_UnfixPage() */
+
+
+
+/*@================================
+ * edubtm_UnpinPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnpinPage(BtreeHandle*, PageID*)
+ *
+ * Description:
+ *  Unpin the page 'pid' if it is pinned. The caller does so before the
+ *  page is freed. The slot of the page becomes free, so the parents which
+ *  kept it no longer reach the page through it.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnpinPage(
+    BtreeHandle         *handle,        /* INOUT opened index */
+    PageID              *pid)           /* IN the page to be unpinned */
+{
+    Four                e;              /* error number */
+    Two                 i;              /* index of the page in the order of the pinned pages */
+    BtreePinCache       *pin;           /* the pinned pages */
+
+
+    pin = &handle->pin;
+
+    if (!edubtm_SearchPinned(pin, pid->pageNo, &i)) return(eNOERROR);
+
+    pin->page[pin->order[i]] = NULL;
+    pin->nPages--;
+    memmove(&pin->order[i], &pin->order[i + 1], (pin->nPages - i) * sizeof(Two));
+
+    e = BfM_FreeTrain(pid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_UnpinPage() */
+
+
+
+/*@================================
+ * edubtm_UnpinAll()
+ *================================*/
+/*
+ * Function: Four edubtm_UnpinAll(BtreeHandle*)
+ *
+ * Description:
+ *  Unpin all pages of 'handle'. The levels stay pinned, so that the next
+ *  descents pin their pages again.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  Every page is freed even if freeing one of them fails; the first error
+ *  is returned.
+ */
+Four edubtm_UnpinAll(
+    BtreeHandle         *handle)        /* INOUT opened index */
+{
+    Four                e;              /* error number */
+    Four                first;          /* the first error */
+    Two                 i;              /* index of a pinned page */
+    PageID              pid;            /* a pinned page */
+    BtreePinCache       *pin;           /* the pinned pages */
+
+
+    pin = &handle->pin;
+    first = eNOERROR;
+
+    for (i = 0; i < pin->nPages; i++) {
+        MAKE_PAGEID(pid, handle->root.volNo, pin->pageNo[pin->order[i]]);
+        pin->page[pin->order[i]] = NULL;
+
+        e = BfM_FreeTrain(&pid, PAGE_BUF);
+        if (e < 0 && first == eNOERROR) first = e;
+    }
+    pin->nPages = 0;
+
+    if (first < 0) ERR(first);
+
+    return(eNOERROR);
+
+} /* edubtm_UnpinAll() */
+
+
+
+/*@================================
+ * edubtm_SearchPinned()
+ *================================*/
+/*
+ * Function: Boolean edubtm_SearchPinned(BtreePinCache*, ShortPageID, Two*)
+ *
+ * Description:
+ *  Search the pinned pages for the page 'pageNo'. 'idx' is its index in
+ *  the order of the pinned pages if it is found, otherwise the index of the
+ *  largest page smaller than it (-1 if there is none).
+ *
+ * Returns:
+ *  TRUE if the page is pinned
+ */
+Boolean edubtm_SearchPinned(
+    BtreePinCache       *pin,           /* IN the pinned pages */
+    ShortPageID         pageNo,         /* IN the page searched for */
+    Two                 *idx)           /* OUT index of the page */
+{
+    Two                 low;            /* lower bound of the search */
+    Two                 high;           /* upper bound of the search */
+    Two                 mid;            /* the middle */
+    ShortPageID         midPageNo;      /* the page in the middle */
+
+
+    low = 0;
+    high = pin->nPages - 1;
+
+    while (low <= high) {
+        mid = (low + high) / 2;
+        midPageNo = pin->pageNo[pin->order[mid]];
+
+        if (midPageNo == pageNo) {
+            *idx = mid;
+            return(TRUE);
+        }
+
+        if (midPageNo < pageNo) low = mid + 1;
+        else high = mid - 1;
+    }
+
+    *idx = high;
+
+    return(FALSE);
+
+} /* edubtm_SearchPinned() */
@@ -0,0 +1,542 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Prefix.c
+ *
+ * Description :
+ *  A leaf page of an index on a string key may be prefix compressed. The
+ *  bytes common to all keys of such a page (the page prefix, 'prefixLen'
+ *  bytes long) are stored once at the beginning of the data area, and each
+ *  entry keeps only the rest of its string, without the 2-byte length of
+ *  SM_VARSTRING. A page whose 'prefixLen' is NIL holds plain entries.
+ *
+ *  Entries are moved between pages of different prefixes through
+ *  LeafEntryRef, which pairs an entry with the prefix of its page, or
+ *  refers to the key and the ObjectID of an entry of a dense page. The
+ *  functions in this file reconstruct full keys, measure and partition a
+ *  sorted sequence of entries, and rebuild a leaf page out of it in a given
+ *  format (BL_DENSE, or BL_PREFIX and/or BL_KEYHEAD).
+ *
+ * Exports:
+ *  void edubtm_GetLeafObject(BtreeLeaf*, Two, KeyValue*, ObjectID*)
+ *  void edubtm_GetLeafEntryRef(BtreeLeaf*, Two, LeafEntryRef*)
+ *  void edubtm_GetLeafEntryRefKey(LeafEntryRef*, KeyValue*)
+ *  Two edubtm_GetLeafEntryRefs(BtreeLeaf*, LeafEntryRef*)
+ *  Four edubtm_GetLeafScratch(BtreeHandle*, BtreeLeafScratch**)
+ *  Four edubtm_LeafEntriesSize(LeafEntryRef*, Two, Four)
+ *  Two edubtm_PartitionLeafEntries(LeafEntryRef*, Two, Four, Four, Two)
+ *  Boolean edubtm_DivideLeafEntries(LeafEntryRef*, Two, Four, Two, Two*)
+ *  void edubtm_BuildLeafPage(BtreeHandle*, BtreeLeaf*, LeafEntryRef*, Two, Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Two edubtm_CommonPrefixLen(LeafEntryRef*, LeafEntryRef*);
+Four edubtm_LeafEntryLen(LeafEntryRef*, Four, Two);
+
+
+/*@ length of the full key of a leaf entry reference */
+#define LEAFENTRYREF_KLEN(r) \
+	(((r)->entry == NULL) ? (r)->klen : \
+	 ((r)->prefixLen == NIL) ? (r)->entry->klen : (Two)sizeof(Two) + (r)->prefixLen + (r)->entry->klen)
+
+/*@ 'nObjects' of a leaf entry reference */
+#define LEAFENTRYREF_NOBJECTS(r) (((r)->entry == NULL) ? 1 : (r)->entry->nObjects)
+
+/*@ the ObjectIDs, or the overflow PageID, of a leaf entry reference */
+#define LEAFENTRYREF_OID(r) \
+	(((r)->entry == NULL) ? (r)->oid : (ObjectID*)BTM_LEAFENTRY_OBJECTS((r)->entry))
+
+
+
+/*@================================
+ * edubtm_GetLeafObject()
+ *================================*/
+/*
+ * Function: void edubtm_GetLeafObject(BtreeLeaf*, Two, KeyValue*, ObjectID*)
+ *
+ * Description:
+ *  Reconstruct into 'kval' the full key of the entry in the slot 'slotNo' of
+ *  'page' and copy its first ObjectID into 'oid'. Either of 'kval' and
+ *  'oid' may be NULL; 'oid' must be NULL for an entry whose ObjectIDs are
+ *  in overflow pages (see edubtm_SetCursorObject()).
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_GetLeafObject(
+    BtreeLeaf                   *page,          /* IN leaf page */
+    Two                         slotNo,         /* IN slot No. of the entry */
+    KeyValue                    *kval,          /* OUT key of the entry */
+    ObjectID                    *oid)           /* OUT ObjectID of the entry */
+{
+    LeafEntryRef                ref;            /* reference to the entry */
+
+
+    edubtm_GetLeafEntryRef(page, slotNo, &ref);
+
+    if (kval != NULL) edubtm_GetLeafEntryRefKey(&ref, kval);
+    if (oid != NULL) *oid = *LEAFENTRYREF_OID(&ref);
+
+} /* edubtm_GetLeafObject() */
+
+
+
+/*@================================
+ * edubtm_GetLeafEntryRef()
+ *================================*/
+/*
+ * Function: void edubtm_GetLeafEntryRef(BtreeLeaf*, Two, LeafEntryRef*)
+ *
+ * Description:
+ *  Let 'ref' refer to the entry in the slot 'slotNo' of 'page'.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_GetLeafEntryRef(
+    BtreeLeaf                   *page,          /* IN leaf page */
+    Two                         slotNo,         /* IN slot No. of the entry */
+    LeafEntryRef                *ref)           /* OUT reference to the entry */
+{
+    ref->prefix = page->data;
+    ref->prefixLen = page->hdr.prefixLen;
+
+    if (page->hdr.denseKeyLen != 0) {
+        ref->entry = NULL;
+        ref->key = BL_DENSE_KEY(page, slotNo);
+        ref->klen = page->hdr.denseKeyLen;
+        ref->oid = BL_DENSE_OID(page, slotNo);
+    }
+    else
+        ref->entry = (btm_LeafEntry*)&page->data[BL_SLOT(page, slotNo)];
+
+} /* edubtm_GetLeafEntryRef() */
+
+
+
+/*@================================
+ * edubtm_GetLeafEntryRefKey()
+ *================================*/
+/*
+ * Function: void edubtm_GetLeafEntryRefKey(LeafEntryRef*, KeyValue*)
+ *
+ * Description:
+ *  Reconstruct into 'kval' the full key of the entry referred by 'ref'.
+ *  The key of a compressed entry is rebuilt as a SM_VARSTRING value.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_GetLeafEntryRefKey(
+    LeafEntryRef                *ref,           /* IN reference to a leaf entry */
+    KeyValue                    *kval)          /* OUT key of the entry */
+{
+    Two                         strLen;         /* length of the string part of the key */
+
+
+    if (ref->entry == NULL) {
+        kval->len = ref->klen;
+        memcpy(kval->val, ref->key, ref->klen);
+    }
+    else if (ref->prefixLen == NIL) {
+        kval->len = ref->entry->klen;
+        memcpy(kval->val, ref->entry->kval, ref->entry->klen);
+    }
+    else {
+        strLen = ref->prefixLen + ref->entry->klen;
+        memcpy(kval->val, &strLen, sizeof(Two));
+        memcpy(&kval->val[sizeof(Two)], ref->prefix, ref->prefixLen);
+        memcpy(&kval->val[sizeof(Two) + ref->prefixLen], ref->entry->kval, ref->entry->klen);
+        kval->len = sizeof(Two) + strLen;
+    }
+
+} /* edubtm_GetLeafEntryRefKey() */
+
+
+
+/*@================================
+ * edubtm_GetLeafEntryRefs()
+ *================================*/
+/*
+ * Function: Two edubtm_GetLeafEntryRefs(BtreeLeaf*, LeafEntryRef*)
+ *
+ * Description:
+ *  Fill 'refs' with references to the entries of 'page' in slot order.
+ *
+ * Returns:
+ *  # of entries referred
+ */
+Two edubtm_GetLeafEntryRefs(
+    BtreeLeaf                   *page,          /* IN leaf page */
+    LeafEntryRef                *refs)          /* OUT references to the entries */
+{
+    Two                         i;              /* slot No. */
+
+
+    for (i = 0; i < page->hdr.nSlots; i++)
+        edubtm_GetLeafEntryRef(page, i, &refs[i]);
+
+    return(page->hdr.nSlots);
+
+} /* edubtm_GetLeafEntryRefs() */
+
+
+
+/*@================================
+ * edubtm_GetLeafScratch()
+ *================================*/
+/*
+ * Function: Four edubtm_GetLeafScratch(BtreeHandle*, BtreeLeafScratch**)
+ *
+ * Description:
+ *  Return the room of 'handle' for moving the entries of two leaves,
+ *  allocating it on first use. It is freed by EduBtM_CloseIndex().
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR
+ */
+Four edubtm_GetLeafScratch(
+    BtreeHandle                 *handle,        /* INOUT opened index */
+    BtreeLeafScratch            **scratch)      /* OUT the room of 'handle' */
+{
+    if (handle->scratch == NULL) {
+        handle->scratch = (BtreeLeafScratch*)malloc(sizeof(BtreeLeafScratch));
+        if (handle->scratch == NULL) ERR(eMEMORYALLOCERR);
+    }
+
+    *scratch = handle->scratch;
+
+    return(eNOERROR);
+
+} /* edubtm_GetLeafScratch() */
+
+
+
+/*@================================
+ * edubtm_CommonPrefixLen()
+ *================================*/
+/*
+ * Function: Two edubtm_CommonPrefixLen(LeafEntryRef*, LeafEntryRef*)
+ *
+ * Description:
+ *  Return the length of the prefix shared by the strings of two entries.
+ *  For sorted entries, the prefix shared by the first and the last one is
+ *  shared by all entries in between.
+ *
+ * Returns:
+ *  length of the common prefix
+ */
+Two edubtm_CommonPrefixLen(
+    LeafEntryRef                *ref1,          /* IN reference to the first entry */
+    LeafEntryRef                *ref2)          /* IN reference to the second entry */
+{
+    Two                         i;              /* index of a byte */
+    Two                         len;            /* # of bytes to be compared */
+    KeyValue                    key1;           /* key of the first entry */
+    KeyValue                    key2;           /* key of the second entry */
+
+
+    edubtm_GetLeafEntryRefKey(ref1, &key1);
+    edubtm_GetLeafEntryRefKey(ref2, &key2);
+
+    len = MIN(key1.len, key2.len);
+    for (i = sizeof(Two); i < len && key1.val[i] == key2.val[i]; i++);
+
+    return(i - sizeof(Two));
+
+} /* edubtm_CommonPrefixLen() */
+
+
+
+/*@================================
+ * edubtm_LeafEntryLen()
+ *================================*/
+/*
+ * Function: Four edubtm_LeafEntryLen(LeafEntryRef*, Four, Two)
+ *
+ * Description:
+ *  Return the space the entry referred by 'ref' takes, with its slot, in a
+ *  page of the given format whose prefix is 'prefixLen' long.
+ *
+ * Returns:
+ *  length of the entry
+ */
+Four edubtm_LeafEntryLen(
+    LeafEntryRef                *ref,           /* IN reference to a leaf entry */
+    Four                        format,         /* IN format of the page */
+    Two                         prefixLen)      /* IN length of the prefix of that page */
+{
+    Two                         klen;           /* length of the stored key */
+
+
+    if (format & BL_DENSE)
+        return(LEAFENTRYREF_KLEN(ref) + OBJECTID_SIZE);
+
+    if (format & BL_PREFIX)
+        klen = LEAFENTRYREF_KLEN(ref) - sizeof(Two) - prefixLen;
+    else
+        klen = LEAFENTRYREF_KLEN(ref);
+
+    return(BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(klen) + BTM_OBJECTS_LEN(LEAFENTRYREF_NOBJECTS(ref)) +
+           ((format & BL_KEYHEAD) ? sizeof(Two) + BL_KEYHEAD_SIZE : sizeof(Two)));
+
+} /* edubtm_LeafEntryLen() */
+
+
+
+/*@================================
+ * edubtm_LeafEntriesSize()
+ *================================*/
+/*
+ * Function: Four edubtm_LeafEntriesSize(LeafEntryRef*, Two, Four)
+ *
+ * Description:
+ *  Return the space that the 'n' sorted entries of 'refs' take in one leaf
+ *  page of the given format, counting the slots and the page prefix.
+ *  'n' entries fit in a dense page if their size is within its data area.
+ *
+ * Returns:
+ *  size of the entries
+ */
+Four edubtm_LeafEntriesSize(
+    LeafEntryRef                *refs,          /* IN references to sorted leaf entries */
+    Two                         n,              /* IN # of entries */
+    Four                        format)         /* IN format of the page */
+{
+    Two                         i;              /* index of an entry */
+    Two                         prefixLen;      /* length of the page prefix */
+    Four                        sum;            /* size of the entries */
+
+
+    if (n == 0) return(0);
+
+    prefixLen = (format & BL_PREFIX) ? edubtm_CommonPrefixLen(&refs[0], &refs[n-1]) : 0;
+
+    sum = (format & BL_PREFIX) ? ALIGNED_LENGTH(prefixLen) : 0;
+    for (i = 0; i < n; i++)
+        sum += edubtm_LeafEntryLen(&refs[i], format, prefixLen);
+
+    return(sum);
+
+} /* edubtm_LeafEntriesSize() */
+
+
+
+/*@================================
+ * edubtm_PartitionLeafEntries()
+ *================================*/
+/*
+ * Function: Two edubtm_PartitionLeafEntries(LeafEntryRef*, Two, Four, Four, Two)
+ *
+ * Description:
+ *  Choose how many of the 'n' sorted entries of 'refs' go to the left one of
+ *  two leaf pages: entries are taken until 'fill' bytes are used, measured
+ *  with the prefix common to all entries, and the right page keeps at least
+ *  one entry. Since each page is compressed with its own, possibly longer,
+ *  prefix, both pages are checked to fit; if they do not, 'fallback' is
+ *  returned.
+ *
+ * Returns:
+ *  # of entries of the left page
+ */
+Two edubtm_PartitionLeafEntries(
+    LeafEntryRef                *refs,          /* IN references to sorted leaf entries */
+    Two                         n,              /* IN # of entries */
+    Four                        format,         /* IN format of the pages */
+    Four                        fill,           /* IN size of the left page to be filled */
+    Two                         fallback)       /* IN # of entries of the left page if the partition fails */
+{
+    Two                         s;              /* # of entries of the left page */
+    Two                         prefixLen;      /* length of the prefix common to all entries */
+    Four                        sum;            /* the size of a filled area */
+
+
+    prefixLen = (format & BL_PREFIX) ? edubtm_CommonPrefixLen(&refs[0], &refs[n-1]) : 0;
+
+    sum = 0;
+    for (s = 0; s < n - 1 && sum < fill; s++)
+        sum += edubtm_LeafEntryLen(&refs[s], format, prefixLen);
+
+    if (edubtm_LeafEntriesSize(refs, s, format) > PAGESIZE - BL_FIXED ||
+        edubtm_LeafEntriesSize(&refs[s], n - s, format) > PAGESIZE - BL_FIXED)
+        return(fallback);
+
+    return(s);
+
+} /* edubtm_PartitionLeafEntries() */
+
+
+
+/*@================================
+ * edubtm_DivideLeafEntries()
+ *================================*/
+/*
+ * Function: Boolean edubtm_DivideLeafEntries(LeafEntryRef*, Two, Four, Two, Two*)
+ *
+ * Description:
+ *  Divide the 'n' sorted entries of 'refs' into 'nPages' leaf pages of the
+ *  given format filled equally, measured as edubtm_PartitionLeafEntries()
+ *  does. The entries of page 'p' end before 'ends[p]'.
+ *
+ * Returns:
+ *  TRUE if every page gets an entry and its entries fit in it
+ */
+Boolean edubtm_DivideLeafEntries(
+    LeafEntryRef                *refs,          /* IN references to sorted leaf entries */
+    Two                         n,              /* IN # of entries */
+    Four                        format,         /* IN format of the pages */
+    Two                         nPages,         /* IN # of pages */
+    Two                         *ends)          /* OUT end of the entries of each page */
+{
+    Two                         i;              /* index of an entry */
+    Two                         p;              /* index of a page */
+    Two                         prefixLen;      /* length of the prefix common to all entries */
+    Four                        total;          /* the size of all entries */
+    Four                        sum;            /* the size of the entries of the pages filled */
+
+
+    prefixLen = (format & BL_PREFIX) ? edubtm_CommonPrefixLen(&refs[0], &refs[n-1]) : 0;
+
+    total = 0;
+    for (i = 0; i < n; i++)
+        total += edubtm_LeafEntryLen(&refs[i], format, prefixLen);
+
+    /* each of the pages left keeps at least one entry */
+    sum = 0;
+    for (i = 0, p = 0; p < nPages - 1; p++) {
+        for ( ; i < n - (nPages - 1 - p) && sum < total * (p + 1) / nPages; i++)
+            sum += edubtm_LeafEntryLen(&refs[i], format, prefixLen);
+        ends[p] = i;
+    }
+    ends[nPages - 1] = n;
+
+    for (i = 0, p = 0; p < nPages; i = ends[p], p++)
+        if (ends[p] == i || edubtm_LeafEntriesSize(&refs[i], ends[p] - i, format) > PAGESIZE - BL_FIXED)
+            return(FALSE);
+
+    return(TRUE);
+
+} /* edubtm_DivideLeafEntries() */
+
+
+
+/*@================================
+ * edubtm_BuildLeafPage()
+ *================================*/
+/*
+ * Function: void edubtm_BuildLeafPage(BtreeHandle*, BtreeLeaf*, LeafEntryRef*, Two, Four)
+ *
+ * Description:
+ *  Replace the entries of 'page' with the 'n' sorted entries of 'refs',
+ *  stored in the given format. A compressed page takes the prefix common
+ *  to all of its entries. The header fields other than the ones describing
+ *  the data area are left as they are.
+ *
+ * Returns:
+ *  None
+ *
+ * Note:
+ *  'refs' may not refer to entries of 'page' itself; the caller copies the
+ *  page first.
+ */
+void edubtm_BuildLeafPage(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeLeaf                   *page,          /* INOUT leaf page to be rebuilt */
+    LeafEntryRef                *refs,          /* IN references to sorted leaf entries */
+    Two                         n,              /* IN # of entries */
+    Four                        format)         /* IN format of the page */
+{
+    Two                         i;              /* slot No. */
+    Two                         offset;         /* starting offset of an entry */
+    Two                         klen;           /* length of the stored key */
+    Two                         skip;           /* # of leading bytes of the full key not stored */
+    KeyValue                    key;            /* full key of an entry */
+    btm_LeafEntry               *entry;         /* an entry of 'page' */
+
+
+    if (format & BL_DENSE) {
+        page->hdr.prefixLen = NIL;
+        page->hdr.keyHead = FALSE;
+        page->hdr.denseKeyLen = BTM_DENSE_KEYLEN(handle);
+
+        for (i = 0; i < n; i++) {
+            edubtm_GetLeafEntryRefKey(&refs[i], &key);
+            memcpy(BL_DENSE_KEY(page, i), key.val, page->hdr.denseKeyLen);
+            memcpy(BL_DENSE_OID(page, i), LEAFENTRYREF_OID(&refs[i]), OBJECTID_SIZE);
+        }
+
+        page->hdr.nSlots = n;
+        page->hdr.free = n * (page->hdr.denseKeyLen + OBJECTID_SIZE);
+        page->hdr.unused = 0;
+
+        return;
+    }
+
+    page->hdr.keyHead = (format & BL_KEYHEAD) ? TRUE : FALSE;
+    page->hdr.denseKeyLen = 0;
+
+    if (format & BL_PREFIX) {
+        page->hdr.prefixLen = (n > 0) ? edubtm_CommonPrefixLen(&refs[0], &refs[n-1]) : 0;
+        skip = sizeof(Two) + page->hdr.prefixLen;
+
+        /* the page prefix is taken from the first key */
+        if (n > 0) {
+            edubtm_GetLeafEntryRefKey(&refs[0], &key);
+            memcpy(page->data, &key.val[sizeof(Two)], page->hdr.prefixLen);
+        }
+    }
+    else {
+        page->hdr.prefixLen = NIL;
+        skip = 0;
+    }
+
+    offset = BL_PREFIX_AREA(page);
+    for (i = 0; i < n; i++) {
+        edubtm_GetLeafEntryRefKey(&refs[i], &key);
+        klen = key.len - skip;
+
+        entry = (btm_LeafEntry*)&page->data[offset];
+        entry->nObjects = LEAFENTRYREF_NOBJECTS(&refs[i]);
+        entry->klen = klen;
+        memcpy(entry->kval, &key.val[skip], klen);
+        memcpy(BTM_LEAFENTRY_OBJECTS(entry), LEAFENTRYREF_OID(&refs[i]), BTM_OBJECTS_LEN(entry->nObjects));
+        edubtm_SetLeafSlot(handle, page, i, offset);
+
+        offset += BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(klen) + BTM_OBJECTS_LEN(entry->nObjects);
+    }
+
+    page->hdr.nSlots = n;
+    page->hdr.free = offset;
+    page->hdr.unused = 0;
+
+} /* edubtm_BuildLeafPage() */
@@ -29,11 +29,17 @@
  *  This file has three functions about 'split'.
  *  'edubtm_SplitInternal(...) and edubtm_SplitLeaf(...) insert the given item
  *  after spliting, and return 'ritem' which should be inserted into the
- *  parent page.
+ *  parent page. edubtm_MakeSeparator(...) builds the internal item which
+ *  divides two adjacent leaves.
+ *
+ *  Before a leaf is splitted, its entries are shared with a sibling which
+ *  has room, and a full leaf with a full sibling is splitted into three
+ *  pages instead of two (B*-tree), so that leaves stay about 2/3 full or more.
  *
  * Exports:
- *  Four edubtm_SplitInternal(ObjectID*, BtreeInternal*, Two, InternalItem*, InternalItem*)
- *  Four edubtm_SplitLeaf(ObjectID*, PageID*, BtreeLeaf*, Two, LeafItem*, InternalItem*)
+ *  Four edubtm_SplitInternal(ObjectID*, BtreeInternal*, Two, Boolean, InternalItem*, InternalItem*)
+ *  Four edubtm_SplitLeaf(BtreeHandle*, PageID*, BtreeLeaf*, Two, btm_LeafEntry*, Boolean*, InternalItem*)
+ *  void edubtm_MakeSeparator(BtreeHandle*, KeyValue*, KeyValue*, ShortPageID, InternalItem*)
  */
 
 
@@ -43,12 +49,19 @@
 #include "EduBtM_Internal.h"
 
 
+/*@ Internal Function Prototypes */
+Four edubtm_SplitLeafWithSibling(BtreeHandle*, PageID*, BtreeLeaf*, LeafEntryRef*, Two, Four,
+                                 Boolean*, Boolean*, InternalItem*);
+Four edubtm_RedistributeLeaf(BtreeHandle*, BtreeInternal*, Two, PageID*, BtreeLeaf*, LeafEntryRef*, Two,
+                             Four, Boolean, Two, Boolean*, Boolean*, InternalItem*);
+
+
 
 /*@================================
  * edubtm_SplitInternal()
  *================================*/
 /*
- * Function: Four edubtm_SplitInternal(ObjectID*, BtreeInternal*,Two, InternalItem*, InternalItem*)
+ * Function: Four edubtm_SplitInternal(ObjectID*, BtreeInternal*, Two, Boolean, InternalItem*, InternalItem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -60,6 +73,12 @@
  *  the new internal item should be inserted into their parent and the item will
  *  be returned by 'ritem'.
  *
+ *  When 'item' is appended after the last slot of the last page on its
+ *  level ('rightmost'), the keys are most likely arriving in increasing
+ *  order, so the given page is filled up to BI_APPEND_FILL instead of a
+ *  half and only the tail moves to the new page. Any other page is split
+ *  in halves, since keys may still arrive on both sides of the item.
+ *
  *  A temporary page is used because it is difficult to use the given page
  *  directly and the temporary page will be copied to the given page later.
  *
@@ -74,6 +93,7 @@ Four edubtm_SplitInternal(
     ObjectID                    *catObjForFile,         /* IN catalog object of B+ tree file */
     BtreeInternal               *fpage,                 /* INOUT the page which will be splitted */
     Two                         high,                   /* IN slot No. for the given 'item' */
+    Boolean                     rightmost,              /* IN TRUE if the page is the last one on its level */
     InternalItem                *item,                  /* IN the item which will be inserted */
     InternalItem                *ritem)                 /* OUT the item which will be returned by spliting */
 {
@@ -83,7 +103,7 @@ Four edubtm_SplitInternal(
     Two                         k;                      /* slot No. in the new page */
     Two                         maxLoop;                /* # of max loops; # of slots in fpage + 1 */
     Four                        sum;                    /* the size of a filled area */
-    Boolean                     flag=FALSE;             /* TRUE if 'item' become a member of fpage */
+    Four                        fill;                   /* the size of fpage to be filled */
     PageID                      newPid;                 /* for a New Allocated Page */
     BtreeInternal               *npage;                 /* a page pointer for the new allocated page */
     Two                         fEntryOffset;           /* starting offset of an entry in fpage */
@@ -91,107 +111,93 @@ Four edubtm_SplitInternal(
     Two                         entryLen;               /* length of an entry */
     btm_InternalEntry           *fEntry;                /* internal entry in the given page, fpage */
     btm_InternalEntry           *nEntry;                /* internal entry in the new page, npage*/
-    Boolean                     isTmp;
 
-    isTmp = FALSE;
+    BtreeInternal               tpage;                  /* a temporary page for the given page */
+
+
     e = btm_AllocPage(catObjForFile, &fpage->hdr.pid, &newPid);
     if(e<0)ERR(e);
 
-    e = edubtm_InitInternal(&newPid, FALSE, isTmp);
+    e = edubtm_InitInternal(&newPid, FALSE, FALSE);
     if(e<0)ERR(e);
 
-    maxLoop = fpage->hdr.nSlots + 1;
+    e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+    if(e<0)ERR(e);
+
+    /* fpage is rebuilt from scratch out of its saved image */
+    memcpy(&tpage, fpage, PAGESIZE);
+    fpage->hdr.free = 0;
+    fpage->hdr.unused = 0;
+
+    /*
+     * Slot 'high'+1 of the virtual page (fpage + item) belongs to 'item'.
+     * The first part stays in fpage, the next entry goes up to the parent,
+     * and the rest moves to the new page, which keeps at least one entry.
+     */
+    maxLoop = tpage.hdr.nSlots + 1;
+    fill = (rightmost && high == tpage.hdr.nSlots - 1) ? BI_APPEND_FILL : BI_HALF;
     sum = 0;
     i = 0;
-    j = 0; 
-
-    for(j = 0; (j < maxLoop && sum < BI_HALF) ; ++j){
+    for (j = 0; j < maxLoop - 2 && sum < fill; j++) {
         if (j == high + 1) {
-            entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen);
-            isTmp = TRUE;
+            fEntry = (btm_InternalEntry*)item;
         }
         else {
-            fEntryOffset = fpage->slot[-i];
-            fEntry = &fpage->data[fEntryOffset];
-            entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(2)+ fEntry->klen); 
-            ++i;
+            fEntry = (btm_InternalEntry*)&tpage.data[tpage.slot[-i]];
+            i++;
         }
+        entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + fEntry->klen);
+
+        fEntryOffset = fpage->hdr.free;
+        fpage->slot[-j] = fEntryOffset;
+        memcpy(&fpage->data[fEntryOffset], fEntry, entryLen);
+        fpage->hdr.free += entryLen;
+
         sum += entryLen + sizeof(Two);
     }
     fpage->hdr.nSlots = j;
 
-    if(fpage->hdr.type & ROOT){
-        fpage->hdr.type ^= ROOT;
+    /* the middle entry is returned to the parent; its child becomes p0 of the new page */
+    if (j == high + 1) {
+        fEntry = (btm_InternalEntry*)item;
     }
-
-    if (i == high + 1) {
-        ritem->spid = newPid.pageNo;
-        ritem->klen = item->klen;
-        memcpy(ritem->kval, item->kval, item->klen);
-    } 
     else {
-        fEntry = (btm_InternalEntry*)&(fpage->data[fpage->slot[-i]]);
-        ritem->spid = newPid.pageNo;
-        ritem->klen = fEntry->klen;
-        memcpy(ritem->kval, fEntry->kval, fEntry->klen);
-        ++i;
+        fEntry = (btm_InternalEntry*)&tpage.data[tpage.slot[-i]];
+        i++;
     }
+    j++;
+    npage->hdr.p0 = fEntry->spid;
+    ritem->spid = newPid.pageNo;
+    ritem->klen = fEntry->klen;
+    memcpy(ritem->kval, fEntry->kval, fEntry->klen);
 
-
-    e = BfM_GetNewTrain(&newPid, (char**)&npage, PAGE_BUF);
-    if (e<0)ERR(e);
-
-    fEntry = (btm_InternalEntry*)&(fpage->data[fpage->slot[-i]]); 
-    npage->hdr.p0 = fEntry->spid; 
-    k = 0;
-    // j+1 because we add one more entry just before
-    for (j = j+1; j < maxLoop; ++j) {
-        if (i == high + 1) {
-            isTmp = FALSE;
-            npage->slot[-k] = nEntryOffset;
-            nEntry = (btm_InternalEntry*)&npage->data[npage->slot[-k]];
-            nEntry->klen = item->klen;
-            nEntry->spid = item->spid;
-            memcpy(nEntry->kval, item->kval, item->klen);
-            entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + nEntry->klen);
+    for (k = 0; j < maxLoop; j++, k++) {
+        if (j == high + 1) {
+            fEntry = (btm_InternalEntry*)item;
         }
         else {
-            fEntry = (btm_InternalEntry*)&(fpage->data[fpage->slot[-i]]);
-            entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + fEntry->klen);
-            npage->slot[-k] = nEntryOffset;
-            memcpy(&npage->data[npage->slot[-k]], fEntry, entryLen);
-            ++i;
-        }
-        nEntryOffset += entryLen;
-        ++k;
-    }
-
-    if (isTmp){
-        if (sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen) > BI_CFREE(fpage)) {
-            edubtm_CompactInternalPage(fpage, NIL);
+            fEntry = (btm_InternalEntry*)&tpage.data[tpage.slot[-i]];
+            i++;
         }
-        for(j = fpage->hdr.nSlots - 1; high + 1 <= j; --j){
-            fpage->slot[-j-1] = fpage->slot[-j];
-        }
-        fpage->slot[-high-1] = fpage->hdr.free;
+        entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + fEntry->klen);
 
-        fEntry = &fpage->data[fpage->hdr.free];
+        nEntryOffset = npage->hdr.free;
+        npage->slot[-k] = nEntryOffset;
+        memcpy(&npage->data[nEntryOffset], fEntry, entryLen);
+        npage->hdr.free += entryLen;
+    }
+    npage->hdr.nSlots = k;
 
-        memcpy(fEntry, item, sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen));
+    /* the root flag is handed over to the new root by edubtm_root_insert() */
+    fpage->hdr.type &= ~ROOT;
 
-        fpage->hdr.free += sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen);
-        fpage->hdr.nSlots += 1;
-    }
     e = BfM_SetDirty(&newPid, PAGE_BUF);
-    if(e<0)ERR(e);
+    if(e<0)ERRB1(e, &newPid, PAGE_BUF);
 
     e = BfM_FreeTrain(&newPid, PAGE_BUF);
     if(e<0)ERR(e);
-
     
     return(eNOERROR);
-        
-
     
 } /* edubtm_SplitInternal() */
 
@@ -201,7 +207,7 @@ Four edubtm_SplitInternal(
  * edubtm_SplitLeaf()
  *================================*/
 /*
- * Function: Four edubtm_SplitLeaf(ObjectID*, PageID*, BtreeLeaf*, Two, LeafItem*, InternalItem*)
+ * Function: Four edubtm_SplitLeaf(BtreeHandle*, PageID*, BtreeLeaf*, Two, btm_LeafEntry*, Boolean*, InternalItem*)
  *
  * Description: 
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -211,7 +217,23 @@ Four edubtm_SplitInternal(
  *  that the entry of a leaf differs from the entry of an internal and the first
  *  key value of a new page is used to make an internal item of their parent.
  *  Internal pages do not maintain the linked list, but leaves do it, so links
- *  are properly updated.
+ *  are properly updated. The separator is shortened by edubtm_MakeSeparator().
+ *
+ *  When 'item' is appended after the last slot of the rightmost leaf, the
+ *  given page is filled up to BL_APPEND_FILL instead of a half, so that
+ *  monotonically increasing inserts do not leave half empty leaves behind.
+ *
+ *  'item' holds the full key, not compressed by any page prefix, followed
+ *  by its ObjectIDs or overflow PageID.
+ *
+ *  Unless 'item' is appended at the end of the index, a sibling first takes
+ *  some of the entries, or the page and a full sibling become three pages;
+ *  see edubtm_SplitLeafWithSibling().
+ *
+ *  The pages are rebuilt in the format given by BTM_LEAF_FORMAT(). When all entries and
+ *  'item' fit in the given page once it is rebuilt, e.g. when 'item' does not
+ *  share the prefix of the page or the page gets compressed, the page is not
+ *  split and 'h' is FALSE.
  *
  * Returns:
  *  Error code
@@ -222,160 +244,493 @@ Four edubtm_SplitInternal(
  *  The caller should call BfM_SetDirty() for 'fpage'.
  */
 Four edubtm_SplitLeaf(
-    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreeHandle                 *handle,        /* IN opened index */
     PageID                      *root,          /* IN PageID for the given page, 'fpage' */
     BtreeLeaf                   *fpage,         /* INOUT the page which will be splitted */
     Two                         high,           /* IN slotNo for the given 'item' */
-    LeafItem                    *item,          /* IN the item which will be inserted */
+    btm_LeafEntry               *item,          /* IN the plain leaf entry which will be inserted */
+    Boolean                     *h,             /* OUT whether the given page is splitted */
     InternalItem                *ritem)         /* OUT the item which will be returned by spliting */
 {
     Four                        e;              /* error number */
     Two                         i;              /* slot No. in the given page, fpage */
     Two                         j;              /* slot No. in the splitted pages */
-    Two                         k;              /* slot No. in the new page */
-    Two                         maxLoop;        /* # of max loops; # of slots in fpage + 1 */
-    Four                        sum;            /* the size of a filled area */
+    Two                         n;              /* # of entries; # of slots in fpage + 1 */
+    Two                         s;              /* # of entries staying in fpage */
+    Four                        fill;           /* the size of fpage to be filled */
+    Four                        format;         /* format of the rebuilt pages */
+    Boolean                     done;           /* whether a sibling takes the entries */
     PageID                      newPid;         /* for a New Allocated Page */
     PageID                      nextPid;        /* for maintaining doubly linked list */
     BtreeLeaf                   tpage;          /* a temporary page for the given page */
     BtreeLeaf                   *npage;         /* a page pointer for the new page */
     BtreeLeaf                   *mpage;         /* for doubly linked list */
-    btm_LeafEntry               *itemEntry;     /* entry for the given 'item' */
-    btm_LeafEntry               *fEntry;        /* an entry in the given page, 'fpage' */
-    btm_LeafEntry               *nEntry;        /* an entry in the new page, 'npage' */
-    ObjectID                    *iOidArray;     /* ObjectID array of 'itemEntry' */
-    ObjectID                    *fOidArray;     /* ObjectID array of 'fEntry' */
-    Two                         fEntryOffset;   /* starting offset of 'fEntry' */
-    Two                         nEntryOffset;   /* starting offset of 'nEntry' */
-    Two                         oidArrayNo;     /* element No in an ObjectID array */
-    Two                         alignedKlen;    /* aligned length of the key length */
-    Two                         itemEntryLen;   /* length of entry for item */
-    Two                         entryLen;       /* entry length */
-    Boolean                     flag;
-    Boolean                     isTmp;
-
-/*-----------------------------------------------Autre maniere de faire, utiliser la page temporaire 
-pour store tous les valeurs que doivent 
-prendre splitted page, comme ca pas besoin de faire un traitement apres pour item a ajouté*/
-
-    /*Allocate a new page & Initialize the allocated page as a leaf page.*/
-    e =btm_AllocPage(catObjForFile, root, &newPid);
-    if(e<0) ERR(e);
-    e=edubtm_InitLeaf(&newPid, FALSE, FALSE);
-    if(e<0) ERR(e);
+    KeyValue                    lastKey;        /* the last key of the given page */
+    KeyValue                    firstKey;       /* the first key of the new page */
+    LeafEntryRef                refs[BL_MAXENTRIES+1]; /* entries of the virtual page (fpage + item) */
 
-    flag = FALSE;
-    maxLoop = fpage->hdr.nSlots + 1;
-    sum = 0;
-    i = 0;
-    j = 0; 
-    itemEntryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(item->klen) + sizeof(ObjectID);
 
-    for (j = 0; (j<maxLoop && sum < BL_HALF); ++j){
-        if (j == high + 1){
-            flag = TRUE;
-            entryLen = itemEntryLen; // in order to update sum
+    *h = FALSE;
+
+    /* fpage is rebuilt from scratch out of its saved image */
+    memcpy(&tpage, fpage, PAGESIZE);
+    format = BTM_LEAF_FORMAT(handle, &tpage);
+
+    /* Slot 'high'+1 of the virtual page (fpage + item) belongs to 'item'. */
+    n = tpage.hdr.nSlots + 1;
+    for (i = 0, j = 0; j < n; j++) {
+        if (j == high + 1) {
+            refs[j].prefix = NULL;
+            refs[j].prefixLen = NIL;
+            refs[j].entry = item;
         }
         else {
-            fEntryOffset = fpage->slot[-i];
-            fEntry = (btm_LeafEntry*)&(fpage->data[fEntryOffset]);
-            entryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(fEntry->klen) + sizeof(ObjectID); //in order to update sum
-            ++i;
+            edubtm_GetLeafEntryRef(&tpage, i, &refs[j]);
+            i++;
         }
-        sum += entryLen + 2; // 2 is for slot size
     }
-    fpage->hdr.nSlots = i;
 
-    // ATTENTION A SAVOIR SI ON RAJOUTE OU PAS ---------------------------------------------------
-    if(fpage->hdr.type & ROOT){
-        fpage->hdr.type ^= ROOT;
+    /*@ the page may only have to be rebuilt around another prefix */
+    if (edubtm_LeafEntriesSize(refs, n, format) <= PAGESIZE - BL_FIXED) {
+        edubtm_BuildLeafPage(handle, fpage, refs, n, format);
+        return(eNOERROR);
     }
-    // FIN DU ATTENTION -----------------------------------------------------------------------------
-    // now we work on the new page, with the index entry remaining
-    e = BfM_GetTrain(&newPid, &npage, PAGE_BUF);
-    if(e<0)ERR(e);
-    k = 0; 
 
-    for(j = j ; j <maxLoop; ++j){
-        // set up info for the new index entry
-        nEntryOffset = npage->hdr.free;
-        npage->slot[-k] = nEntryOffset;
-        nEntry = &npage->data[nEntryOffset];
+    /*@ a sibling shares the entries unless keys are appended at the end of the index */
+    if (high != tpage.hdr.nSlots - 1 || tpage.hdr.nextPage != NIL) {
+        e = edubtm_SplitLeafWithSibling(handle, root, fpage, refs, n, format, &done, h, ritem);
+        if (e < 0) ERR(e);
 
+        if (done) return(eNOERROR);
+    }
 
-        if(j == high + 1){
-            flag = FALSE; // no need to do shift any things at the end 
-            itemEntry = nEntry;
-            // we can add the object now: 
-            itemEntry->klen = item->klen;
-            itemEntry->nObjects = item->nObjects;
-            memcpy(itemEntry->kval, item->kval, item->klen);
-            iOidArray = &itemEntry->kval[alignedKlen];
-            *iOidArray = item->oid;
+    /*@ Allocate a new page & Initialize the allocated page as a leaf page. */
+    e = btm_AllocPage(&handle->catObjForFile, root, &newPid);
+    if(e<0) ERR(e);
 
-            entryLen = itemEntryLen;
-        }
-        else {
-            // we also add the entry index now : 
-            fEntryOffset = fpage->slot[-i];
-            fEntry = &fpage->data[fEntryOffset];
-
-            entryLen = (BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(fEntry->klen) + sizeof(ObjectID)); 
-            memcpy(nEntry, fEntry, entryLen);
-            
-            if(fEntryOffset + entryLen == fpage->hdr.free){
-                fpage->hdr.free -= entryLen;
-            } else{
-                fpage->hdr.unused += entryLen;  
-            }  
-            ++i;
-        }
+    e = edubtm_InitLeaf(&newPid, FALSE, FALSE);
+    if(e<0) ERR(e);
 
-        ++k;
-        npage->hdr.free += entryLen;
-    }
+    e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+    if(e<0) ERR(e);
 
-    npage->hdr.nSlots = k;
+    /*
+     * The first 's' entries stay in fpage and the rest moves to the new
+     * page, which keeps at least one entry.
+     */
+    fill = (high == tpage.hdr.nSlots - 1 && tpage.hdr.nextPage == NIL) ? BL_APPEND_FILL : BL_HALF;
+    s = edubtm_PartitionLeafEntries(refs, n, format, fill, (high + 1 == 0) ? 1 : n - 1);
 
-    // we still need to add item, if He needs to go in the splitted page 
+    edubtm_BuildLeafPage(handle, fpage, refs, s, format);
+    edubtm_BuildLeafPage(handle, npage, &refs[s], n - s, format);
+    BTM_LEAF_MOVED(handle, root->pageNo);
+    BTM_LEAF_MOVED(handle, newPid.pageNo);
 
-    if(flag){
-        if(itemEntryLen > BL_CFREE(fpage)){
-            edubtm_CompactLeafPage(fpage, NIL);
-        }
-        // shift every element, in order to have to have one free slot in arrayslot, but we store the index entry at the end of Data area 
-        for(i = fpage->hdr.nSlots - 1; high + 1 <= i; --i){
-            fpage->slot[-i-1] = fpage->slot[-i];
-        }
-        fpage->slot[-high-1] = fpage->hdr.free;
-        fEntry = &fpage->data[fpage->slot[-high-1]];
-        itemEntry = fEntry;
-
-        itemEntry->klen = item->klen;
-        itemEntry->nObjects = item->nObjects;
-        memcpy(itemEntry->kval, item->kval, item->klen);
-        iOidArray = &itemEntry->kval[alignedKlen];
-        *iOidArray = item->oid;
-
-        fpage->hdr.free += itemEntryLen;
-        fpage->hdr.nSlots += 1;
+    /* the root flag is handed over to the new root by edubtm_root_insert() */
+    fpage->hdr.type &= ~ROOT;
+
+    /*@ Maintain the doubly linked list of leaves: fpage <-> npage <-> next */
+    npage->hdr.prevPage = root->pageNo;
+    npage->hdr.nextPage = fpage->hdr.nextPage;
+    fpage->hdr.nextPage = newPid.pageNo;
+
+    if (npage->hdr.nextPage != NIL) {
+        MAKE_PAGEID(nextPid, root->volNo, npage->hdr.nextPage);
+
+        e = BfM_GetTrain(&nextPid, (char**)&mpage, PAGE_BUF);
+        if(e<0) ERRB1(e, &newPid, PAGE_BUF);
+
+        mpage->hdr.prevPage = newPid.pageNo;
+
+        e = BfM_SetDirty(&nextPid, PAGE_BUF);
+        if(e<0) ERRB2(e, &nextPid, PAGE_BUF, &newPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&nextPid, PAGE_BUF);
+        if(e<0) ERRB1(e, &newPid, PAGE_BUF);
     }
 
+    /*@ The separator for the parent divides the last key of fpage from the first key of the new page. */
+    edubtm_GetLeafEntryRefKey(&refs[s-1], &lastKey);
+    edubtm_GetLeafEntryRefKey(&refs[s], &firstKey);
+    edubtm_MakeSeparator(handle, &lastKey, &firstKey, newPid.pageNo, ritem);
 
-    // we need to update the doubly linked list 
-    // the ritem returned, is the first of the newpage 
-    nEntry = &npage->data[npage->slot[0]];
-    ritem->spid = newPid.pageNo;
-    item->klen = nEntry->klen;
-    memcpy(ritem->kval, nEntry->kval, nEntry->klen);
     e = BfM_SetDirty(&newPid, PAGE_BUF);
-    if(e<0) ERR(e);
+    if(e<0) ERRB1(e, &newPid, PAGE_BUF);
+
     e = BfM_FreeTrain(&newPid, PAGE_BUF);
     if(e<0) ERR(e);
 
+    /* the key range of fpage shrinks; internal pages may split above it */
+    BTM_INVALIDATE_FINGER(handle);
+    edubtm_LogChurn(handle, BTM_CHURN_SPLIT, root->pageNo, newPid.pageNo);
 
-
+    *h = TRUE;
 
     return(eNOERROR);
     
 } /* edubtm_SplitLeaf() */
+
+
+
+/*@================================
+ * edubtm_SplitLeafWithSibling()
+ *================================*/
+/*
+ * Function: Four edubtm_SplitLeafWithSibling(BtreeHandle*, PageID*, BtreeLeaf*, LeafEntryRef*,
+ *                                         Two, Four, Boolean*, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Make room for the entries 'refs' of the overflowing leaf 'root' with the
+ *  help of a sibling under the same parent, in the way of B*-trees. The
+ *  entries are first shared with the right or the left sibling if both
+ *  pages hold them; only if neither sibling has room, the page and a
+ *  sibling are split into three pages.
+ *
+ *  The parent is found on the finger of 'handle', which is on the leaf
+ *  whenever the leaf was reached by a descent of an insertion, and it is
+ *  used only if a replaced separator cannot split it. Otherwise, e.g. for
+ *  the root leaf, 'done' is FALSE and the caller splits the page alone.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) done : TRUE if the entries are stored
+ *  2) h : TRUE if a new page is to be inserted into the parent
+ *  3) ritem : the item for the new page
+ */
+Four edubtm_SplitLeafWithSibling(
+    BtreeHandle                 *handle,        /* IN opened index */
+    PageID                      *root,          /* IN the overflowing page */
+    BtreeLeaf                   *fpage,         /* INOUT buffer of the overflowing page */
+    LeafEntryRef                *refs,          /* IN entries of the page with the new entry */
+    Two                         n,              /* IN # of entries */
+    Four                        format,         /* IN format of the page */
+    Boolean                     *done,          /* OUT whether the entries are stored */
+    Boolean                     *h,             /* OUT whether a new page is created */
+    InternalItem                *ritem)         /* OUT the item for the new page */
+{
+    Four                        e;              /* error number */
+    Two                         slotNo;         /* slot of the parent pointing to the page */
+    Two                         nPages;         /* # of pages the entries are divided into */
+    ShortPageID                 spid;           /* child page of 'slotNo' */
+    PageID                      ppid;           /* the parent page */
+    BtreePage                   *ppage;         /* buffer of the parent page */
+    KeyValue                    firstKey;       /* the first key of the entries */
+
+
+    *done = FALSE;
+
+    if (IS_NILPAGEID(handle->finger.leaf) || handle->finger.leaf.pageNo != root->pageNo ||
+        handle->finger.height == 0)
+        return(eNOERROR);
+
+    ppid = handle->finger.path[handle->finger.height - 1];
+
+    e = BfM_GetTrain(&ppid, (char**)&ppage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    if (BTM_SAFE_FOR_INSERT(&ppage->bi)) {
+        edubtm_GetLeafEntryRefKey(&refs[0], &firstKey);
+        edubtm_BinarySearchInternal(&ppage->bi, handle, &firstKey, &slotNo);
+
+        if (slotNo == -1)
+            spid = ppage->bi.hdr.p0;
+        else
+            spid = ((btm_InternalEntry*)&ppage->bi.data[ppage->bi.slot[-slotNo]])->spid;
+
+        /* two pages sharing the entries, right sibling first, then three pages */
+        for (nPages = 2; spid == root->pageNo && nPages <= 3 && !*done; nPages++) {
+            e = edubtm_RedistributeLeaf(handle, &ppage->bi, slotNo, root, fpage, refs, n, format,
+                                        TRUE, nPages, done, h, ritem);
+            if (e < 0) ERRB1(e, &ppid, PAGE_BUF);
+
+            if (*done) break;
+
+            e = edubtm_RedistributeLeaf(handle, &ppage->bi, slotNo, root, fpage, refs, n, format,
+                                        FALSE, nPages, done, h, ritem);
+            if (e < 0) ERRB1(e, &ppid, PAGE_BUF);
+        }
+    }
+
+    if (*done) {
+        e = BfM_SetDirty(&ppid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &ppid, PAGE_BUF);
+
+        /* the key ranges of the leaves change */
+        BTM_INVALIDATE_FINGER(handle);
+    }
+
+    e = BfM_FreeTrain(&ppid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_SplitLeafWithSibling() */
+
+
+
+/*@================================
+ * edubtm_RedistributeLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_RedistributeLeaf(BtreeHandle*, BtreeInternal*, Two, PageID*, BtreeLeaf*,
+ *                                     LeafEntryRef*, Two, Four, Boolean, Two, Boolean*,
+ *                                     Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Divide the entries 'refs' of the page 'root' and the entries of its right
+ *  (or left) sibling equally into 'nPages' pages, 2 or 3. With three pages
+ *  a new page follows 'root'; its separator is returned in 'ritem' while the
+ *  separator of the page pointed by the parent slot between the siblings is
+ *  replaced in 'ppage'.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) done : FALSE if there is no such sibling or the entries do not fit
+ *  2) h : TRUE if a new page is to be inserted into the parent
+ *  3) ritem : the item for the new page
+ *
+ * Note:
+ *  'ppage' has room for any separator, so replacing one never splits it.
+ *  The image of the sibling is kept in the room of 'handle' (see
+ *  edubtm_GetLeafScratch()), so 'refs' must not refer to that room.
+ */
+Four edubtm_RedistributeLeaf(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeInternal               *ppage,         /* INOUT the parent page */
+    Two                         slotNo,         /* IN slot of 'ppage' pointing to 'root' */
+    PageID                      *root,          /* IN the overflowing page */
+    BtreeLeaf                   *fpage,         /* INOUT buffer of the overflowing page */
+    LeafEntryRef                *refs,          /* IN entries of the page with the new entry */
+    Two                         n,              /* IN # of entries */
+    Four                        format,         /* IN format of the page */
+    Boolean                     right,          /* IN TRUE for the right sibling */
+    Two                         nPages,         /* IN # of pages, 2 or 3 */
+    Boolean                     *done,          /* OUT whether the entries are stored */
+    Boolean                     *h,             /* OUT whether a new page is created */
+    InternalItem                *ritem)         /* OUT the item for the new page */
+{
+    Four                        e;              /* error number */
+    Two                         p;              /* index of a page */
+    Two                         m;              /* # of entries of both pages */
+    Two                         sepSlot;        /* slot of the separator between the siblings */
+    Two                         ends[3];        /* end of the entries of each page */
+    Four                        fmt;            /* format of the rebuilt pages */
+    Boolean                     ph;             /* whether the parent is splitted; never */
+    PageID                      sPid;           /* the sibling */
+    PageID                      newPid;         /* the new page */
+    PageID                      nextPid;        /* for maintaining doubly linked list */
+    PageID                      pids[3];        /* the pages in key order */
+    BtreeLeaf                   *pages[3];      /* buffers of the pages in key order */
+    BtreeLeaf                   *spage;         /* buffer of the sibling */
+    BtreeLeaf                   *npage;         /* buffer of the new page */
+    BtreeLeaf                   *mpage;         /* for doubly linked list */
+    BtreeLeaf                   *tspage;        /* a temporary page for the sibling */
+    KeyValue                    lastKey;        /* the last key of a page */
+    KeyValue                    firstKey;       /* the first key of the next page */
+    InternalItem                sep;            /* the replaced separator */
+    InternalItem                pitem;          /* item of the parent; never used */
+    LeafEntryRef                *all;           /* entries of both pages */
+    BtreeLeafScratch            *scratch;       /* room for 'tspage' and 'all' */
+
+
+    *done = FALSE;
+
+    sPid.volNo = root->volNo;
+    if (right) {
+        if (slotNo + 1 >= ppage->hdr.nSlots) return(eNOERROR);
+        sepSlot = slotNo + 1;
+        sPid.pageNo = ((btm_InternalEntry*)&ppage->data[ppage->slot[-sepSlot]])->spid;
+    }
+    else {
+        if (slotNo < 0) return(eNOERROR);
+        sepSlot = slotNo;
+        if (slotNo == 0)
+            sPid.pageNo = ppage->hdr.p0;
+        else
+            sPid.pageNo = ((btm_InternalEntry*)&ppage->data[ppage->slot[-(slotNo-1)]])->spid;
+    }
+
+    e = edubtm_GetLeafScratch(handle, &scratch);
+    if (e < 0) ERR(e);
+    tspage = &scratch->page[0];
+    all = scratch->refs;
+
+    e = BfM_GetTrain(&sPid, (char**)&spage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    memcpy(tspage, spage, PAGESIZE);
+    fmt = format | BTM_LEAF_FORMAT(handle, tspage);
+
+    if (right) {
+        memcpy(all, refs, n * sizeof(LeafEntryRef));
+        m = n + edubtm_GetLeafEntryRefs(tspage, &all[n]);
+    }
+    else {
+        m = edubtm_GetLeafEntryRefs(tspage, all);
+        memcpy(&all[m], refs, n * sizeof(LeafEntryRef));
+        m += n;
+    }
+
+    if (!edubtm_DivideLeafEntries(all, m, fmt, nPages, ends)) {
+        e = BfM_FreeTrain(&sPid, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    /*@ the new page of three follows the overflowing page */
+    newPid.pageNo = NIL;
+    if (nPages == 3) {
+        e = btm_AllocPage(&handle->catObjForFile, root, &newPid);
+        if (e < 0) ERRB1(e, &sPid, PAGE_BUF);
+
+        e = edubtm_InitLeaf(&newPid, FALSE, FALSE);
+        if (e < 0) ERRB1(e, &sPid, PAGE_BUF);
+
+        e = BfM_GetTrain(&newPid, (char**)&npage, PAGE_BUF);
+        if (e < 0) ERRB1(e, &sPid, PAGE_BUF);
+    }
+
+    p = 0;
+    if (!right) { pids[p] = sPid; pages[p++] = spage; }
+    pids[p] = *root; pages[p++] = fpage;
+    if (nPages == 3) { pids[p] = newPid; pages[p++] = npage; }
+    if (right) { pids[p] = sPid; pages[p++] = spage; }
+
+    for (p = 0; p < nPages; p++) {
+        edubtm_BuildLeafPage(handle, pages[p], &all[(p == 0) ? 0 : ends[p-1]],
+                             ends[p] - ((p == 0) ? 0 : ends[p-1]), fmt);
+        BTM_LEAF_MOVED(handle, pids[p].pageNo);
+    }
+
+    /*@ Maintain the doubly linked list of leaves: fpage <-> npage <-> next */
+    if (nPages == 3) {
+        npage->hdr.prevPage = root->pageNo;
+        npage->hdr.nextPage = fpage->hdr.nextPage;
+        fpage->hdr.nextPage = newPid.pageNo;
+
+        if (right)
+            spage->hdr.prevPage = newPid.pageNo;
+        else if (npage->hdr.nextPage != NIL) {
+            MAKE_PAGEID(nextPid, root->volNo, npage->hdr.nextPage);
+
+            e = BfM_GetTrain(&nextPid, (char**)&mpage, PAGE_BUF);
+            if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &sPid, PAGE_BUF);
+
+            mpage->hdr.prevPage = newPid.pageNo;
+
+            e = BfM_SetDirty(&nextPid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &nextPid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&nextPid, PAGE_BUF);
+            if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &sPid, PAGE_BUF);
+        }
+    }
+
+    /*@ the separator of the new page goes up; the one of the page at 'sepSlot' is replaced */
+    for (p = 0; p < nPages - 1; p++) {
+        edubtm_GetLeafEntryRefKey(&all[ends[p]-1], &lastKey);
+        edubtm_GetLeafEntryRefKey(&all[ends[p]], &firstKey);
+
+        if (pids[p+1].pageNo == newPid.pageNo) {
+            edubtm_MakeSeparator(handle, &lastKey, &firstKey, newPid.pageNo, ritem);
+            *h = TRUE;
+        }
+        else {
+            edubtm_MakeSeparator(handle, &lastKey, &firstKey, pids[p+1].pageNo, &sep);
+
+            e = edubtm_ReplaceSeparator(handle, ppage, sepSlot, &sep, &ph, &pitem);
+            if (e < 0) {
+                if (nPages == 3) (Four) BfM_FreeTrain(&newPid, PAGE_BUF);
+                ERRB1(e, &sPid, PAGE_BUF);
+            }
+        }
+    }
+
+    if (nPages == 3) {
+        edubtm_LogChurn(handle, BTM_CHURN_SPLIT, root->pageNo, newPid.pageNo);
+
+        e = BfM_SetDirty(&newPid, PAGE_BUF);
+        if (e < 0) ERRB2(e, &newPid, PAGE_BUF, &sPid, PAGE_BUF);
+
+        e = BfM_FreeTrain(&newPid, PAGE_BUF);
+        if (e < 0) ERRB1(e, &sPid, PAGE_BUF);
+    }
+
+    e = BfM_SetDirty(&sPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &sPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&sPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    *done = TRUE;
+
+    return(eNOERROR);
+
+} /* edubtm_RedistributeLeaf() */
+
+
+
+/*@================================
+ * edubtm_MakeSeparator()
+ *================================*/
+/*
+ * Function: void edubtm_MakeSeparator(BtreeHandle*, KeyValue*, KeyValue*, ShortPageID, InternalItem*)
+ *
+ * Description:
+ *  Build into 'item' the separator pointing to 'spid' for two adjacent
+ *  leaves, where 'left' is the last key of the left leaf and 'right' the
+ *  first key of the right one. Any key 'sep' with left < sep <= right
+ *  divides them, so for a string key or a normalized key of several parts
+ *  the shortest prefix of 'right' which is greater than 'left' is used;
+ *  other keys use 'right' as it is.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_MakeSeparator(
+    BtreeHandle                 *handle,        /* IN opened index */
+    KeyValue                    *left,          /* IN the last key of the left leaf */
+    KeyValue                    *right,         /* IN the first key of the right leaf */
+    ShortPageID                 spid,           /* IN the right leaf */
+    InternalItem                *item)          /* OUT the separator */
+{
+    Two                         i;              /* index of a byte */
+    Two                         len;            /* # of bytes to be compared */
+    Two                         strLen;         /* length of the string of the separator */
+
+
+    item->spid = spid;
+
+    /* a prefix of a normalized key compares as the key does up to its end */
+    if (BTM_NORMALIZED(handle)) {
+        len = MIN(left->len, right->len);
+        for (i = 0; i < len && left->val[i] == right->val[i]; i++);
+
+        item->klen = MIN(i + 1, right->len);
+        memcpy(item->kval, right->val, item->klen);
+        return;
+    }
+
+    if (handle->kdesc.kpart[0].type != SM_VARSTRING) {
+        item->klen = right->len;
+        memcpy(item->kval, right->val, right->len);
+        return;
+    }
+
+    /* the strings differ first at byte 'i'; 'right' is kept up to and including it */
+    len = MIN(left->len, right->len);
+    for (i = sizeof(Two); i < len && left->val[i] == right->val[i]; i++);
+
+    item->klen = MIN(i + 1, right->len);
+    strLen = item->klen - sizeof(Two);
+    memcpy(item->kval, &strLen, sizeof(Two));
+    memcpy(&item->kval[sizeof(Two)], &right->val[sizeof(Two)], strLen);
+
+}   /* edubtm_MakeSeparator() */
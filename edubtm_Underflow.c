@@ -0,0 +1,539 @@
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational-Purpose Object Storage System            */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Database and Multimedia Laboratory                                      */
+/*                                                                            */
+/*    Computer Science Department and                                         */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: kywhang@cs.kaist.ac.kr                                          */
+/*    phone: +82-42-350-7722                                                  */
+/*    fax: +82-42-350-8380                                                    */
+/*                                                                            */
+/*    Copyright (c) 1995-2013 by Kyu-Young Whang                              */
+/*                                                                            */
+/*    All rights reserved. No part of this software may be reproduced,        */
+/*    stored in a retrieval system, or transmitted, in any form or by any     */
+/*    means, electronic, mechanical, photocopying, recording, or otherwise,   */
+/*    without prior written permission of the copyright owner.                */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Underflow.c
+ *
+ * Description :
+ *  Handle the underflow of a child page after a deletion. The child is
+ *  paired with a sibling under the same parent; the two pages are merged
+ *  if their entries fit in one page, otherwise their entries are
+ *  redistributed and the separator in the parent is replaced.
+ *
+ *  Leaf pages are rebuilt through LeafEntryRef, so that merging and
+ *  redistributing work on prefix compressed leaves as well.
+ *
+ * Exports:
+ *  Four edubtm_Underflow(BtreeHandle*, BtreeInternal*, PageID*, Two, Boolean*,
+ *                        Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_ReplaceSeparator(BtreeHandle*, BtreeInternal*, Two, InternalItem*,
+ *                               Boolean*, InternalItem*)
+ *  Four edubtm_FreePage(PageID*, BtreePage*, Pool*, DeallocListElem*)
+ *  void edubtm_DeleteInternalEntry(BtreeInternal*, Two)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_UnderflowLeaf(BtreeHandle*, BtreeInternal*, Two, PageID*, BtreeLeaf*, PageID*, BtreeLeaf*,
+                          Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_UnderflowInternal(BtreeHandle*, BtreeInternal*, Two, PageID*, BtreeInternal*, PageID*, BtreeInternal*,
+                              Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+void edubtm_BuildInternalPage(BtreeInternal*, btm_InternalEntry**, Two);
+
+
+/*@ length of an internal entry */
+#define BTM_INTERNALENTRY_LEN(entry) (sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + (entry)->klen))
+
+
+
+/*@================================
+ * edubtm_Underflow()
+ *================================*/
+/*
+ * Function: Four edubtm_Underflow(BtreeHandle*, BtreeInternal*, PageID*, Two,
+ *                              Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  The child 'child' of 'ppage' pointed by the slot 'slotNo' (-1 for p0) is
+ *  less than half full. Pair it with its right sibling, or with its left
+ *  sibling if it is the last child, and merge or redistribute the pair.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  f    : TRUE if 'ppage' is not half full after a merge.
+ *  h    : TRUE if 'ppage' is splitted by replacing a separator.
+ *  item : The internal item to be inserted into the parent of 'ppage' if 'h' is TRUE.
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for 'ppage'.
+ */
+Four edubtm_Underflow(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeInternal               *ppage,         /* INOUT parent page of the underflowed child */
+    PageID                      *child,         /* IN the underflowed child page */
+    Two                         slotNo,         /* IN slot of 'ppage' pointing to 'child' */
+    Boolean                     *f,             /* OUT whether 'ppage' is not half full */
+    Boolean                     *h,             /* OUT whether 'ppage' is splitted */
+    InternalItem                *item,          /* OUT The internal item to be returned */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         sepSlot;        /* slot of the separator between the two pages */
+    PageID                      leftPid;        /* the left page of the pair */
+    PageID                      rightPid;       /* the right page of the pair */
+    BtreePage                   *lpage;         /* buffer of the left page */
+    BtreePage                   *rpage;         /* buffer of the right page */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    *f = *h = FALSE;
+
+    /* the key ranges of the children change */
+    BTM_INVALIDATE_FINGER(handle);
+
+    /* the only child of the root has no sibling; the root is collapsed instead */
+    if (ppage->hdr.nSlots == 0) return(eNOERROR);
+
+    sepSlot = (slotNo < ppage->hdr.nSlots - 1) ? slotNo + 1 : slotNo;
+
+    leftPid.volNo = rightPid.volNo = child->volNo;
+    if (sepSlot == 0)
+        leftPid.pageNo = ppage->hdr.p0;
+    else {
+        iEntry = (btm_InternalEntry*)&ppage->data[ppage->slot[-(sepSlot-1)]];
+        leftPid.pageNo = iEntry->spid;
+    }
+    iEntry = (btm_InternalEntry*)&ppage->data[ppage->slot[-sepSlot]];
+    rightPid.pageNo = iEntry->spid;
+
+    e = BfM_GetTrain(&leftPid, (char**)&lpage, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    e = BfM_GetTrain(&rightPid, (char**)&rpage, PAGE_BUF);
+    if (e < 0) ERRB1(e, &leftPid, PAGE_BUF);
+
+    if (lpage->any.hdr.type & LEAF)
+        e = edubtm_UnderflowLeaf(handle, ppage, sepSlot, &leftPid, &lpage->bl, &rightPid, &rpage->bl,
+                                 f, h, item, dlPool, dlHead);
+    else if (lpage->any.hdr.type & INTERNAL)
+        e = edubtm_UnderflowInternal(handle, ppage, sepSlot, &leftPid, &lpage->bi, &rightPid, &rpage->bi,
+                                     f, h, item, dlPool, dlHead);
+    else
+        e = eBADBTREEPAGE_BTM;
+    if (e < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+
+    e = BfM_SetDirty(&leftPid, PAGE_BUF);
+    if (e < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+
+    e = BfM_SetDirty(&rightPid, PAGE_BUF);
+    if (e < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&leftPid, PAGE_BUF);
+    if (e < 0) ERRB1(e, &rightPid, PAGE_BUF);
+
+    e = BfM_FreeTrain(&rightPid, PAGE_BUF);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_Underflow() */
+
+
+
+/*@================================
+ * edubtm_UnderflowLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_UnderflowLeaf(BtreeHandle*, BtreeInternal*, Two, PageID*, BtreeLeaf*,
+ *                                  PageID*, BtreeLeaf*, Boolean*, Boolean*, InternalItem*,
+ *                                  Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Merge the right leaf into the left one if all entries fit in one page
+ *  up to the high water mark of the index, otherwise redistribute the
+ *  entries by halves. The pages are rebuilt in the prefix compressed format
+ *  if either of them is compressed. Their images are kept in the room of
+ *  'handle' (see edubtm_GetLeafScratch()).
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnderflowLeaf(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeInternal               *ppage,         /* INOUT parent page */
+    Two                         sepSlot,        /* IN slot of the separator in 'ppage' */
+    PageID                      *leftPid,       /* IN the left page */
+    BtreeLeaf                   *lpage,         /* INOUT buffer of the left page */
+    PageID                      *rightPid,      /* IN the right page */
+    BtreeLeaf                   *rpage,         /* INOUT buffer of the right page */
+    Boolean                     *f,             /* OUT whether 'ppage' is not half full */
+    Boolean                     *h,             /* OUT whether 'ppage' is splitted */
+    InternalItem                *item,          /* OUT The internal item to be returned */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         n;              /* # of entries of both pages */
+    Two                         s;              /* # of entries of the left page */
+    Four                        format;         /* format of the rebuilt pages */
+    PageID                      nextPid;        /* for maintaining doubly linked list */
+    BtreeLeaf                   *mpage;         /* for doubly linked list */
+    BtreeLeaf                   *tlpage;        /* a temporary page for the left page */
+    BtreeLeaf                   *trpage;        /* a temporary page for the right page */
+    KeyValue                    lastKey;        /* the last key of the left page */
+    KeyValue                    firstKey;       /* the first key of the right page */
+    InternalItem                sep;            /* the new separator */
+    LeafEntryRef                *refs;          /* entries of both pages */
+    BtreeLeafScratch            *scratch;       /* room for the temporary pages and 'refs' */
+
+
+    e = edubtm_GetLeafScratch(handle, &scratch);
+    if (e < 0) ERR(e);
+    tlpage = &scratch->page[0];
+    trpage = &scratch->page[1];
+    refs = scratch->refs;
+
+    format = BTM_LEAF_FORMAT(handle, lpage) | BTM_LEAF_FORMAT(handle, rpage);
+
+    memcpy(tlpage, lpage, PAGESIZE);
+    memcpy(trpage, rpage, PAGESIZE);
+    n = edubtm_GetLeafEntryRefs(tlpage, refs);
+    n += edubtm_GetLeafEntryRefs(trpage, &refs[n]);
+
+    BTM_LEAF_MOVED(handle, leftPid->pageNo);
+    BTM_LEAF_MOVED(handle, rightPid->pageNo);
+
+    if (edubtm_LeafEntriesSize(refs, n, format) <= handle->leafHighWater) {
+        /*@ merge: the left page takes all entries and the right page is freed */
+        edubtm_BuildLeafPage(handle, lpage, refs, n, format);
+
+        lpage->hdr.nextPage = rpage->hdr.nextPage;
+        if (lpage->hdr.nextPage != NIL) {
+            MAKE_PAGEID(nextPid, leftPid->volNo, lpage->hdr.nextPage);
+
+            e = BfM_GetTrain(&nextPid, (char**)&mpage, PAGE_BUF);
+            if (e < 0) ERR(e);
+
+            mpage->hdr.prevPage = leftPid->pageNo;
+
+            e = BfM_SetDirty(&nextPid, PAGE_BUF);
+            if (e < 0) ERRB1(e, &nextPid, PAGE_BUF);
+
+            e = BfM_FreeTrain(&nextPid, PAGE_BUF);
+            if (e < 0) ERR(e);
+        }
+
+        e = edubtm_FreePage(rightPid, (BtreePage*)rpage, dlPool, dlHead);
+        if (e < 0) ERR(e);
+
+        edubtm_LogChurn(handle, BTM_CHURN_MERGE, leftPid->pageNo, rightPid->pageNo);
+
+        edubtm_DeleteInternalEntry(ppage, sepSlot);
+        *f = (BI_FREE(ppage) > BI_HALF);
+    }
+    else {
+        /*@ redistribute: the entries are divided by halves */
+        s = edubtm_PartitionLeafEntries(refs, n, format, BL_HALF, tlpage->hdr.nSlots);
+        if (s == tlpage->hdr.nSlots) return(eNOERROR);
+
+        edubtm_BuildLeafPage(handle, lpage, refs, s, format);
+        edubtm_BuildLeafPage(handle, rpage, &refs[s], n - s, format);
+
+        edubtm_GetLeafEntryRefKey(&refs[s-1], &lastKey);
+        edubtm_GetLeafEntryRefKey(&refs[s], &firstKey);
+        edubtm_MakeSeparator(handle, &lastKey, &firstKey, rightPid->pageNo, &sep);
+
+        e = edubtm_ReplaceSeparator(handle, ppage, sepSlot, &sep, h, item);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_UnderflowLeaf() */
+
+
+
+/*@================================
+ * edubtm_UnderflowInternal()
+ *================================*/
+/*
+ * Function: Four edubtm_UnderflowInternal(BtreeHandle*, BtreeInternal*, Two, PageID*, BtreeInternal*,
+ *                                      PageID*, BtreeInternal*, Boolean*, Boolean*, InternalItem*,
+ *                                      Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  The separator pulled down from the parent, pointing to p0 of the right
+ *  page, joins the entries of the two internal pages. All of them go to the
+ *  left page if they fit, otherwise the middle entry goes up to the parent
+ *  as the new separator.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnderflowInternal(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeInternal               *ppage,         /* INOUT parent page */
+    Two                         sepSlot,        /* IN slot of the separator in 'ppage' */
+    PageID                      *leftPid,       /* IN the left page */
+    BtreeInternal               *lpage,         /* INOUT buffer of the left page */
+    PageID                      *rightPid,      /* IN the right page */
+    BtreeInternal               *rpage,         /* INOUT buffer of the right page */
+    Boolean                     *f,             /* OUT whether 'ppage' is not half full */
+    Boolean                     *h,             /* OUT whether 'ppage' is splitted */
+    InternalItem                *item,          /* OUT The internal item to be returned */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of an entry */
+    Two                         n;              /* # of entries of both pages and the separator */
+    Two                         m;              /* index of the entry going up to the parent */
+    Four                        sum;            /* the size of a filled area */
+    Four                        total;          /* the size of all entries */
+    BtreeInternal               tlpage;         /* a temporary page for the left page */
+    BtreeInternal               trpage;         /* a temporary page for the right page */
+    btm_InternalEntry           *iEntry;        /* the separator in the parent */
+    InternalItem                down;           /* the separator pulled down from the parent */
+    InternalItem                sep;            /* the new separator */
+    btm_InternalEntry           *entries[2*BI_MAXENTRIES+1]; /* entries of both pages */
+
+
+    memcpy(&tlpage, lpage, PAGESIZE);
+    memcpy(&trpage, rpage, PAGESIZE);
+
+    iEntry = (btm_InternalEntry*)&ppage->data[ppage->slot[-sepSlot]];
+    down.spid = trpage.hdr.p0;
+    down.klen = iEntry->klen;
+    memcpy(down.kval, iEntry->kval, iEntry->klen);
+
+    n = 0;
+    for (i = 0; i < tlpage.hdr.nSlots; i++)
+        entries[n++] = (btm_InternalEntry*)&tlpage.data[tlpage.slot[-i]];
+    entries[n++] = (btm_InternalEntry*)&down;
+    for (i = 0; i < trpage.hdr.nSlots; i++)
+        entries[n++] = (btm_InternalEntry*)&trpage.data[trpage.slot[-i]];
+
+    total = 0;
+    for (i = 0; i < n; i++)
+        total += BTM_INTERNALENTRY_LEN(entries[i]) + sizeof(Two);
+
+    if (total <= PAGESIZE - BI_FIXED) {
+        /*@ merge: the left page takes all entries and the right page is freed */
+        edubtm_BuildInternalPage(lpage, entries, n);
+
+        e = edubtm_UnpinPage(handle, rightPid);
+        if (e < 0) ERR(e);
+
+        e = edubtm_FreePage(rightPid, (BtreePage*)rpage, dlPool, dlHead);
+        if (e < 0) ERR(e);
+
+        edubtm_DeleteInternalEntry(ppage, sepSlot);
+        *f = (BI_FREE(ppage) > BI_HALF);
+    }
+    else {
+        /*@ redistribute: the entry in the middle goes up and its child becomes p0 of the right page */
+        sum = 0;
+        for (m = 0; m < n - 1 && sum < BI_HALF; m++)
+            sum += BTM_INTERNALENTRY_LEN(entries[m]) + sizeof(Two);
+
+        /* nothing moves if the pulled down separator is already in the middle */
+        if (m == tlpage.hdr.nSlots) return(eNOERROR);
+
+        /* both pages have to fit; otherwise the pages are left unbalanced */
+        if (sum > PAGESIZE - BI_FIXED ||
+            total - sum - BTM_INTERNALENTRY_LEN(entries[m]) - sizeof(Two) > PAGESIZE - BI_FIXED)
+            return(eNOERROR);
+
+        edubtm_BuildInternalPage(lpage, entries, m);
+        edubtm_BuildInternalPage(rpage, &entries[m+1], n - m - 1);
+        rpage->hdr.p0 = entries[m]->spid;
+
+        sep.spid = rightPid->pageNo;
+        sep.klen = entries[m]->klen;
+        memcpy(sep.kval, entries[m]->kval, entries[m]->klen);
+
+        e = edubtm_ReplaceSeparator(handle, ppage, sepSlot, &sep, h, item);
+        if (e < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_UnderflowInternal() */
+
+
+
+/*@================================
+ * edubtm_BuildInternalPage()
+ *================================*/
+/*
+ * Function: void edubtm_BuildInternalPage(BtreeInternal*, btm_InternalEntry**, Two)
+ *
+ * Description:
+ *  Replace the entries of 'page' with the 'n' entries of 'entries'. 'p0' is
+ *  left as it is.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_BuildInternalPage(
+    BtreeInternal               *page,          /* INOUT internal page to be rebuilt */
+    btm_InternalEntry           **entries,      /* IN sorted internal entries */
+    Two                         n)              /* IN # of entries */
+{
+    Two                         i;              /* slot No. */
+    Two                         offset;         /* starting offset of an entry */
+    Two                         entryLen;       /* length of an entry */
+
+
+    offset = 0;
+    for (i = 0; i < n; i++) {
+        entryLen = BTM_INTERNALENTRY_LEN(entries[i]);
+        page->slot[-i] = offset;
+        memcpy(&page->data[offset], entries[i], entryLen);
+        offset += entryLen;
+    }
+
+    page->hdr.nSlots = n;
+    page->hdr.free = offset;
+    page->hdr.unused = 0;
+
+} /* edubtm_BuildInternalPage() */
+
+
+
+/*@================================
+ * edubtm_DeleteInternalEntry()
+ *================================*/
+/*
+ * Function: void edubtm_DeleteInternalEntry(BtreeInternal*, Two)
+ *
+ * Description:
+ *  Delete the entry in the slot 'slotNo' of 'page'.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_DeleteInternalEntry(
+    BtreeInternal               *page,          /* INOUT internal page */
+    Two                         slotNo)         /* IN slot of the entry to be deleted */
+{
+    Two                         i;              /* slot No. */
+    Two                         entryOffset;    /* starting offset of the entry */
+    Two                         entryLen;       /* length of the entry */
+
+
+    entryOffset = page->slot[-slotNo];
+    entryLen = BTM_INTERNALENTRY_LEN((btm_InternalEntry*)&page->data[entryOffset]);
+
+    for (i = slotNo + 1; i < page->hdr.nSlots; i++)
+        page->slot[-(i-1)] = page->slot[-i];
+    page->hdr.nSlots--;
+
+    if (entryOffset + entryLen == page->hdr.free)
+        page->hdr.free -= entryLen;
+    else
+        page->hdr.unused += entryLen;
+
+} /* edubtm_DeleteInternalEntry() */
+
+
+
+/*@================================
+ * edubtm_ReplaceSeparator()
+ *================================*/
+/*
+ * Function: Four edubtm_ReplaceSeparator(BtreeHandle*, BtreeInternal*, Two, InternalItem*,
+ *                                     Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Replace the entry in the slot 'sepSlot' of 'ppage' with 'sep'. The new
+ *  separator may be longer than the old one, so 'ppage' may be splitted.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ReplaceSeparator(
+    BtreeHandle                 *handle,        /* IN opened index */
+    BtreeInternal               *ppage,         /* INOUT parent page */
+    Two                         sepSlot,        /* IN slot of the separator */
+    InternalItem                *sep,           /* IN the new separator */
+    Boolean                     *h,             /* OUT whether 'ppage' is splitted */
+    InternalItem                *item)          /* OUT The internal item to be returned */
+{
+    Four                        e;              /* error number */
+
+
+    edubtm_DeleteInternalEntry(ppage, sepSlot);
+
+    e = edubtm_InsertInternal(&handle->catObjForFile, ppage, sep, sepSlot - 1, FALSE, h, item);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_ReplaceSeparator() */
+
+
+
+/*@================================
+ * edubtm_FreePage()
+ *================================*/
+/*
+ * Function: Four edubtm_FreePage(PageID*, BtreePage*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Mark the page 'pid' held in 'apage' as free and put it on the dealloc
+ *  list. The caller still frees the buffer of the page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FreePage(
+    PageID                      *pid,           /* IN the page to be freed */
+    BtreePage                   *apage,         /* INOUT buffer of the page */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    DeallocListElem             *dlElem;        /* an element of dealloc list */
+
+
+    apage->any.hdr.type = FREEPAGE;
+
+    e = Util_getElementFromPool(dlPool, &dlElem);
+    if (e < 0) ERR(e);
+
+    dlElem->type = DL_PAGE;
+    dlElem->elem.pid = *pid;
+    dlElem->next = dlHead->next;
+    dlHead->next = dlElem;
+
+    return(eNOERROR);
+
+} /* edubtm_FreePage() */